@@ -0,0 +1,508 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../simulador_nativo/arduino_nativo.h"
+#include "../simulador_nativo/config_nativo.h"
+#include "../simulador_nativo/componentes_nativo.h"
+#include "../simulador_nativo/http_backend_nativo.h"
+#include "../simulador_nativo/prediccion_lote.h"
+#include "../src/ventana_estadistica.h"
+#include "../src/punto_fijo.h"
+#include "../src/puntuacion_riesgo.h"
+#include "../src/filtro_robusto.h"
+#include "../src/filtro_kalman.h"
+#include "ruta_firmware.h"
+
+using namespace std;
+
+// ======================
+// MICROBENCHMARKS DEL PIPELINE
+// ======================
+// pio run -e benchmark && .pio/build/benchmark/program [opciones]
+//   --filtro TEXTO       solo los benchmarks cuyo nombre contiene TEXTO
+//   --tiempo-ms MS       tiempo medido por benchmark (300 por defecto)
+//   --formato tabla|csv|json
+//   --comparar BASE.csv  agrega la variacion frente a una ejecucion anterior
+//
+// Cada benchmark se ejecuta en lotes de tamano calibrado (~20 us). De cada
+// lote sale una muestra de ns/op para los percentiles; el ns/op medio es
+// el tiempo total entre las operaciones totales. Las asignaciones se
+// cuentan sustituyendo el operator new global.
+
+// ======================
+// CONTEO DE ASIGNACIONES
+// ======================
+// GCC no sabe que este operator new sustituye al estandar y avisa de un
+// free() sobre memoria de new
+#if defined(__GNUC__) && !defined(__clang__)
+  #pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+static atomic<unsigned long long> asignaciones{0};
+static atomic<unsigned long long> bytesAsignados{0};
+
+void* operator new(size_t tam) {
+    asignaciones.fetch_add(1, memory_order_relaxed);
+    bytesAsignados.fetch_add(tam, memory_order_relaxed);
+    if (void* p = malloc(tam ? tam : 1)) return p;
+    throw bad_alloc();
+}
+
+void* operator new[](size_t tam) { return operator new(tam); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// Impide que el compilador descarte un resultado que no se usa
+template <typename T>
+inline void noOptimizar(T const& valor) {
+    asm volatile("" : : "r,m"(valor) : "memory");
+}
+
+// ======================
+// MEDICION
+// ======================
+struct ResultadoBench {
+    string nombre;
+    unsigned long long ops = 0;
+    double nsOp = 0;
+    double p50 = 0, p90 = 0, p99 = 0;
+    double asignacionesOp = 0;
+    double bytesOp = 0;
+};
+
+struct OpcionesBench {
+    string filtro;
+    unsigned long tiempoMs = 300;
+    string formato = "tabla";
+    string rutaBase;
+};
+
+class Bench {
+private:
+    OpcionesBench opciones;
+    vector<ResultadoBench> resultados;
+
+    typedef chrono::steady_clock Reloj;
+
+    static double ns(Reloj::duration d) {
+        return chrono::duration<double, nano>(d).count();
+    }
+
+    static double percentil(vector<double>& muestras, double p) {
+        size_t i = (size_t)(p * (muestras.size() - 1));
+        nth_element(muestras.begin(), muestras.begin() + i, muestras.end());
+        return muestras[i];
+    }
+
+public:
+    explicit Bench(const OpcionesBench& o) : opciones(o) {}
+
+    const vector<ResultadoBench>& todos() const { return resultados; }
+
+    template <typename F>
+    void medir(const string& nombre, F&& op) {
+        if (!opciones.filtro.empty() && nombre.find(opciones.filtro) == string::npos) return;
+
+        // Calentamiento y calibrado del tamano de lote
+        unsigned long porLote = 1;
+        while (true) {
+            auto t0 = Reloj::now();
+            for (unsigned long i = 0; i < porLote; i++) op();
+            if (ns(Reloj::now() - t0) > 20000 || porLote >= (1UL << 24)) break;
+            porLote *= 2;
+        }
+
+        // Las muestras se guardan sin pasar de la capacidad reservada para
+        // no contar las asignaciones del propio vector
+        vector<double> muestras;
+        muestras.reserve(opciones.tiempoMs * 60);
+        unsigned long long asignacionesInicio = asignaciones;
+        unsigned long long bytesInicio = bytesAsignados;
+        unsigned long long ops = 0;
+        double total = 0;
+        auto fin = Reloj::now() + chrono::milliseconds(opciones.tiempoMs);
+
+        do {
+            auto t0 = Reloj::now();
+            for (unsigned long i = 0; i < porLote; i++) op();
+            double t = ns(Reloj::now() - t0);
+            total += t;
+            ops += porLote;
+            if (muestras.size() < muestras.capacity()) muestras.push_back(t / porLote);
+        } while (Reloj::now() < fin);
+
+        ResultadoBench r;
+        r.nombre = nombre;
+        r.ops = ops;
+        r.nsOp = total / ops;
+        r.asignacionesOp = (double)(asignaciones - asignacionesInicio) / ops;
+        r.bytesOp = (double)(bytesAsignados - bytesInicio) / ops;
+        r.p50 = percentil(muestras, 0.50);
+        r.p90 = percentil(muestras, 0.90);
+        r.p99 = percentil(muestras, 0.99);
+        resultados.push_back(r);
+        if (opciones.formato == "tabla") {
+            fprintf(stderr, "  %s\n", nombre.c_str());
+        }
+    }
+
+    void imprimir() const {
+        map<string, double> base = leerBase();
+
+        if (opciones.formato == "csv") {
+            printf("benchmark,ops,ns_op,p50_ns,p90_ns,p99_ns,asignaciones_op,bytes_op%s\n",
+                   base.empty() ? "" : ",variacion_pct");
+            for (const auto& r : resultados) {
+                printf("%s,%llu,%.2f,%.2f,%.2f,%.2f,%.3f,%.1f", r.nombre.c_str(), r.ops, r.nsOp,
+                       r.p50, r.p90, r.p99, r.asignacionesOp, r.bytesOp);
+                if (!base.empty()) printf(",%s", variacion(base, r).c_str());
+                printf("\n");
+            }
+            return;
+        }
+
+        if (opciones.formato == "json") {
+            printf("[\n");
+            for (size_t i = 0; i < resultados.size(); i++) {
+                const ResultadoBench& r = resultados[i];
+                printf("  {\"benchmark\": \"%s\", \"ops\": %llu, \"ns_op\": %.2f, \"p50_ns\": %.2f, "
+                       "\"p90_ns\": %.2f, \"p99_ns\": %.2f, \"asignaciones_op\": %.3f, \"bytes_op\": %.1f}%s\n",
+                       r.nombre.c_str(), r.ops, r.nsOp, r.p50, r.p90, r.p99, r.asignacionesOp,
+                       r.bytesOp, i + 1 < resultados.size() ? "," : "");
+            }
+            printf("]\n");
+            return;
+        }
+
+        printf("%-36s %12s %10s %10s %10s %8s %10s%s\n", "benchmark", "ns/op", "p50", "p90", "p99",
+               "asig/op", "bytes/op", base.empty() ? "" : "   vs base");
+        for (const auto& r : resultados) {
+            printf("%-36s %12.2f %10.2f %10.2f %10.2f %8.2f %10.1f", r.nombre.c_str(), r.nsOp,
+                   r.p50, r.p90, r.p99, r.asignacionesOp, r.bytesOp);
+            if (!base.empty()) printf("   %s", variacion(base, r).c_str());
+            printf("\n");
+        }
+    }
+
+private:
+    // ns/op por benchmark de un CSV generado con --formato csv
+    map<string, double> leerBase() const {
+        map<string, double> base;
+        if (opciones.rutaBase.empty()) return base;
+        ifstream archivo(opciones.rutaBase);
+        string linea;
+        getline(archivo, linea);   // cabecera
+        while (getline(archivo, linea)) {
+            stringstream ss(linea);
+            string nombre, ops, nsOp;
+            if (getline(ss, nombre, ',') && getline(ss, ops, ',') && getline(ss, nsOp, ',')) {
+                base[nombre] = atof(nsOp.c_str());
+            }
+        }
+        return base;
+    }
+
+    static string variacion(const map<string, double>& base, const ResultadoBench& r) {
+        auto it = base.find(r.nombre);
+        if (it == base.end() || it->second <= 0) return "";
+        char texto[32];
+        snprintf(texto, sizeof(texto), "%+.1f%%", 100.0 * (r.nsOp - it->second) / it->second);
+        return texto;
+    }
+};
+
+// ======================
+// DATOS DE ENTRADA
+// ======================
+// Lecturas pregeneradas para que el coste del generador no entre en la
+// medicion de las etapas que no son el sensor
+struct Entradas {
+    vector<SensorData> lecturas;
+    size_t i = 0;
+
+    explicit Entradas(size_t n) {
+        SensorController sensor;
+        sensor.semilla(1);
+        lecturas.reserve(n);
+        for (size_t k = 0; k < n; k++) lecturas.push_back(sensor.readSensors());
+    }
+
+    const SensorData& siguiente() {
+        const SensorData& d = lecturas[i];
+        i = i + 1 == lecturas.size() ? 0 : i + 1;
+        return d;
+    }
+};
+
+template <int N>
+void benchVentana(Bench& bench, Entradas& entradas) {
+    string sufijo = "/" + to_string(N);
+    VentanaEstadistica<float, double, N> ventana;
+    for (int k = 0; k < N; k++) ventana.add(entradas.siguiente().humedad);
+
+    bench.medir("ventana.add" + sufijo, [&] { ventana.add(entradas.siguiente().humedad); });
+    bench.medir("ventana.media" + sufijo, [&] { noOptimizar(ventana.media()); });
+    bench.medir("ventana.pendiente" + sufijo, [&] { noOptimizar(ventana.pendiente()); });
+}
+
+// Mediana deslizante con dos monticulos frente a copiar y seleccionar la
+// ventana en cada muestra
+template <uint8_t N>
+void benchMediana(Bench& bench, Entradas& entradas) {
+    string sufijo = "/" + to_string(N);
+    MedianaDeslizante<float, float, N> mediana;
+    float ventana[N];
+    size_t siguiente = 0;
+    for (int k = 0; k < N; k++) {
+        float v = entradas.siguiente().presion;
+        mediana.agregar(v);
+        ventana[k] = v;
+    }
+
+    bench.medir("mediana.agregar" + sufijo, [&] {
+        mediana.agregar(entradas.siguiente().presion);
+        noOptimizar(mediana.mediana());
+    });
+    bench.medir("mediana.seleccion" + sufijo, [&] {
+        ventana[siguiente] = entradas.siguiente().presion;
+        if (++siguiente == N) siguiente = 0;
+        float copia[N];
+        copy(ventana, ventana + N, copia);
+        nth_element(copia, copia + N / 2, copia + N);
+        noOptimizar(copia[N / 2]);
+    });
+}
+
+// Columnas para la puntuacion en lote: lecturas del generador y
+// tendencias al azar, con algunas justo en los umbrales para probar los
+// empates de las comparaciones
+static void llenarLote(DatosPrediccionSoA& lote, Entradas& entradas, size_t n) {
+    const float umbrales[] = {TENDENCIA_HUMEDAD_ALERTA, TENDENCIA_HUMEDAD_ADVERTENCIA,
+                              TENDENCIA_PRESION_ALERTA, TENDENCIA_PRESION_ADVERTENCIA};
+    mt19937 generador(3);
+    uniform_real_distribution<float> tendencia(-0.6f, 0.6f);
+    lote.resize(n);
+    for (size_t k = 0; k < n; k++) {
+        const SensorData& d = entradas.siguiente();
+        lote.temperatura[k] = d.temperatura;
+        lote.humedad[k] = d.humedad;
+        lote.presion[k] = d.presion;
+        lote.tendenciaHumedad[k] = k % 16 == 0 ? umbrales[k / 16 % 4] : tendencia(generador);
+        lote.tendenciaPresion[k] = k % 16 == 8 ? umbrales[k / 16 % 4] : tendencia(generador);
+    }
+}
+
+// Compara puntuarLote() con puntosRiesgo()/nivelAlerta(); deben coincidir
+// en todas las filas
+static size_t diferenciasLote(DatosPrediccionSoA& lote) {
+    lote.puntuar();
+    size_t diferencias = 0;
+    for (size_t k = 0; k < lote.size(); k++) {
+        int puntos = puntosRiesgo(lote.temperatura[k], lote.humedad[k], lote.presion[k],
+                                  lote.tendenciaHumedad[k], lote.tendenciaPresion[k]);
+        int nivel = nivelAlerta(puntos, lote.humedad[k], lote.presion[k]);
+        if (puntos != lote.puntos[k] || nivel != lote.nivel[k]) diferencias++;
+    }
+    return diferencias;
+}
+
+static void ejecutarBenchmarks(Bench& bench) {
+    Entradas entradas(4096);
+
+    // Ventanas a varios tamanos (el DataFilter usa TAM_VENTANA_FILTRO)
+    benchVentana<20>(bench, entradas);
+    benchVentana<100>(bench, entradas);
+    benchVentana<600>(bench, entradas);
+
+    {
+        VentanaPuntoFijo<20> ventana;
+        bench.medir("ventana_fija.add/20", [&] { ventana.add(aFijo(entradas.siguiente().humedad)); });
+        bench.medir("ventana_fija.pendiente/20", [&] { noOptimizar(ventana.pendienteMilesimas()); });
+    }
+
+    benchMediana<TAM_VENTANA_ROBUSTA>(bench, entradas);
+    benchMediana<101>(bench, entradas);
+
+    {
+        FiltroHampel<float, float, TAM_VENTANA_ROBUSTA> hampel(HAMPEL_MINIMO_PRESION);
+        for (int k = 0; k < TAM_VENTANA_ROBUSTA; k++) {
+            float v = entradas.siguiente().presion;
+            hampel.limpiar(v);
+        }
+        bench.medir("hampel.limpiar/" + to_string(TAM_VENTANA_ROBUSTA), [&] {
+            float v = entradas.siguiente().presion;
+            noOptimizar(hampel.limpiar(v));
+        });
+    }
+
+    {
+        FiltroKalman kalman(KALMAN_MEDIDA_PRESION, KALMAN_ACELERACION_PRESION);
+        kalman.agregar(entradas.siguiente().presion);
+        bench.medir("kalman.agregar", [&] { kalman.agregar(entradas.siguiente().presion); });
+    }
+
+    // DataFilter y PredictionEngine del simulador (componentes_nativo.h, salida
+    // Serial silenciada), con cada etapa robusta y cada motor elegidos en
+    // ejecucion. Comparten ventanas, filtros y reglas con src/, pero no son
+    // las clases del firmware: esas se miden abajo, como firmware.*
+    const struct { const char* nombre; int modo; int motor; } modosFiltro[] = {
+        {"DataFilter.addData (media)", FILTRO_MEDIA, MOTOR_VENTANA},
+        {"DataFilter.addData (mediana)", FILTRO_MEDIANA, MOTOR_VENTANA},
+        {"DataFilter.addData (kalman)", FILTRO_MEDIA, MOTOR_KALMAN},
+        {"DataFilter.addData (hampel)", FILTRO_HAMPEL, MOTOR_VENTANA},
+    };
+    DataFilter filtro;
+    for (const auto& m : modosFiltro) {
+        filtro = DataFilter();
+        filtro.configurarFiltro(m.modo);
+        filtro.configurarMotor(m.motor);
+        for (int k = 0; k < TAM_VENTANA_FILTRO; k++) {
+            const SensorData& d = entradas.siguiente();
+            filtro.addData(d.temperatura, d.humedad, d.presion);
+        }
+        bench.medir(m.nombre, [&] {
+            const SensorData& d = entradas.siguiente();
+            filtro.addData(d.temperatura, d.humedad, d.presion);
+        });
+    }
+    bench.medir("DataFilter.filter", [&] { noOptimizar(filtro.filter()); });
+    bench.medir("DataFilter.calculateHumidityTrend", [&] { noOptimizar(filtro.calculateHumidityTrend()); });
+    bench.medir("DataFilter.calculatePressureTrend", [&] { noOptimizar(filtro.calculatePressureTrend()); });
+
+    // Agregados a 1 min / 10 min / 1 h de una variable (incluidos en addData)
+    AgregadosMultiresolucion agregados;
+    for (int k = 0; k < 720; k++) agregados.agregar(entradas.siguiente().presion);
+    bench.medir("agregados.agregar", [&] { agregados.agregar(entradas.siguiente().presion); });
+    bench.medir("agregados.resumen_1min", [&] { noOptimizar(agregados.resumen(RESOLUCION_1MIN)); });
+    bench.medir("agregados.resumen_1h", [&] { noOptimizar(agregados.resumen(RESOLUCION_1H)); });
+
+    PredictionEngine motor;
+    FilteredData f = filtro.filter();
+    bench.medir("PredictionEngine.predict", [&] {
+        const SensorData& d = entradas.siguiente();
+        noOptimizar(motor.predict(f.temperatura, d.humedad, f.presion, 0.25f, -0.15f));
+    });
+    bench.medir("puntosRiesgo (float)", [&] {
+        const SensorData& d = entradas.siguiente();
+        noOptimizar(puntosRiesgo(f.temperatura, d.humedad, f.presion, 0.25f, -0.15f));
+    });
+    bench.medir("puntosRiesgoFijo", [&] {
+        const SensorData& d = entradas.siguiente();
+        DatosFijos fijos = {aFijo(f.temperatura), aFijo(d.humedad), aFijo(f.presion, PRESION_BASE_FIJO)};
+        noOptimizar(puntosRiesgoFijo(fijos, 250, -150));
+    });
+
+    // Las clases de src/ que compila la placa, con la configuracion de
+    // config.h (ruta_firmware.cpp)
+    reiniciarFirmware();
+    for (int k = 0; k < TAM_VENTANA_FILTRO; k++) {
+        const SensorData& d = entradas.siguiente();
+        agregarFirmware(d.temperatura, d.humedad, d.presion);
+    }
+    bench.medir("firmware.DataFilter.addData", [&] {
+        const SensorData& d = entradas.siguiente();
+        agregarFirmware(d.temperatura, d.humedad, d.presion);
+    });
+    bench.medir("firmware.DataFilter.filter", [&] { noOptimizar(filtrarFirmware()); });
+    bench.medir("firmware.DataFilter.tendencias", [&] {
+        noOptimizar(tendenciaHumedadFirmware());
+        noOptimizar(tendenciaPresionFirmware());
+    });
+    bench.medir("firmware.PredictionEngine.predict", [&] {
+        const SensorData& d = entradas.siguiente();
+        noOptimizar(predecirFirmware(f.temperatura, d.humedad, f.presion, 0.25f, -0.15f));
+    });
+    bench.medir("firmware.tick", [&] {
+        const SensorData& d = entradas.siguiente();
+        noOptimizar(tickFirmware(d.temperatura, d.humedad, d.presion));
+    });
+
+    // Puntuacion de 10000 estaciones: regla escalar contra el lote SoA
+    DatosPrediccionSoA lote;
+    llenarLote(lote, entradas, 10000);
+    size_t diferencias = diferenciasLote(lote);
+    if (diferencias > 0) {
+        fprintf(stderr, "ERROR: puntuarLote difiere del escalar en %zu de %zu filas\n",
+                diferencias, lote.size());
+    }
+    bench.medir("prediccion.escalar/10000", [&] {
+        for (size_t k = 0; k < lote.size(); k++) {
+            int puntos = puntosRiesgo(lote.temperatura[k], lote.humedad[k], lote.presion[k],
+                                      lote.tendenciaHumedad[k], lote.tendenciaPresion[k]);
+            lote.nivel[k] = nivelAlerta(puntos, lote.humedad[k], lote.presion[k]);
+        }
+        noOptimizar(lote.nivel[0]);
+    });
+    bench.medir("prediccion.lote/10000", [&] {
+        lote.puntuar();
+        noOptimizar(lote.nivel[0]);
+    });
+
+    // Serializacion de sendData() (sin la red)
+    LecturaLote lectura = {"ARDUINO_TROPICAL_01", 1704067200000ULL, 27.31f, 81.07f, 1008.52f, 1};
+    char cuerpo[HttpClientBackend::TAM_MAX_LECTURA];
+    bench.medir("sendData.json", [&] {
+        noOptimizar(HttpClientBackend::escribirLecturaJson(lectura, cuerpo, sizeof(cuerpo)));
+    });
+    bench.medir("sendData.binario", [&] {
+        noOptimizar(HttpClientBackend::escribirLecturaBinaria(lectura, cuerpo, sizeof(cuerpo)));
+    });
+    bench.medir("lote.json_compacto", [&] { noOptimizar(HttpClientBackend::lecturaAJson(lectura)); });
+    bench.medir("lote.binario", [&] { noOptimizar(HttpClientBackend::lecturaABinario(lectura)); });
+
+    // Tick completo: leer -> filtrar -> tendencias -> predecir -> serializar
+    SensorController sensor;
+    sensor.semilla(2);
+    DataFilter filtroTick;
+    PredictionEngine motorTick;
+    bench.medir("tick.completo", [&] {
+        SensorData d = sensor.readSensors();
+        filtroTick.addData(d.temperatura, d.humedad, d.presion);
+        FilteredData fd = filtroTick.filter();
+        float tendenciaHumedad = filtroTick.calculateHumidityTrend();
+        float tendenciaPresion = filtroTick.calculatePressureTrend();
+        int alerta = motorTick.predict(fd.temperatura, fd.humedad, fd.presion, tendenciaHumedad, tendenciaPresion);
+        LecturaLote l = {"ARDUINO_TROPICAL_01", 1704067200000ULL, roundToTwoDecimals(fd.temperatura),
+                         roundToTwoDecimals(fd.humedad), roundToTwoDecimals(fd.presion), alerta};
+        noOptimizar(HttpClientBackend::escribirLecturaJson(l, cuerpo, sizeof(cuerpo)));
+    });
+}
+
+int main(int argc, char* argv[]) {
+    OpcionesBench opciones;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hayValor = i + 1 < argc;
+        if (arg == "--filtro" && hayValor) {
+            opciones.filtro = argv[++i];
+        } else if (arg == "--tiempo-ms" && hayValor) {
+            opciones.tiempoMs = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--formato" && hayValor) {
+            opciones.formato = argv[++i];
+        } else if (arg == "--comparar" && hayValor) {
+            opciones.rutaBase = argv[++i];
+        }
+    }
+
+    // El pipeline imprime por Serial en cada etapa; se mide sin consola
+    Serial.silenciar(true);
+
+    Bench bench(opciones);
+    if (opciones.formato == "tabla") {
+        fprintf(stderr, "Midiendo... (firmware.*: src/ con %s de config.h)\n", configuracionFirmware());
+    }
+    ejecutarBenchmarks(bench);
+    bench.imprimir();
+    return 0;
+}
@@ -0,0 +1,83 @@
+// Las cabeceras estandar que usan el shim y src/ se incluyen antes, fuera
+// del espacio de nombres anonimo; dentro, sus guardas las saltan
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include "ruta_firmware.h"
+
+// Mismo camino que env:firmware (registro por Serial, F())
+#ifndef ARDUINO
+  #define ARDUINO 10819
+#endif
+
+namespace {
+#include "../firmware_nativo/Arduino.h"
+#include "../src/data_filter.h"
+#include "../src/prediction_engine.h"
+
+DataFilter filtroFirmware;
+PredictionEngine motorFirmware;
+FilteredData filtradoFirmware = {0, 0, 0};
+
+const char* const NOMBRES_FILTRO[] = {"media", "mediana", "hampel"};
+
+// evaluarAlerta() de sistema_controller.cpp
+int evaluarFirmware() {
+#if USAR_PUNTO_FIJO
+    int32_t tendenciaHumedad = filtroFirmware.tendenciaHumedadFija();
+    int32_t tendenciaPresion = filtroFirmware.tendenciaPresionFija();
+    return motorFirmware.predictFijo(filtroFirmware.filterFijo(), tendenciaHumedad, tendenciaPresion);
+#else
+    float tendenciaHumedad = filtroFirmware.calculateHumidityTrend();
+    float tendenciaPresion = filtroFirmware.calculatePressureTrend();
+    return motorFirmware.predict(filtradoFirmware.temperatura, filtradoFirmware.humedad,
+                                 filtradoFirmware.presion, tendenciaHumedad, tendenciaPresion);
+#endif
+}
+}
+
+const char* configuracionFirmware() {
+    static char texto[48];
+    snprintf(texto, sizeof(texto), "%s/%s/%s", NOMBRES_FILTRO[FILTRO_ROBUSTO],
+             MOTOR_FILTRO == MOTOR_KALMAN ? "kalman" : "ventana", USAR_PUNTO_FIJO ? "fijo" : "float");
+    return texto;
+}
+
+void reiniciarFirmware() {
+    // La prediccion registra por Serial en cada llamada; se mide sin consola
+    Serial.silenciar(true);
+    filtroFirmware = DataFilter();
+    motorFirmware = PredictionEngine();
+    filtradoFirmware = {0, 0, 0};
+}
+
+void agregarFirmware(float temperatura, float humedad, float presion) {
+    filtroFirmware.addData(temperatura, humedad, presion);
+}
+
+float filtrarFirmware() {
+    filtradoFirmware = filtroFirmware.filter();
+    return filtradoFirmware.humedad;
+}
+
+float tendenciaHumedadFirmware() { return filtroFirmware.calculateHumidityTrend(); }
+float tendenciaPresionFirmware() { return filtroFirmware.calculatePressureTrend(); }
+
+int predecirFirmware(float temperatura, float humedad, float presion, float tendenciaHumedad,
+                     float tendenciaPresion) {
+    return motorFirmware.predict(temperatura, humedad, presion, tendenciaHumedad, tendenciaPresion);
+}
+
+int tickFirmware(float temperatura, float humedad, float presion) {
+    filtroFirmware.addData(temperatura, humedad, presion);
+    filtradoFirmware = filtroFirmware.filter();
+    return filtradoFirmware.humedad > 0 ? evaluarFirmware() : -1;
+}
@@ -0,0 +1,24 @@
+#ifndef RUTA_FIRMWARE_H
+#define RUTA_FIRMWARE_H
+
+// ======================
+// RUTA DEL FIRMWARE
+// ======================
+// DataFilter y PredictionEngine de src/ tal como los compila la placa
+// (etapa robusta, motor y punto fijo fijados en config.h), contra el shim
+// de firmware_nativo/. Viven en ruta_firmware.cpp dentro de un espacio de
+// nombres anonimo porque se llaman igual que los del simulador, asi que
+// cada llamada cruza de unidad de traduccion: sin LTO cuesta un par de ns
+// mas que las lambdas de benchmark_pipeline.cpp
+const char* configuracionFirmware();   // p. ej. "media/ventana/float"
+void reiniciarFirmware();
+void agregarFirmware(float temperatura, float humedad, float presion);
+float filtrarFirmware();               // devuelve la humedad filtrada
+float tendenciaHumedadFirmware();
+float tendenciaPresionFirmware();
+int predecirFirmware(float temperatura, float humedad, float presion, float tendenciaHumedad,
+                     float tendenciaPresion);
+// Lectura valida al filtro, filtrado y evaluarAlerta() de sistema_controller.cpp
+int tickFirmware(float temperatura, float humedad, float presion);
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef ADAFRUIT_BMP280_SHIM_H
+#define ADAFRUIT_BMP280_SHIM_H
+
+#include "Arduino.h"
+
+// ======================
+// SUSTITUTO DEL BMP280
+// ======================
+class Adafruit_BMP280 {
+public:
+    bool begin(uint8_t) { return true; }
+    float readPressure() { return 101300.0f; }   // Pa
+    float readTemperature() { return 24.5f; }
+};
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef ARDUINO_SHIM_H
+#define ARDUINO_SHIM_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+
+// ======================
+// SHIM DE ARDUINO PARA EL HOST
+// ======================
+// Lo minimo del core de Arduino para compilar src/ tal cual en Linux
+// (env:firmware): tipos, reloj, random(), F(), String y Serial. No es el
+// simulador: aqui no se reimplementa nada del pipeline, solo lo que el
+// firmware toma del core. Se compila con -DARDUINO, asi que registro.h y
+// metricas.h siguen el mismo camino que en la placa.
+//
+// Diferencias que conviene recordar al perfilar: int y unsigned long
+// miden 32/64 bits en lugar de 16/32 y el float es hardware, no soft-float.
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+
+class __FlashStringHelper;
+#define F(texto) (reinterpret_cast<const __FlashStringHelper*>(texto))
+
+template <class T> inline T min(T a, T b) { return a < b ? a : b; }
+template <class T> inline T max(T a, T b) { return a > b ? a : b; }
+
+// ======================
+// RELOJ
+// ======================
+// Por defecto el reloj es virtual: delay() avanza el tiempo al instante,
+// asi que horas de funcionamiento se ejecutan en lo que tarda la CPU y
+// un perfil solo ve trabajo real. main_firmware.cpp lo cambia al reloj
+// del sistema con --tiempo-real.
+struct RelojShim {
+    bool virtualActivo = true;
+    std::atomic<uint64_t> virtualUs{0};
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+
+    uint64_t realUs() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - inicio)
+            .count();
+    }
+
+    uint64_t ahoraUs() const {
+        return virtualActivo ? virtualUs.load(std::memory_order_relaxed) : realUs();
+    }
+};
+
+inline RelojShim relojShim;
+
+// Como en el AVR, millis() es de 32 bits y da la vuelta a los ~49 dias.
+// micros() mide siempre tiempo real: solo lo usan las metricas por etapa,
+// que con el reloj virtual marcarian 0
+inline unsigned long millis() { return (uint32_t)(relojShim.ahoraUs() / 1000); }
+inline unsigned long micros() { return (uint32_t)relojShim.realUs(); }
+
+inline void delay(unsigned long ms) {
+    if (relojShim.virtualActivo) relojShim.virtualUs.fetch_add((uint64_t)ms * 1000, std::memory_order_relaxed);
+    else std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// ======================
+// RANDOM
+// ======================
+inline std::minstd_rand& generadorShim() {
+    static std::minstd_rand generador(1);
+    return generador;
+}
+
+inline void randomSeed(unsigned long semilla) { generadorShim().seed(semilla); }
+
+inline long random(long maximo) {
+    if (maximo <= 0) return 0;
+    return (long)(generadorShim()() % (unsigned long)maximo);
+}
+
+inline long random(long minimo, long maximo) {
+    return maximo > minimo ? minimo + random(maximo - minimo) : minimo;
+}
+
+// ======================
+// STRING
+// ======================
+// El subconjunto de String de Arduino que usa el firmware, sobre std::string
+class String : public std::string {
+public:
+    String() {}
+    String(const char* texto) : std::string(texto ? texto : "") {}
+    String(const std::string& texto) : std::string(texto) {}
+
+    unsigned int length() const { return (unsigned int)size(); }
+    void concat(const char* texto) { append(texto); }
+};
+
+// ======================
+// SERIAL
+// ======================
+// Print de Arduino sobre stdout con buffer de la libc; silenciar() lo
+// descarta todo para perfilar sin E/S
+class SerialShim {
+private:
+    bool silencioso = false;
+
+    void escribir(const char* texto, size_t largo) {
+        if (!silencioso) fwrite(texto, 1, largo, stdout);
+    }
+
+    // snprintf devuelve lo que habria escrito; se recorta al buffer
+    void escribirFormateado(const char* buffer, int largo, size_t capacidad) {
+        if (largo > 0) escribir(buffer, min((size_t)largo, capacidad - 1));
+    }
+
+    template <class T> void imprimirEntero(const char* formato, T valor) {
+        char buffer[24];
+        escribirFormateado(buffer, snprintf(buffer, sizeof(buffer), formato, valor), sizeof(buffer));
+    }
+
+public:
+    void begin(long) {}
+    void flush() { fflush(stdout); }
+    void silenciar(bool valor) { silencioso = valor; }
+
+    size_t write(char c) {
+        escribir(&c, 1);
+        return 1;
+    }
+
+    void print(const char* texto) { escribir(texto, strlen(texto)); }
+    void print(const __FlashStringHelper* texto) { print(reinterpret_cast<const char*>(texto)); }
+    void print(const String& texto) { escribir(texto.data(), texto.size()); }
+    void print(char c) { write(c); }
+    void print(int valor) { imprimirEntero("%d", valor); }
+    void print(unsigned int valor) { imprimirEntero("%u", valor); }
+    void print(long valor) { imprimirEntero("%ld", valor); }
+    void print(unsigned long valor) { imprimirEntero("%lu", valor); }
+
+    void print(double valor, int decimales = 2) {
+        char buffer[48];
+        escribirFormateado(buffer, snprintf(buffer, sizeof(buffer), "%.*f", decimales, valor), sizeof(buffer));
+    }
+
+    template <class T> void println(const T& valor) {
+        print(valor);
+        println();
+    }
+    void println(double valor, int decimales) {
+        print(valor, decimales);
+        println();
+    }
+    void println() { escribir("\r\n", 2); }
+};
+
+inline SerialShim Serial;
+
+// ======================
+// RED
+// ======================
+class IPAddress {
+private:
+    uint8_t octetos[4];
+
+public:
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : octetos{a, b, c, d} {}
+    uint8_t operator[](int i) const { return octetos[i]; }
+};
+
+#endif
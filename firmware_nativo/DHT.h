@@ -0,0 +1,22 @@
+#ifndef DHT_SHIM_H
+#define DHT_SHIM_H
+
+#include "Arduino.h"
+
+// ======================
+// SUSTITUTO DEL DHT22
+// ======================
+// Solo para compilar el camino MODO_SIMULACION false en el host: devuelve
+// valores fijos plausibles, sin fallos de lectura
+#define DHT11 11
+#define DHT22 22
+
+class DHT {
+public:
+    DHT(uint8_t, uint8_t) {}
+    void begin() {}
+    float readTemperature() { return 24.5f; }
+    float readHumidity() { return 70.0f; }
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef EEPROM_SHIM_H
+#define EEPROM_SHIM_H
+
+#include "Arduino.h"
+
+// ======================
+// EEPROM EN RAM
+// ======================
+// 1 KB como la del Uno, borrada a 0xFF. put() solo copia los bytes que
+// cambian, igual que EEPROM.update(); escrituras cuenta las celdas
+// escritas para estimar el desgaste en un perfil
+class EEPROMShim {
+private:
+    static const int TAMANO = 1024;
+    uint8_t celdas[TAMANO];
+
+public:
+    unsigned long escrituras = 0;
+
+    EEPROMShim() { memset(celdas, 0xFF, sizeof(celdas)); }
+
+    int length() const { return TAMANO; }
+    uint8_t read(int direccion) const { return celdas[direccion]; }
+
+    void update(int direccion, uint8_t valor) {
+        if (celdas[direccion] == valor) return;
+        celdas[direccion] = valor;
+        escrituras++;
+    }
+    void write(int direccion, uint8_t valor) { update(direccion, valor); }
+
+    template <class T> T& get(int direccion, T& valor) const {
+        memcpy(&valor, celdas + direccion, sizeof(T));
+        return valor;
+    }
+
+    template <class T> const T& put(int direccion, const T& valor) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&valor);
+        for (size_t i = 0; i < sizeof(T); i++) update(direccion + (int)i, bytes[i]);
+        return valor;
+    }
+};
+
+inline EEPROMShim EEPROM;
+
+#endif
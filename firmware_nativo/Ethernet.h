@@ -0,0 +1,25 @@
+#ifndef ETHERNET_SHIM_H
+#define ETHERNET_SHIM_H
+
+#include "Arduino.h"
+
+// ======================
+// SUSTITUTO DE ETHERNET
+// ======================
+// Sin red: el firmware en el host no abre sockets (ver HttpClient.h)
+class EthernetClient {
+public:
+    bool connected() { return false; }
+    int available() { return 0; }
+    int read() { return -1; }
+    void stop() {}
+};
+
+class EthernetShim {
+public:
+    void begin(uint8_t*, const IPAddress&) {}
+};
+
+inline EthernetShim Ethernet;
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef HTTPCLIENT_SHIM_H
+#define HTTPCLIENT_SHIM_H
+
+#include "Arduino.h"
+#include "Ethernet.h"
+
+// ======================
+// SUSTITUTO DE ARDUINOHTTPCLIENT
+// ======================
+// Acepta cada solicitud y responde estadoRespuesta sin tocar la red, asi
+// que un perfil de MODO_SIMULACION false mide el firmware y no el backend.
+// Cuenta solicitudes, conexiones y bytes de cuerpo para comprobar lo
+// enviado. Como en la biblioteca, sin connectionKeepAlive() cada solicitud
+// abre su conexion; con el, se reutiliza hasta que alguien llama a stop()
+class HttpClient {
+private:
+    bool keepAlive = false;
+    bool abierta = false;
+
+public:
+    int estadoRespuesta = 200;
+    unsigned long solicitudes = 0;
+    unsigned long conexiones = 0;
+    unsigned long bytesCuerpo = 0;
+
+    HttpClient(EthernetClient&, const char*, uint16_t) {}
+
+    void connectionKeepAlive() { keepAlive = true; }
+
+    void beginRequest() {}
+    int post(const char*) {
+        if (!abierta || !keepAlive) conexiones++;
+        abierta = true;
+        solicitudes++;
+        return 0;
+    }
+    void sendHeader(const char*, const char*) {}
+    void sendHeader(const char*, int) {}
+    void sendHeader(const char*, unsigned int) {}
+    void beginBody() {}
+    size_t print(const String& texto) {
+        bytesCuerpo += texto.size();
+        return texto.size();
+    }
+    size_t write(const uint8_t*, size_t largo) {
+        bytesCuerpo += largo;
+        return largo;
+    }
+    void endRequest() {}
+
+    // Respuesta vacia con Content-Length: 0
+    int responseStatusCode() { return estadoRespuesta; }
+    int skipResponseHeaders() { return 0; }
+    int contentLength() { return 0; }
+    bool endOfBodyReached() { return true; }
+    int read() { return -1; }
+    uint8_t connected() { return abierta; }
+    String responseBody() { return String(); }
+    void stop() { abierta = false; }
+};
+
+#endif
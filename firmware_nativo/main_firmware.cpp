@@ -0,0 +1,86 @@
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <HttpClient.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "../src/metricas.h"
+
+// ======================
+// FIRMWARE EN EL HOST
+// ======================
+// Ejecuta setup() y loop() de src/main.cpp, compilados tal cual contra el
+// shim de este directorio, para perfilar en Linux el mismo codigo que
+// corre en la placa (perf, valgrind, gprof):
+//
+//   pio run -e firmware
+//   perf record -g .pio/build/firmware/program --silencio --duracion 604800
+//   valgrind --tool=callgrind .pio/build/firmware/program --silencio
+//
+// programa [--duracion SEG] [--semilla S] [--tiempo-real] [--silencio]
+// Con el reloj virtual (por defecto) dormir no cuesta nada: el tiempo de
+// CPU es solo el del firmware.
+void setup();
+void loop();
+
+extern MetricasEstacion metricas;
+extern HttpClient httpClient;
+
+// Se imprime ante una opcion desconocida o sin su valor
+static const char* const USO =
+    "Uso: firmware [--duracion SEG] [--semilla S] [--tiempo-real] [--silencio]\n";
+
+static const char* const ETAPAS_FIRMWARE[NUM_ETAPAS] = {
+    "lectura", "filtrado", "prediccion", "serializacion", "http"
+};
+
+int main(int argc, char* argv[]) {
+    unsigned long duracionMs = 86400UL * 1000UL;   // un dia simulado
+    unsigned long semilla = 1;
+    bool tiempoReal = false;
+    bool silencio = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hayValor = i + 1 < argc;
+        if (arg == "--duracion" && hayValor) {
+            duracionMs = strtoul(argv[++i], nullptr, 10) * 1000UL;
+        } else if (arg == "--semilla" && hayValor) {
+            semilla = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--tiempo-real") {
+            tiempoReal = true;
+        } else if (arg == "--silencio") {
+            silencio = true;
+        } else {
+            fprintf(stderr, "Opcion desconocida o sin valor: %s\n%s", arg.c_str(), USO);
+            return 2;
+        }
+    }
+
+    relojShim.virtualActivo = !tiempoReal;
+    randomSeed(semilla);
+    Serial.silenciar(silencio);
+
+    auto inicioReal = std::chrono::steady_clock::now();
+    setup();
+    unsigned long vueltas = 0;
+    while (millis() < duracionMs) {
+        loop();
+        vueltas++;
+    }
+    double real = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicioReal).count();
+    Serial.flush();
+
+    printf("RESUMEN t=%lus vueltas=%lu (%.3fs reales, %.0f ns/vuelta) http=%lu conexiones=%lu bytes=%lu "
+           "eeprom_escrituras=%lu\n",
+           millis() / 1000, vueltas, real, vueltas > 0 ? real * 1e9 / vueltas : 0.0,
+           httpClient.solicitudes, httpClient.conexiones, httpClient.bytesCuerpo, EEPROM.escrituras);
+    // Las metricas del firmware se reinician con cada lote enviado: esto
+    // es lo acumulado desde el ultimo
+    for (int e = 0; e < NUM_ETAPAS; e++) {
+        printf("  %-14s n=%-6u media=%lu us max=%lu us\n", ETAPAS_FIRMWARE[e], metricas.etapas[e].n,
+               (unsigned long)metricas.mediaUs((EtapaMetrica)e), (unsigned long)metricas.etapas[e].maxUs);
+    }
+    return 0;
+}
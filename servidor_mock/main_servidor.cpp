@@ -0,0 +1,135 @@
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "servidor_epoll.h"
+
+using namespace std;
+
+// ======================
+// BACKEND SIMULADO PARA PRUEBAS DE CARGA
+// ======================
+// pio run -e servidor_mock && .pio/build/servidor_mock/program [opciones]
+//   --puerto P             4000 por defecto, el de API_URL
+//   --hilos N              hilos con su propio epoll (1 por defecto)
+//   --latencia MS          retardo fijo de cada respuesta
+//   --variacion MS         mas un extra uniforme en [0, MS]
+//   --errores TASA         fraccion de solicitudes respondidas con error
+//   --codigos C1,C2,...    codigos de error a elegir (500 por defecto)
+//   --cortes TASA          fraccion de solicitudes sin respuesta (conexion cortada)
+//   --rechazos TASA        en lotes, fraccion de lecturas con "ok": false
+//   --duracion SEG         termina solo (0 = hasta Ctrl+C)
+//   --semilla S
+// Escucha solo en 127.0.0.1. Cada segundo imprime solicitudes/s y, al
+// terminar, el total por codigo de respuesta.
+static atomic<bool> interrumpido{false};
+
+static void alInterrumpir(int) {
+    interrumpido = true;
+}
+
+static bool leerOpciones(int argc, char* argv[], ConfigServidorMock& config, unsigned long& duracionMs) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hayValor = i + 1 < argc;
+        if (arg == "--puerto" && hayValor) {
+            config.puerto = atoi(argv[++i]);
+        } else if (arg == "--hilos" && hayValor) {
+            config.hilos = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--latencia" && hayValor) {
+            config.latenciaMs = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--variacion" && hayValor) {
+            config.variacionMs = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--errores" && hayValor) {
+            config.tasaError = atof(argv[++i]);
+        } else if (arg == "--codigos" && hayValor) {
+            config.codigosError.clear();
+            for (char* p = strtok(argv[++i], ","); p; p = strtok(nullptr, ",")) {
+                int codigo = atoi(p);
+                if (codigo >= 100 && codigo < EstadisticasServidor::MAX_CODIGO) config.codigosError.push_back(codigo);
+            }
+        } else if (arg == "--cortes" && hayValor) {
+            config.tasaCorte = atof(argv[++i]);
+        } else if (arg == "--rechazos" && hayValor) {
+            config.tasaRechazoLectura = atof(argv[++i]);
+        } else if (arg == "--duracion" && hayValor) {
+            duracionMs = strtoul(argv[++i], nullptr, 10) * 1000UL;
+        } else if (arg == "--semilla" && hayValor) {
+            config.semilla = strtoul(argv[++i], nullptr, 10);
+        } else {
+            cerr << "Opcion desconocida: " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+static void imprimirCodigos(const EstadisticasServidor& stats) {
+    cout << "codigos";
+    for (int c = 0; c < EstadisticasServidor::MAX_CODIGO; c++) {
+        unsigned long long n = stats.codigos[c].load(memory_order_relaxed);
+        if (n > 0) cout << " " << c << ":" << n;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    ConfigServidorMock config;
+    unsigned long duracionMs = 0;
+    if (!leerOpciones(argc, argv, config, duracionMs)) return 2;
+
+    ServidorMock servidor(config);
+    if (!servidor.iniciar()) {
+        cerr << "No se pudo escuchar en 127.0.0.1:" << config.puerto << " (puerto en uso?)\n";
+        return 1;
+    }
+    signal(SIGINT, alInterrumpir);
+    signal(SIGTERM, alInterrumpir);
+
+    const ConfigServidorMock& c = servidor.configuracion();
+    cout << "====================================\n"
+         << "BACKEND SIMULADO: http://127.0.0.1:" << c.puerto << c.ruta << " (" << c.hilos << " hilos)\n"
+         << "latencia " << c.latenciaMs << "+[0," << c.variacionMs << "] ms, errores " << c.tasaError * 100
+         << "%, cortes " << c.tasaCorte * 100 << "%, rechazos " << c.tasaRechazoLectura * 100 << "%\n"
+         << "====================================" << endl;
+
+    const EstadisticasServidor& stats = servidor.stats;
+    auto inicio = chrono::steady_clock::now();
+    auto ultimo = inicio;
+    unsigned long long solicitudesAntes = 0;
+    while (!interrumpido) {
+        this_thread::sleep_for(chrono::milliseconds(100));
+        auto ahora = chrono::steady_clock::now();
+        double transcurrido = chrono::duration<double>(ahora - inicio).count();
+        if (duracionMs > 0 && transcurrido * 1000 >= duracionMs) break;
+        double intervalo = chrono::duration<double>(ahora - ultimo).count();
+        if (intervalo < 1.0) continue;
+
+        unsigned long long solicitudes = stats.solicitudes.load(memory_order_relaxed);
+        if (solicitudes == solicitudesAntes) {
+            ultimo = ahora;
+            continue;   // sin trafico no se llena la consola
+        }
+        printf("t=%.0fs solicitudes/s=%.0f total=%llu lecturas=%llu conexiones=%llu abiertas=%llu cortes=%llu\n",
+               transcurrido, (solicitudes - solicitudesAntes) / intervalo, solicitudes,
+               (unsigned long long)stats.lecturas.load(), (unsigned long long)stats.conexiones.load(),
+               (unsigned long long)stats.abiertas.load(), (unsigned long long)stats.cortes.load());
+        fflush(stdout);
+        solicitudesAntes = solicitudes;
+        ultimo = ahora;
+    }
+    servidor.parar();
+
+    double total = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+    cout << "RESUMEN " << total << "s solicitudes=" << stats.solicitudes
+         << " lecturas=" << stats.lecturas << " rechazadas=" << stats.lecturasRechazadas
+         << " bytes=" << stats.bytesRecibidos << " conexiones=" << stats.conexiones
+         << " cortes=" << stats.cortes << " malformadas=" << stats.malformadas << " ";
+    imprimirCodigos(stats);
+    cout << endl;
+    return 0;
+}
@@ -0,0 +1,505 @@
+#ifndef SERVIDOR_EPOLL_H
+#define SERVIDOR_EPOLL_H
+
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../src/formato_binario.h"
+
+using namespace std;
+
+// ======================
+// BACKEND SIMULADO (EPOLL)
+// ======================
+// Servidor de ingesta para pruebas de carga del envio, sin dependencias:
+// acepta los POST de HttpClientBackend (lectura suelta o lote, JSON o
+// binario) en la ruta de API_URL y responde como el backend real, con
+// latencia, errores y cortes configurables. Solo Linux.
+//
+// Cada hilo tiene su socket de escucha (SO_REUSEPORT: el kernel reparte
+// las conexiones) y su propio epoll; una conexion vive siempre en el mismo
+// hilo, asi que no hay nada compartido salvo los contadores atomicos.
+// HTTP/1.1 con keep-alive y solicitudes encadenadas. La latencia no
+// duerme el hilo: la respuesta se programa en un monticulo de
+// vencimientos y epoll_wait espera como mucho hasta el primero.
+struct ConfigServidorMock {
+    int puerto = 4000;
+    unsigned hilos = 1;
+    string ruta = "/api/sensores";
+    unsigned long latenciaMs = 0;       // retardo fijo de cada respuesta
+    unsigned long variacionMs = 0;      // mas un extra uniforme en [0, variacionMs]
+    double tasaError = 0;               // fraccion de solicitudes con codigo de error
+    vector<int> codigosError = {500};   // se elige uno al azar
+    double tasaCorte = 0;               // fraccion de solicitudes sin respuesta: se corta la conexion
+    double tasaRechazoLectura = 0;      // en lotes, fraccion de lecturas con "ok": false
+    unsigned semilla = 1;
+};
+
+struct EstadisticasServidor {
+    static const int MAX_CODIGO = 600;
+
+    atomic<uint64_t> solicitudes{0};
+    atomic<uint64_t> lecturas{0};
+    atomic<uint64_t> lecturasRechazadas{0};
+    atomic<uint64_t> bytesRecibidos{0};
+    atomic<uint64_t> conexiones{0};        // aceptadas en total
+    atomic<uint64_t> abiertas{0};
+    atomic<uint64_t> cortes{0};
+    atomic<uint64_t> malformadas{0};
+    atomic<uint64_t> codigos[MAX_CODIGO];
+
+    EstadisticasServidor() {
+        for (auto& c : codigos) c = 0;
+    }
+
+    static void contar(atomic<uint64_t>& contador, uint64_t n = 1) {
+        contador.fetch_add(n, memory_order_relaxed);
+    }
+};
+
+// Lecturas de un cuerpo: elementos de un array JSON, registros de las
+// tramas binarias o 1 para un objeto suelto
+inline size_t contarLecturas(const string& cuerpo, bool binario) {
+    if (binario) {
+        size_t n = 0, pos = 0;
+        while (pos + TAM_CABECERA_TRAMA <= cuerpo.size() && cuerpo[pos] == 'R' && cuerpo[pos + 1] == 'S') {
+            uint8_t largoId = (uint8_t)cuerpo[pos + 3];
+            if (pos + TAM_CABECERA_TRAMA + largoId > cuerpo.size()) break;
+            uint8_t registros = (uint8_t)cuerpo[pos + 4 + largoId];
+            n += registros;
+            pos += tamTramaBinaria(largoId, registros);
+        }
+        return n > 0 ? n : 1;
+    }
+    size_t i = 0;
+    while (i < cuerpo.size() && isspace((unsigned char)cuerpo[i])) i++;
+    if (i == cuerpo.size() || cuerpo[i] != '[') return 1;
+
+    // Objetos de primer nivel del array; las llaves dentro de cadenas no cuentan
+    size_t n = 0;
+    int profundidad = 0;
+    bool enCadena = false;
+    for (i++; i < cuerpo.size(); i++) {
+        char c = cuerpo[i];
+        if (enCadena) {
+            if (c == '\\') i++;
+            else if (c == '"') enCadena = false;
+        } else if (c == '"') {
+            enCadena = true;
+        } else if (c == '{') {
+            if (profundidad++ == 0) n++;
+        } else if (c == '}') {
+            profundidad--;
+        }
+    }
+    return n;
+}
+
+class TrabajadorEpoll {
+private:
+    // Mayor Content-Length que se acepta: el lote mas grande del firmware
+    // ocupa unos KB, y asi un largo falso no hace crecer el buffer sin fin
+    static constexpr size_t MAX_CUERPO = 1 << 20;
+
+    struct Conexion {
+        uint64_t id;
+        string entrada;
+        string salida;
+        uint64_t ultimaRespuestaUs = 0;   // las respuestas salen en orden
+        bool cerrarTrasEnviar = false;
+        bool esperaSalida = false;        // registrada con EPOLLOUT
+        bool rechazada = false;           // ya tiene su 413: se ignora lo que siga llegando
+    };
+
+    // Respuesta programada; id distingue una conexion nueva que reutiliza
+    // el mismo descriptor
+    struct Pendiente {
+        uint64_t vencimientoUs;
+        int fd;
+        uint64_t id;
+        string respuesta;
+        bool cerrar;
+        bool operator>(const Pendiente& otra) const { return vencimientoUs > otra.vencimientoUs; }
+    };
+
+    const ConfigServidorMock& config;
+    EstadisticasServidor& stats;
+    const atomic<bool>& detener;
+    int epfd = -1;
+    int escucha = -1;
+    uint64_t siguienteId = 1;
+    unordered_map<int, Conexion> conexiones;
+    priority_queue<Pendiente, vector<Pendiente>, greater<Pendiente>> pendientes;
+    mt19937 generador;
+    uniform_real_distribution<double> uniforme{0.0, 1.0};
+
+    static uint64_t ahoraUs() {
+        return chrono::duration_cast<chrono::microseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static const char* textoEstado(int codigo) {
+        switch (codigo) {
+            case 200: return "OK";
+            case 201: return "Created";
+            case 400: return "Bad Request";
+            case 404: return "Not Found";
+            case 413: return "Payload Too Large";
+            case 429: return "Too Many Requests";
+            case 500: return "Internal Server Error";
+            case 502: return "Bad Gateway";
+            case 503: return "Service Unavailable";
+            case 504: return "Gateway Timeout";
+            default: return "Error";
+        }
+    }
+
+    void cerrar(int fd) {
+        epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        conexiones.erase(fd);
+        stats.abiertas.fetch_sub(1, memory_order_relaxed);
+    }
+
+    void aceptar() {
+        while (true) {
+            int fd = accept4(escucha, nullptr, nullptr, SOCK_NONBLOCK);
+            if (fd < 0) return;   // EAGAIN: no quedan
+            int uno = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &uno, sizeof(uno));
+            epoll_event ev = {};
+            ev.events = EPOLLIN | EPOLLRDHUP;
+            ev.data.fd = fd;
+            epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+            Conexion& c = conexiones[fd];
+            c = Conexion();
+            c.id = siguienteId++;
+            EstadisticasServidor::contar(stats.conexiones);
+            EstadisticasServidor::contar(stats.abiertas);
+        }
+    }
+
+    // Cuerpo de exito: para un lote, un array con el veredicto de cada
+    // lectura (lo que interpreta HttpClientBackend::interpretarRespuestaLote)
+    string cuerpoExito(size_t lecturas, bool esLote) {
+        if (!esLote) return "{\"ok\":true}";
+        string cuerpo = "[";
+        for (size_t i = 0; i < lecturas; i++) {
+            bool ok = uniforme(generador) >= config.tasaRechazoLectura;
+            if (!ok) EstadisticasServidor::contar(stats.lecturasRechazadas);
+            if (i > 0) cuerpo += ',';
+            cuerpo += ok ? "{\"ok\":true}" : "{\"ok\":false}";
+        }
+        return cuerpo + "]";
+    }
+
+    // Devuelve false si la conexion se corto
+    bool atender(int fd, Conexion& c, const string& metodo, const string& ruta, const string& cuerpo,
+                 bool binario, bool cerrarDespues) {
+        EstadisticasServidor::contar(stats.solicitudes);
+        EstadisticasServidor::contar(stats.bytesRecibidos, cuerpo.size());
+        if (config.tasaCorte > 0 && uniforme(generador) < config.tasaCorte) {
+            EstadisticasServidor::contar(stats.cortes);
+            cerrar(fd);
+            return false;
+        }
+
+        int codigo;
+        string respuesta;
+        if (metodo == "GET" && ruta == "/salud") {
+            codigo = 200;
+            respuesta = "{\"ok\":true}";
+        } else if (metodo != "POST" || ruta != config.ruta) {
+            codigo = 404;
+            respuesta = "{\"error\":\"ruta desconocida\"}";
+        } else if (config.tasaError > 0 && uniforme(generador) < config.tasaError) {
+            codigo = config.codigosError[generador() % config.codigosError.size()];
+            respuesta = "{\"error\":\"simulado\"}";
+        } else {
+            size_t n = contarLecturas(cuerpo, binario);
+            EstadisticasServidor::contar(stats.lecturas, n);
+            codigo = 201;
+            bool esLote = !binario && cuerpo.find('[') < cuerpo.find('{');
+            respuesta = cuerpoExito(n, esLote);
+        }
+        uint64_t retardoUs = config.latenciaMs * 1000;
+        if (config.variacionMs > 0) retardoUs += (uint64_t)(uniforme(generador) * config.variacionMs * 1000);
+        responder(fd, c, codigo, respuesta, cerrarDespues, retardoUs);
+        return true;
+    }
+
+    // Sale en el acto o se programa tras las anteriores de la conexion
+    void responder(int fd, Conexion& c, int codigo, const string& respuesta, bool cerrarDespues,
+                   uint64_t retardoUs) {
+        EstadisticasServidor::contar(stats.codigos[codigo < EstadisticasServidor::MAX_CODIGO ? codigo : 0]);
+
+        char cabecera[256];
+        int largo = snprintf(cabecera, sizeof(cabecera),
+                             "HTTP/1.1 %d %s\r\nContent-Type: application/json\r\nContent-Length: %zu\r\n%s\r\n",
+                             codigo, textoEstado(codigo), respuesta.size(),
+                             cerrarDespues ? "Connection: close\r\n" : "");
+        string completa = string(cabecera, largo) + respuesta;
+
+        if (retardoUs == 0 && c.ultimaRespuestaUs == 0) {
+            c.salida += completa;
+            c.cerrarTrasEnviar = cerrarDespues;
+            return;
+        }
+        uint64_t vencimiento = max(ahoraUs() + retardoUs, c.ultimaRespuestaUs + 1);
+        c.ultimaRespuestaUs = vencimiento;
+        pendientes.push({vencimiento, fd, c.id, move(completa), cerrarDespues});
+    }
+
+    // Solicitudes completas del buffer de entrada (puede haber varias
+    // encadenadas). Devuelve false si la conexion se cerro
+    bool procesarEntrada(int fd, Conexion& c) {
+        while (true) {
+            size_t finCabecera = c.entrada.find("\r\n\r\n");
+            if (finCabecera == string::npos) {
+                if (c.entrada.size() > 65536) {
+                    EstadisticasServidor::contar(stats.malformadas);
+                    cerrar(fd);
+                    return false;
+                }
+                return true;
+            }
+
+            size_t finLinea = c.entrada.find("\r\n");
+            size_t espacio1 = c.entrada.find(' ');
+            size_t espacio2 = c.entrada.find(' ', espacio1 + 1);
+            if (espacio1 == string::npos || espacio2 == string::npos || espacio2 > finLinea) {
+                EstadisticasServidor::contar(stats.malformadas);
+                cerrar(fd);
+                return false;
+            }
+            string metodo = c.entrada.substr(0, espacio1);
+            string ruta = c.entrada.substr(espacio1 + 1, espacio2 - espacio1 - 1);
+
+            // Cabeceras: solo importan el largo, el tipo y Connection
+            unsigned long long largoCuerpo = 0;
+            bool binario = false;
+            bool cerrarDespues = false;
+            size_t pos = finLinea + 2;
+            while (pos < finCabecera) {
+                size_t fin = c.entrada.find("\r\n", pos);
+                string linea = c.entrada.substr(pos, fin - pos);
+                for (size_t k = 0; k < linea.size() && linea[k] != ':'; k++) linea[k] = tolower(linea[k]);
+                if (linea.compare(0, 15, "content-length:") == 0) {
+                    largoCuerpo = strtoull(linea.c_str() + 15, nullptr, 10);
+                } else if (linea.compare(0, 13, "content-type:") == 0) {
+                    binario = linea.find("x-rainsense") != string::npos;
+                } else if (linea.compare(0, 11, "connection:") == 0) {
+                    cerrarDespues = linea.find("close") != string::npos;
+                }
+                pos = fin + 2;
+            }
+
+            // Un largo absurdo no se espera ni se reserva: 413 y se cierra
+            // en cuanto sale la respuesta
+            if (largoCuerpo > MAX_CUERPO) {
+                EstadisticasServidor::contar(stats.malformadas);
+                responder(fd, c, 413, "{\"error\":\"cuerpo demasiado grande\"}", true, 0);
+                c.rechazada = true;
+                c.entrada.clear();
+                return true;
+            }
+
+            size_t total = finCabecera + 4 + largoCuerpo;
+            if (c.entrada.size() < total) return true;   // falta cuerpo
+            string cuerpo = c.entrada.substr(finCabecera + 4, largoCuerpo);
+            c.entrada.erase(0, total);
+            if (!atender(fd, c, metodo, ruta, cuerpo, binario, cerrarDespues)) return false;
+        }
+    }
+
+    // Escribe lo que admita el socket; el resto espera a EPOLLOUT
+    bool escribir(int fd, Conexion& c) {
+        while (!c.salida.empty()) {
+            ssize_t n = ::send(fd, c.salida.data(), c.salida.size(), MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                cerrar(fd);
+                return false;
+            }
+            c.salida.erase(0, n);
+        }
+        if (c.salida.empty() && c.cerrarTrasEnviar) {
+            cerrar(fd);
+            return false;
+        }
+        bool esperar = !c.salida.empty();
+        if (esperar != c.esperaSalida) {
+            epoll_event ev = {};
+            ev.events = EPOLLIN | EPOLLRDHUP | (esperar ? (uint32_t)EPOLLOUT : 0u);
+            ev.data.fd = fd;
+            epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev);
+            c.esperaSalida = esperar;
+        }
+        return true;
+    }
+
+    void leer(int fd) {
+        auto it = conexiones.find(fd);
+        if (it == conexiones.end()) return;
+        Conexion& c = it->second;
+        char buffer[16384];
+        while (true) {
+            ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+            if (n > 0) {
+                if (!c.rechazada) c.entrada.append(buffer, n);
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            cerrar(fd);   // 0: el cliente cerro
+            return;
+        }
+        if (c.rechazada) {
+            if (!c.salida.empty()) escribir(fd, c);
+            return;
+        }
+        if (procesarEntrada(fd, c) && !c.salida.empty()) escribir(fd, c);
+    }
+
+    // Respuestas cuyo retardo ya vencio
+    void despacharVencidas() {
+        uint64_t ahora = ahoraUs();
+        while (!pendientes.empty() && pendientes.top().vencimientoUs <= ahora) {
+            Pendiente p = pendientes.top();
+            pendientes.pop();
+            auto it = conexiones.find(p.fd);
+            if (it == conexiones.end() || it->second.id != p.id) continue;   // ya cerrada
+            Conexion& c = it->second;
+            if (c.ultimaRespuestaUs == p.vencimientoUs) c.ultimaRespuestaUs = 0;   // era la ultima
+            c.salida += p.respuesta;
+            c.cerrarTrasEnviar = p.cerrar;
+            escribir(p.fd, c);
+        }
+    }
+
+    int esperaMs() const {
+        if (pendientes.empty()) return 100;   // para notar detener
+        uint64_t ahora = ahoraUs();
+        uint64_t vence = pendientes.top().vencimientoUs;
+        if (vence <= ahora) return 0;
+        return (int)min<uint64_t>(100, (vence - ahora + 999) / 1000);
+    }
+
+public:
+    TrabajadorEpoll(const ConfigServidorMock& cfg, EstadisticasServidor& s, const atomic<bool>& detenerServidor,
+                    unsigned indice)
+        : config(cfg), stats(s), detener(detenerServidor), generador(cfg.semilla + indice) {}
+
+    ~TrabajadorEpoll() {
+        for (auto& c : conexiones) ::close(c.first);
+        if (escucha >= 0) ::close(escucha);
+        if (epfd >= 0) ::close(epfd);
+    }
+
+    bool iniciar() {
+        escucha = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (escucha < 0) return false;
+        int uno = 1;
+        setsockopt(escucha, SOL_SOCKET, SO_REUSEADDR, &uno, sizeof(uno));
+        setsockopt(escucha, SOL_SOCKET, SO_REUSEPORT, &uno, sizeof(uno));
+        sockaddr_in direccion = {};
+        direccion.sin_family = AF_INET;
+        direccion.sin_port = htons(config.puerto);
+        direccion.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(escucha, (sockaddr*)&direccion, sizeof(direccion)) < 0 || listen(escucha, 1024) < 0) {
+            return false;
+        }
+
+        epfd = epoll_create1(0);
+        if (epfd < 0) return false;
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.fd = escucha;
+        return epoll_ctl(epfd, EPOLL_CTL_ADD, escucha, &ev) == 0;
+    }
+
+    void ejecutar() {
+        epoll_event eventos[256];
+        while (!detener.load(memory_order_relaxed)) {
+            int n = epoll_wait(epfd, eventos, 256, esperaMs());
+            for (int i = 0; i < n; i++) {
+                int fd = eventos[i].data.fd;
+                if (fd == escucha) {
+                    aceptar();
+                    continue;
+                }
+                if (eventos[i].events & (EPOLLERR | EPOLLHUP)) {
+                    if (conexiones.count(fd)) cerrar(fd);
+                    continue;
+                }
+                if (eventos[i].events & EPOLLOUT) {
+                    auto it = conexiones.find(fd);
+                    if (it != conexiones.end() && !escribir(fd, it->second)) continue;
+                }
+                if (eventos[i].events & (EPOLLIN | EPOLLRDHUP)) leer(fd);
+            }
+            despacharVencidas();
+        }
+    }
+};
+
+class ServidorMock {
+private:
+    ConfigServidorMock config;
+    vector<unique_ptr<TrabajadorEpoll>> trabajadores;
+    vector<thread> hilos;
+    atomic<bool> detener{false};
+
+public:
+    EstadisticasServidor stats;
+
+    explicit ServidorMock(const ConfigServidorMock& cfg) : config(cfg) {
+        if (config.hilos == 0) config.hilos = 1;
+        if (config.codigosError.empty()) config.codigosError.push_back(500);
+    }
+
+    ~ServidorMock() { parar(); }
+
+    // Abre los sockets de escucha y arranca los hilos. false si el puerto
+    // no esta disponible
+    bool iniciar() {
+        for (unsigned i = 0; i < config.hilos; i++) {
+            trabajadores.emplace_back(new TrabajadorEpoll(config, stats, detener, i));
+            if (!trabajadores.back()->iniciar()) {
+                trabajadores.clear();
+                return false;
+            }
+        }
+        for (auto& t : trabajadores) {
+            TrabajadorEpoll* trabajador = t.get();
+            hilos.emplace_back([trabajador] { trabajador->ejecutar(); });
+        }
+        return true;
+    }
+
+    void parar() {
+        detener = true;
+        for (auto& hilo : hilos) hilo.join();
+        hilos.clear();
+        trabajadores.clear();
+    }
+
+    const ConfigServidorMock& configuracion() const { return config; }
+};
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef ARDUINO_NATIVO_H
+#define ARDUINO_NATIVO_H
+
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include "registro_nativo.h"
+
+using namespace std;
+
+// ======================
+// RELOJ VIRTUAL
+// ======================
+// Con el reloj virtual activo, millis() no mira el reloj del sistema: el
+// tiempo solo avanza con delay() o avanzarRelojHasta(), sin dormir. El
+// bucle salta directamente al siguiente evento programado y semanas de
+// simulacion se ejecutan en segundos. Los timestamps UNIX parten de una
+// fecha fija, asi que con la misma semilla la salida es identica.
+struct RelojVirtual {
+    atomic<bool> activo{false};
+    atomic<unsigned long> ahoraMs{0};
+    unsigned long long epocaMs = 1704067200000ULL;   // 2024-01-01 00:00 UTC
+};
+
+inline RelojVirtual relojVirtual;
+
+inline void activarRelojVirtual() {
+    relojVirtual.ahoraMs = 0;
+    relojVirtual.activo = true;
+}
+
+inline bool usandoRelojVirtual() {
+    return relojVirtual.activo.load(memory_order_relaxed);
+}
+
+// El reloj virtual nunca retrocede
+inline void avanzarRelojHasta(unsigned long ms) {
+    unsigned long actual = relojVirtual.ahoraMs.load();
+    while (ms > actual && !relojVirtual.ahoraMs.compare_exchange_weak(actual, ms)) {
+    }
+}
+
+// ======================
+// FUNCIONES UTILITARIAS MEJORADAS
+// ======================
+// Función para obtener timestamp UNIX en MILISEGUNDOS
+inline unsigned long long getUnixTimestampMillis() {
+    if (usandoRelojVirtual()) {
+        return relojVirtual.epocaMs + relojVirtual.ahoraMs.load();
+    }
+    auto now = chrono::system_clock::now();
+    auto duration = now.time_since_epoch();
+    return chrono::duration_cast<chrono::milliseconds>(duration).count();
+}
+
+// Función para redondear a 2 decimales
+inline float roundToTwoDecimals(float value) {
+    return roundf(value * 100.0f) / 100.0f;
+}
+
+// Función para formatear float con precisión (para display)
+inline string formatFloat(float value, int precision = 2) {
+    stringstream ss;
+    ss << fixed << setprecision(precision) << value;
+    return ss.str();
+}
+
+// ======================
+// SIMULACION DE ARDUINO
+// ======================
+inline unsigned long millis() {
+    if (usandoRelojVirtual()) return relojVirtual.ahoraMs.load();
+    static auto start = chrono::steady_clock::now();
+    auto now = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(now - start).count();
+}
+
+inline void delay(unsigned long ms) {
+    if (usandoRelojVirtual()) {
+        avanzarRelojHasta(relojVirtual.ahoraMs.load() + ms);
+        return;
+    }
+    this_thread::sleep_for(chrono::milliseconds(ms));
+}
+
+// Escribe en el registro asincrono: cada hilo arma su linea con print()
+// y println() la encola completa, sin flush por linea
+class SerialClass {
+private:
+    static string& lineaActual() {
+        thread_local string linea;
+        return linea;
+    }
+
+    void agregar(const string& texto) {
+        if (estaSilenciado()) return;
+        lineaActual() += texto;
+    }
+
+    void terminarLinea() {
+        if (estaSilenciado()) return;
+        string& linea = lineaActual();
+        linea += '\n';
+        registroNativo().escribir(linea.data(), linea.size());
+        linea.clear();
+    }
+
+public:
+    // En modo flota miles de estaciones comparten la consola: se silencia
+    // la salida por estacion y solo se imprimen los resumenes agregados
+    void silenciar(bool valor) { registroNativo().silenciar(valor); }
+    bool estaSilenciado() const { return registroNativo().estaSilenciado(); }
+
+    void begin(int baud) { 
+        agregar("Serial iniciado a " + to_string(baud) + " baudios");
+        terminarLinea();
+    }
+    void println(const string& msg) { agregar(msg); terminarLinea(); }
+    void print(const string& msg) { agregar(msg); }
+    void println(float value) { print(value, 2); terminarLinea(); }
+    void print(float value) { print(value, 2); }
+    void println(int value) { agregar(to_string(value)); terminarLinea(); }
+    void print(int value) { agregar(to_string(value)); }
+    // Nuevo método para imprimir float con precisión personalizada
+    void print(float value, int precision) { 
+        if (estaSilenciado()) return;
+        agregar(formatFloat(value, precision));
+    }
+    void println(float value, int precision) { print(value, precision); terminarLinea(); }
+};
+
+inline SerialClass Serial;
+
+#endif
@@ -0,0 +1,756 @@
+#ifndef BARRIDO_UMBRALES_H
+#define BARRIDO_UMBRALES_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "config_nativo.h"
+#include "reproduccion_trazas.h"
+#include "prediccion_lote.h"
+#include "pool_hilos.h"
+
+using namespace std;
+
+// ======================
+// BARRIDO DE UMBRALES (BACKTESTING)
+// ======================
+// simulador_native --barrido TRAZA --eventos LLUVIA [--aleatorio N] [--hilos N]
+//                  [--humedad MIN:MAX:PASO] [--presion MIN:MAX:PASO]
+//                  [--tendencia MIN:MAX:PASO] [--puntos-amarilla MIN:MAX]
+//                  [--puntos-roja MIN:MAX] [--anticipacion MIN] [--nivel amarilla|roja]
+//                  [--mejores N] [--resultado ARCHIVO] [--semilla S]
+// Evalua muchas combinaciones de HUMEDAD_ALERTA_AMARILLA,
+// PRESION_BAJA_ADVERTENCIA, TENDENCIA_HUMEDAD_ALERTA y los cortes
+// PUNTOS_ALERTA_AMARILLA / PUNTOS_ALERTA_ROJA contra lluvias reales.
+// - TRAZA: CSV o binario, como en --reproducir
+// - LLUVIA: CSV estacion,inicio_ms,fin_ms con los episodios de lluvia
+//   observados (cabecera opcional)
+//
+// La traza se recorre una sola vez con la misma logica que --reproducir
+// (validacion, filtro robusto, ventana o Kalman): cada INTERVALO_FILTRADO
+// se guarda por estacion lo que ven las reglas (medias y tendencias). Esas
+// caracteristicas no dependen de los umbrales y se comparten entre todos
+// los candidatos, igual que:
+// - los puntos de los factores que no se barren (tendencia de presion,
+//   temperatura) y la condicion extrema
+// - a que episodio de lluvia corresponde cada fila
+// - los puntos de los candidatos con los mismos tres umbrales: solo
+//   cambian los cortes, que se evaluan una vez por valor distinto
+// Los grupos de umbrales se reparten entre los hilos de PoolHilos.
+//
+// Un episodio de lluvia se acierta si hay alerta (del nivel pedido o
+// superior) entre --anticipacion minutos antes de su inicio y su fin; la
+// anticipacion es cuanto antes del inicio llego la primera. Una falsa
+// alarma es un episodio de alerta (paso de sin alerta a alerta) que empieza
+// fuera de esas ventanas. Se ordena por CSI = aciertos / (episodios de
+// lluvia + falsas alarmas).
+
+// Reglas de REGLAS_RIESGO que se barren, localizadas por su umbral
+constexpr int indiceRegla(VariableRiesgo variable, float umbral, int i = 0) {
+    return i >= NUM_REGLAS_RIESGO ? -1
+         : REGLAS_RIESGO[i].variable == variable && REGLAS_RIESGO[i].umbral == umbral ? i
+         : indiceRegla(variable, umbral, i + 1);
+}
+
+constexpr int REGLA_HUMEDAD_AMARILLA = indiceRegla(R_HUMEDAD, HUMEDAD_ALERTA_AMARILLA);
+constexpr int REGLA_PRESION_ADVERTENCIA = indiceRegla(R_PRESION, PRESION_BAJA_ADVERTENCIA);
+constexpr int REGLA_TENDENCIA_HUMEDAD = indiceRegla(R_TENDENCIA_HUMEDAD, TENDENCIA_HUMEDAD_ALERTA);
+
+static_assert(REGLA_HUMEDAD_AMARILLA >= 0 && REGLA_PRESION_ADVERTENCIA >= 0 && REGLA_TENDENCIA_HUMEDAD >= 0,
+              "barrido_umbrales.h: REGLAS_RIESGO ya no usa alguno de los umbrales barridos");
+
+// Factores (variables) con algun escalon barrido: sus puntos dependen del candidato
+inline bool factorBarrido(VariableRiesgo variable) {
+    return variable == REGLAS_RIESGO[REGLA_HUMEDAD_AMARILLA].variable ||
+           variable == REGLAS_RIESGO[REGLA_PRESION_ADVERTENCIA].variable ||
+           variable == REGLAS_RIESGO[REGLA_TENDENCIA_HUMEDAD].variable;
+}
+
+struct UmbralesCandidato {
+    float humedadAmarilla = HUMEDAD_ALERTA_AMARILLA;
+    float presionAdvertencia = PRESION_BAJA_ADVERTENCIA;
+    float tendenciaHumedad = TENDENCIA_HUMEDAD_ALERTA;
+    int puntosAmarilla = PUNTOS_ALERTA_AMARILLA;
+    int puntosRoja = PUNTOS_ALERTA_ROJA;
+
+    float umbral(int regla) const {
+        if (regla == REGLA_HUMEDAD_AMARILLA) return humedadAmarilla;
+        if (regla == REGLA_PRESION_ADVERTENCIA) return presionAdvertencia;
+        if (regla == REGLA_TENDENCIA_HUMEDAD) return tendenciaHumedad;
+        return REGLAS_RIESGO[regla].umbral;
+    }
+
+    // Los escalones de cada factor siguen ordenados (la suma sin saltos de
+    // puntuacion_riesgo.h lo necesita) y el corte amarillo queda por debajo
+    // del rojo
+    bool valido() const {
+        for (int i = 0; i + 1 < NUM_REGLAS_RIESGO; i++) {
+            if (!mismoFactor(i, i + 1)) continue;
+            bool ordenado = REGLAS_RIESGO[i].comparacion == MAYOR_QUE ? umbral(i) > umbral(i + 1)
+                                                                      : umbral(i) < umbral(i + 1);
+            if (!ordenado) return false;
+        }
+        return puntosAmarilla >= 1 && puntosAmarilla < puntosRoja;
+    }
+
+    bool mismosUmbrales(const UmbralesCandidato& o) const {
+        return humedadAmarilla == o.humedadAmarilla && presionAdvertencia == o.presionAdvertencia &&
+               tendenciaHumedad == o.tendenciaHumedad;
+    }
+
+    bool esConfiguracionActual() const {
+        return mismosUmbrales(UmbralesCandidato()) && puntosAmarilla == PUNTOS_ALERTA_AMARILLA &&
+               puntosRoja == PUNTOS_ALERTA_ROJA;
+    }
+};
+
+struct RangoBarrido {
+    float minimo;
+    float maximo;
+    float paso;
+
+    vector<float> valores() const {
+        vector<float> v;
+        for (int k = 0; paso > 0 && minimo + k * paso <= maximo + paso * 1e-3f; k++) v.push_back(minimo + k * paso);
+        if (v.empty()) v.push_back(minimo);
+        return v;
+    }
+
+    float aleatorio(minstd_rand& generador) const {
+        return minimo + (maximo - minimo) * (generador() - generador.min()) / (float)(generador.max() - generador.min());
+    }
+};
+
+struct ConfigBarrido {
+    string rutaTraza;
+    string rutaEventos;
+    string rutaResultado;
+    unsigned hilos = 0;                    // 0 = uno por nucleo
+    unsigned aleatorios = 0;               // 0 = rejilla completa
+    unsigned semilla = 1;
+    // Por defecto cada rango contiene el valor de config.h
+    RangoBarrido humedad = {70.0f, 82.5f, 2.5f};
+    RangoBarrido presion = {1006.0f, 1014.0f, 2.0f};
+    RangoBarrido tendencia = {0.3f, 0.7f, 0.1f};
+    int puntosAmarillaMin = 3, puntosAmarillaMax = 6;
+    int puntosRojaMin = 6, puntosRojaMax = 10;
+    unsigned long anticipacionMs = 120 * 60000UL;
+    int nivel = 1;                         // 1 = amarilla o roja, 2 = solo roja
+    unsigned mejores = 10;
+};
+
+// "MIN:MAX[:PASO]"; sin PASO se conserva el del rango por defecto.
+// Devuelve false si el texto no es un rango valido
+inline bool leerRango(const char* texto, RangoBarrido& rango) {
+    RangoBarrido leido = rango;
+    char* fin;
+    leido.minimo = strtof(texto, &fin);
+    if (fin == texto || *fin != ':') return false;
+    const char* resto = fin + 1;
+    leido.maximo = strtof(resto, &fin);
+    if (fin == resto) return false;
+    if (*fin == ':') {
+        resto = fin + 1;
+        leido.paso = strtof(resto, &fin);
+        if (fin == resto) return false;
+    }
+    if (*fin != '\0' || leido.maximo < leido.minimo || !(leido.paso > 0)) return false;
+    rango = leido;
+    return true;
+}
+
+// "MIN:MAX" con enteros, MIN <= MAX
+inline bool leerIntervalo(const char* texto, int& minimo, int& maximo) {
+    int a, b, largo = 0;
+    if (sscanf(texto, "%d:%d%n", &a, &b, &largo) != 2 || texto[largo] != '\0' || a > b) return false;
+    minimo = a;
+    maximo = b;
+    return true;
+}
+
+// Solo se llama si la linea de comandos pide --barrido. Devuelve false
+// (tras indicar por stderr la opcion) si alguna no se reconoce, le falta
+// el valor o el valor no es valido
+inline bool leerOpcionesBarrido(int argc, char* argv[], ConfigBarrido& config) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hayValor = i + 1 < argc;
+        bool valido = true;
+        if (arg == "--barrido" && hayValor) {
+            config.rutaTraza = argv[++i];
+        } else if (arg == "--eventos" && hayValor) {
+            config.rutaEventos = argv[++i];
+        } else if (arg == "--resultado" && hayValor) {
+            config.rutaResultado = argv[++i];
+        } else if (arg == "--hilos" && hayValor) {
+            config.hilos = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--aleatorio" && hayValor) {
+            config.aleatorios = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--semilla" && hayValor) {
+            config.semilla = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--humedad" && hayValor) {
+            valido = leerRango(argv[++i], config.humedad);
+        } else if (arg == "--presion" && hayValor) {
+            valido = leerRango(argv[++i], config.presion);
+        } else if (arg == "--tendencia" && hayValor) {
+            valido = leerRango(argv[++i], config.tendencia);
+        } else if (arg == "--puntos-amarilla" && hayValor) {
+            valido = leerIntervalo(argv[++i], config.puntosAmarillaMin, config.puntosAmarillaMax);
+        } else if (arg == "--puntos-roja" && hayValor) {
+            valido = leerIntervalo(argv[++i], config.puntosRojaMin, config.puntosRojaMax);
+        } else if (arg == "--anticipacion" && hayValor) {
+            config.anticipacionMs = strtoul(argv[++i], nullptr, 10) * 60000UL;
+        } else if (arg == "--nivel" && hayValor) {
+            string nivel = argv[++i];
+            valido = nivel == "amarilla" || nivel == "roja";
+            config.nivel = nivel == "roja" ? 2 : 1;
+        } else if (arg == "--mejores" && hayValor) {
+            config.mejores = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "ERROR: opcion de --barrido desconocida o sin valor: %s\n", arg.c_str());
+            return false;
+        }
+        if (!valido) {
+            fprintf(stderr, "ERROR: valor no valido para %s: %s\n", arg.c_str(), argv[i]);
+            return false;
+        }
+    }
+    if (config.rutaTraza.empty()) {
+        fprintf(stderr, "ERROR: --barrido necesita la ruta de la traza\n");
+        return false;
+    }
+    return true;
+}
+
+// ======================
+// CARACTERISTICAS COMPARTIDAS
+// ======================
+// Una fila por prediccion (estacion e instante de filtrado), en columnas
+// como DatosPrediccionSoA. Tras ordenar, las filas de cada estacion quedan
+// juntas y en orden de tiempo
+struct CaracteristicasTraza {
+    vector<uint64_t> timestamp;
+    vector<uint32_t> estacion;
+    vector<float> temperatura;
+    vector<float> humedad;
+    vector<float> presion;
+    vector<float> tendenciaHumedad;
+    vector<float> tendenciaPresion;
+    // Derivadas, iguales para todos los candidatos
+    vector<int8_t> puntosFijos;     // factores que no se barren
+    vector<uint8_t> extrema;        // CONDICION_EXTREMA: roja con cualquier puntaje
+    vector<int32_t> evento;         // episodio de lluvia en cuya ventana cae, -1 si ninguno
+
+    size_t size() const { return timestamp.size(); }
+
+    void agregar(uint64_t t, uint32_t id, const EntradaRiesgo& e) {
+        timestamp.push_back(t);
+        estacion.push_back(id);
+        temperatura.push_back(e.temperatura);
+        humedad.push_back(e.humedad);
+        presion.push_back(e.presion);
+        tendenciaHumedad.push_back(e.tendenciaHumedad);
+        tendenciaPresion.push_back(e.tendenciaPresion);
+    }
+
+    const float* columna(VariableRiesgo variable) const {
+        switch (variable) {
+            case R_TEMPERATURA: return temperatura.data();
+            case R_HUMEDAD: return humedad.data();
+            case R_PRESION: return presion.data();
+            case R_TENDENCIA_HUMEDAD: return tendenciaHumedad.data();
+            default: return tendenciaPresion.data();
+        }
+    }
+
+    // Por estacion y tiempo, estable. Las trazas suelen venir ya agrupadas
+    // por estacion y en orden: entonces no se toca nada
+    void ordenar() {
+        size_t n = size();
+        bool ordenadas = true;
+        for (size_t i = 1; i < n && ordenadas; i++) {
+            ordenadas = estacion[i - 1] < estacion[i] ||
+                        (estacion[i - 1] == estacion[i] && timestamp[i - 1] <= timestamp[i]);
+        }
+        if (ordenadas) return;
+        vector<uint32_t> orden(n);
+        iota(orden.begin(), orden.end(), 0);
+        stable_sort(orden.begin(), orden.end(), [this](uint32_t a, uint32_t b) {
+            return estacion[a] != estacion[b] ? estacion[a] < estacion[b] : timestamp[a] < timestamp[b];
+        });
+        permutar(timestamp, orden);
+        permutar(estacion, orden);
+        permutar(temperatura, orden);
+        permutar(humedad, orden);
+        permutar(presion, orden);
+        permutar(tendenciaHumedad, orden);
+        permutar(tendenciaPresion, orden);
+    }
+
+private:
+    template <class T>
+    static void permutar(vector<T>& columna, const vector<uint32_t>& orden) {
+        vector<T> copia(orden.size());
+        for (size_t i = 0; i < orden.size(); i++) copia[i] = columna[orden[i]];
+        columna.swap(copia);
+    }
+};
+
+// Destino de recorrerTraza(): la misma estacion que --reproducir, pero en
+// lugar de predecir guarda las caracteristicas
+class ExtractorCaracteristicas {
+private:
+    unordered_map<string, uint32_t> indices;
+    deque<EstacionReproducida> estaciones;   // deque: no mueve las existentes
+    string idActual;
+    uint32_t actual = 0;
+    bool hayActual = false;
+
+    uint32_t indice(string_view id) {
+        if (hayActual && id == idActual) return actual;
+        idActual.assign(id.data(), id.size());
+        auto it = indices.find(idActual);
+        if (it == indices.end()) {
+            it = indices.emplace(idActual, (uint32_t)nombres.size()).first;
+            nombres.push_back(idActual);
+            estaciones.emplace_back();
+        }
+        actual = it->second;
+        hayActual = true;
+        return actual;
+    }
+
+public:
+    vector<string> nombres;
+    CaracteristicasTraza filas;
+    unsigned long long lecturas = 0;
+    unsigned long long invalidas = 0;
+    unsigned long long lineasIgnoradas = 0;
+
+    void procesar(const LecturaTraza& l) {
+        lecturas++;
+        uint32_t id = indice(l.estacion);
+        EstacionReproducida& e = estaciones[id];
+        if (EstacionReproducida::valida(l)) e.agregar(l);
+        else invalidas++;
+        if (e.tocaFiltrar(l.timestampMs)) filas.agregar(l.timestampMs, id, e.caracteristicas());
+    }
+
+    void lineaIgnorada() { lineasIgnoradas++; }
+
+    // -1 si la estacion no aparece en la traza
+    int buscar(const string& nombre) const {
+        auto it = indices.find(nombre);
+        return it == indices.end() ? -1 : (int)it->second;
+    }
+};
+
+struct EpisodioLluvia {
+    uint32_t estacion;
+    uint64_t inicioMs;
+    uint64_t finMs;
+};
+
+// Devuelve false si el archivo no se pudo abrir. Los episodios de
+// estaciones que no estan en la traza se cuentan en ignorados
+inline bool leerEpisodios(const string& ruta, const ExtractorCaracteristicas& extractor,
+                          vector<EpisodioLluvia>& episodios, unsigned& ignorados) {
+    ArchivoMapeado archivo;
+    if (!archivo.abrir(ruta)) return false;
+    const char* p = reinterpret_cast<const char*>(archivo.data());
+    const char* fin = p + archivo.size();
+    string nombre;
+    while (p < fin) {
+        const char* finLinea = static_cast<const char*>(memchr(p, '\n', fin - p));
+        if (!finLinea) finLinea = fin;
+        const char* siguiente = finLinea + (finLinea < fin ? 1 : 0);
+        if (finLinea > p && finLinea[-1] == '\r') finLinea--;
+
+        const char* coma = static_cast<const char*>(memchr(p, ',', finLinea - p));
+        if (coma) {
+            const char* finId = coma;
+            while (finId > p && finId[-1] == ' ') finId--;
+            nombre.assign(p, finId - p);
+            const char* c = coma + 1;
+            while (c < finLinea && *c == ' ') c++;
+            uint64_t inicio, finEpisodio;
+            if (leerEntero(c, finLinea, inicio) && saltarComa(c, finLinea) && leerEntero(c, finLinea, finEpisodio)) {
+                int id = extractor.buscar(nombre);
+                if (id < 0) ignorados++;
+                else episodios.push_back({(uint32_t)id, inicio, max(inicio, finEpisodio)});
+            }
+        }
+        p = siguiente;
+    }
+    sort(episodios.begin(), episodios.end(), [](const EpisodioLluvia& a, const EpisodioLluvia& b) {
+        return a.estacion != b.estacion ? a.estacion < b.estacion : a.inicioMs < b.inicioMs;
+    });
+    return true;
+}
+
+// ======================
+// PUNTUACION POR REGLA
+// ======================
+// Como puntuarLote(), pero con el umbral en ejecucion y una regla por
+// pasada: cada columna se recorre seguida y el bucle se vectoriza
+VECTORIZAR_LOTE inline void sumarRegla(size_t n, const float* __restrict x, bool mayor, float umbral,
+                                      int incremento, int8_t* __restrict puntos) {
+    if (mayor) {
+        for (size_t i = 0; i < n; i++) puntos[i] += (int8_t)((x[i] > umbral) * incremento);
+    } else {
+        for (size_t i = 0; i < n; i++) puntos[i] += (int8_t)((x[i] < umbral) * incremento);
+    }
+}
+
+struct MetricasAlerta {
+    unsigned aciertos = 0;          // episodios de lluvia con alerta a tiempo
+    unsigned episodiosAlerta = 0;   // pasos de sin alerta a alerta
+    unsigned falsas = 0;            // de ellos, fuera de toda ventana de lluvia
+    double anticipacionMedia = 0;   // minutos, sobre los aciertos
+    double anticipacionMediana = 0;
+
+    double tasaAcierto(size_t episodios) const { return episodios > 0 ? (double)aciertos / episodios : 0; }
+    double razonFalsas() const { return episodiosAlerta > 0 ? (double)falsas / episodiosAlerta : 0; }
+    double csi(size_t episodios) const {
+        return episodios + falsas > 0 ? (double)aciertos / (episodios + falsas) : 0;
+    }
+};
+
+struct ResultadoCandidato {
+    UmbralesCandidato umbrales;
+    MetricasAlerta amarilla;        // nivel >= amarilla
+    MetricasAlerta roja;
+};
+
+// ======================
+// MOTOR DEL BARRIDO
+// ======================
+class BarridoUmbrales {
+private:
+    ConfigBarrido config;
+    CaracteristicasTraza& filas;
+    const vector<EpisodioLluvia>& episodios;
+    vector<ResultadoCandidato> resultados;
+    bool preparado = false;
+
+    // Lo que no depende del candidato, una vez
+    void prepararCompartido() {
+        if (preparado) return;
+        preparado = true;
+        size_t n = filas.size();
+        filas.puntosFijos.assign(n, 0);
+        for (int r = 0; r < NUM_REGLAS_RIESGO; r++) {
+            if (factorBarrido(REGLAS_RIESGO[r].variable)) continue;
+            sumarRegla(n, filas.columna(REGLAS_RIESGO[r].variable), REGLAS_RIESGO[r].comparacion == MAYOR_QUE,
+                       REGLAS_RIESGO[r].umbral, incrementoRegla(r), filas.puntosFijos.data());
+        }
+
+        filas.extrema.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            EntradaRiesgo e = {0, filas.humedad[i], filas.presion[i], 0, 0};
+            filas.extrema[i] = CondicionRiesgo<EscalaFlotante, CONDICION_EXTREMA, 0>::cumple(e) &&
+                               CondicionRiesgo<EscalaFlotante, CONDICION_EXTREMA, 1>::cumple(e);
+        }
+
+        // Filas y episodios van por estacion y tiempo: un solo recorrido
+        filas.evento.assign(n, -1);
+        size_t j = 0;
+        for (size_t i = 0; i < n; i++) {
+            uint32_t estacion = filas.estacion[i];
+            uint64_t t = filas.timestamp[i];
+            while (j < episodios.size() &&
+                   (episodios[j].estacion < estacion || (episodios[j].estacion == estacion && episodios[j].finMs < t))) {
+                j++;
+            }
+            if (j < episodios.size() && episodios[j].estacion == estacion &&
+                t + config.anticipacionMs >= episodios[j].inicioMs) {
+                filas.evento[i] = (int32_t)j;
+            }
+        }
+    }
+
+    void puntuarGrupo(const UmbralesCandidato& u, vector<int8_t>& puntos) const {
+        size_t n = filas.size();
+        puntos.assign(filas.puntosFijos.begin(), filas.puntosFijos.end());
+        for (int r = 0; r < NUM_REGLAS_RIESGO; r++) {
+            if (!factorBarrido(REGLAS_RIESGO[r].variable)) continue;
+            sumarRegla(n, filas.columna(REGLAS_RIESGO[r].variable), REGLAS_RIESGO[r].comparacion == MAYOR_QUE,
+                       u.umbral(r), incrementoRegla(r), puntos.data());
+        }
+    }
+
+    // Alerta = puntos >= corte o condicion extrema, igual que nivelAlerta()
+    // para los dos niveles
+    MetricasAlerta evaluarCorte(const vector<int8_t>& puntos, int corte, vector<uint64_t>& primera,
+                                vector<double>& anticipaciones) const {
+        MetricasAlerta m;
+        primera.assign(episodios.size(), UINT64_MAX);
+        bool anterior = false;
+        for (size_t i = 0; i < filas.size(); i++) {
+            if (i > 0 && filas.estacion[i] != filas.estacion[i - 1]) anterior = false;
+            bool alerta = puntos[i] >= corte || filas.extrema[i];
+            if (alerta) {
+                int32_t ev = filas.evento[i];
+                if (ev >= 0 && primera[ev] == UINT64_MAX) primera[ev] = filas.timestamp[i];
+                if (!anterior) {
+                    m.episodiosAlerta++;
+                    if (ev < 0) m.falsas++;
+                }
+            }
+            anterior = alerta;
+        }
+
+        anticipaciones.clear();
+        for (size_t e = 0; e < episodios.size(); e++) {
+            if (primera[e] == UINT64_MAX) continue;
+            m.aciertos++;
+            uint64_t inicio = episodios[e].inicioMs;
+            anticipaciones.push_back(inicio > primera[e] ? (inicio - primera[e]) / 60000.0 : 0.0);
+        }
+        if (!anticipaciones.empty()) {
+            m.anticipacionMedia = accumulate(anticipaciones.begin(), anticipaciones.end(), 0.0) / anticipaciones.size();
+            auto medio = anticipaciones.begin() + anticipaciones.size() / 2;
+            nth_element(anticipaciones.begin(), medio, anticipaciones.end());
+            m.anticipacionMediana = *medio;
+        }
+        return m;
+    }
+
+    // Candidatos [desde, hasta) con los mismos tres umbrales: una sola
+    // puntuacion y una evaluacion por corte distinto
+    void evaluarGrupo(size_t desde, size_t hasta) {
+        static thread_local vector<int8_t> puntos;
+        static thread_local vector<uint64_t> primera;
+        static thread_local vector<double> anticipaciones;
+        puntuarGrupo(resultados[desde].umbrales, puntos);
+        map<int, MetricasAlerta> porCorte;
+        auto metricas = [&](int corte) -> const MetricasAlerta& {
+            auto it = porCorte.find(corte);
+            if (it == porCorte.end()) {
+                it = porCorte.emplace(corte, evaluarCorte(puntos, corte, primera, anticipaciones)).first;
+            }
+            return it->second;
+        };
+        for (size_t c = desde; c < hasta; c++) {
+            resultados[c].amarilla = metricas(resultados[c].umbrales.puntosAmarilla);
+            resultados[c].roja = metricas(resultados[c].umbrales.puntosRoja);
+        }
+    }
+
+    void generarCandidatos() {
+        vector<UmbralesCandidato> candidatos;
+        candidatos.push_back(UmbralesCandidato());   // config.h, siempre como referencia
+        if (config.aleatorios > 0) {
+            minstd_rand generador(config.semilla);
+            // Con rangos que casi no dejan combinaciones validas no se insiste sin fin
+            for (unsigned intentos = 0; candidatos.size() <= config.aleatorios && intentos < config.aleatorios * 100;
+                 intentos++) {
+                UmbralesCandidato u;
+                u.humedadAmarilla = config.humedad.aleatorio(generador);
+                u.presionAdvertencia = config.presion.aleatorio(generador);
+                u.tendenciaHumedad = config.tendencia.aleatorio(generador);
+                u.puntosAmarilla = config.puntosAmarillaMin +
+                                   generador() % (max(config.puntosAmarillaMax - config.puntosAmarillaMin, 0) + 1);
+                u.puntosRoja = config.puntosRojaMin +
+                               generador() % (max(config.puntosRojaMax - config.puntosRojaMin, 0) + 1);
+                if (u.valido()) candidatos.push_back(u);
+            }
+        } else {
+            for (float h : config.humedad.valores())
+                for (float p : config.presion.valores())
+                    for (float t : config.tendencia.valores())
+                        for (int a = config.puntosAmarillaMin; a <= config.puntosAmarillaMax; a++)
+                            for (int r = config.puntosRojaMin; r <= config.puntosRojaMax; r++) {
+                                UmbralesCandidato u = {h, p, t, a, r};
+                                if (u.valido() && !u.esConfiguracionActual()) candidatos.push_back(u);
+                            }
+        }
+        // Juntos los que comparten umbrales
+        stable_sort(candidatos.begin(), candidatos.end(), [](const UmbralesCandidato& a, const UmbralesCandidato& b) {
+            if (a.humedadAmarilla != b.humedadAmarilla) return a.humedadAmarilla < b.humedadAmarilla;
+            if (a.presionAdvertencia != b.presionAdvertencia) return a.presionAdvertencia < b.presionAdvertencia;
+            return a.tendenciaHumedad < b.tendenciaHumedad;
+        });
+        resultados.clear();
+        for (const UmbralesCandidato& u : candidatos) resultados.push_back({u, MetricasAlerta(), MetricasAlerta()});
+    }
+
+public:
+    BarridoUmbrales(const ConfigBarrido& cfg, CaracteristicasTraza& caracteristicas,
+                    const vector<EpisodioLluvia>& lluvias)
+        : config(cfg), filas(caracteristicas), episodios(lluvias) {}
+
+    // Los puntos de config.h por el camino del barrido deben coincidir con
+    // puntosRiesgo(); devuelve las filas que difieren
+    size_t verificar() {
+        prepararCompartido();
+        vector<int8_t> puntos;
+        puntuarGrupo(UmbralesCandidato(), puntos);
+        size_t distintas = 0;
+        for (size_t i = 0; i < filas.size(); i++) {
+            int esperado = puntosRiesgo(filas.temperatura[i], filas.humedad[i], filas.presion[i],
+                                        filas.tendenciaHumedad[i], filas.tendenciaPresion[i]);
+            if (puntos[i] != esperado) distintas++;
+        }
+        return distintas;
+    }
+
+    // Devuelve el numero de grupos de umbrales evaluados
+    size_t ejecutar(unsigned hilos) {
+        prepararCompartido();   // puntosFijos, aunque no se haya llamado a verificar()
+        generarCandidatos();
+        vector<pair<size_t, size_t>> grupos;
+        for (size_t i = 0; i < resultados.size();) {
+            size_t j = i + 1;
+            while (j < resultados.size() && resultados[j].umbrales.mismosUmbrales(resultados[i].umbrales)) j++;
+            grupos.push_back({i, j});
+            i = j;
+        }
+        PoolHilos pool(hilos);
+        for (const auto& g : grupos) {
+            pool.submit([this, g] { evaluarGrupo(g.first, g.second); });
+        }
+        pool.esperar();
+
+        // Mejor CSI en el nivel pedido; a igualdad, menos falsas alarmas y
+        // mejor CSI en el otro nivel
+        size_t total = episodios.size();
+        int nivel = config.nivel;
+        stable_sort(resultados.begin(), resultados.end(),
+                    [total, nivel](const ResultadoCandidato& a, const ResultadoCandidato& b) {
+            const MetricasAlerta& ma = nivel == 2 ? a.roja : a.amarilla;
+            const MetricasAlerta& mb = nivel == 2 ? b.roja : b.amarilla;
+            if (ma.csi(total) != mb.csi(total)) return ma.csi(total) > mb.csi(total);
+            if (ma.falsas != mb.falsas) return ma.falsas < mb.falsas;
+            const MetricasAlerta& oa = nivel == 2 ? a.amarilla : a.roja;
+            const MetricasAlerta& ob = nivel == 2 ? b.amarilla : b.roja;
+            return oa.csi(total) > ob.csi(total);
+        });
+        return grupos.size();
+    }
+
+    const vector<ResultadoCandidato>& candidatos() const { return resultados; }
+
+    void imprimirFila(FILE* salida, size_t puesto, const ResultadoCandidato& r) const {
+        size_t total = episodios.size();
+        const UmbralesCandidato& u = r.umbrales;
+        fprintf(salida, "%5zu %6.1f %7.1f %6.2f %3d %3d | %5.1f%% %5u %5.1f%% %6.1f %6.1f %.3f | %5.1f%% %5u %6.1f %.3f%s\n",
+                puesto, u.humedadAmarilla, u.presionAdvertencia, u.tendenciaHumedad, u.puntosAmarilla, u.puntosRoja,
+                100 * r.amarilla.tasaAcierto(total), r.amarilla.falsas, 100 * r.amarilla.razonFalsas(),
+                r.amarilla.anticipacionMedia, r.amarilla.anticipacionMediana, r.amarilla.csi(total),
+                100 * r.roja.tasaAcierto(total), r.roja.falsas, r.roja.anticipacionMedia, r.roja.csi(total),
+                u.esConfiguracionActual() ? "  <- config.h" : "");
+    }
+
+    void imprimirMejores(FILE* salida) const {
+        fprintf(salida, "Mejores por CSI de alerta %s (anticipacion en minutos):\n",
+                config.nivel == 2 ? "roja" : "amarilla o roja");
+        fprintf(salida, "%5s %6s %7s %6s %3s %3s | %6s %5s %6s %6s %6s %5s | %6s %5s %6s %5s\n", "#", "HUM_A", "PRES_A",
+                "TEND_H", "P_A", "P_R", "ACIER", "FALS", "%FALS", "ANT", "ANT_MD", "CSI", "R_ACI", "R_FAL", "R_ANT",
+                "R_CSI");
+        bool actualMostrada = false;
+        for (size_t i = 0; i < resultados.size() && i < config.mejores; i++) {
+            imprimirFila(salida, i + 1, resultados[i]);
+            actualMostrada |= resultados[i].umbrales.esConfiguracionActual();
+        }
+        for (size_t i = 0; i < resultados.size() && !actualMostrada; i++) {
+            if (!resultados[i].umbrales.esConfiguracionActual()) continue;
+            fprintf(salida, "  ...\n");
+            imprimirFila(salida, i + 1, resultados[i]);
+            actualMostrada = true;
+        }
+    }
+
+    bool guardarCsv(const string& ruta) const {
+        FILE* f = fopen(ruta.c_str(), "w");
+        if (!f) return false;
+        size_t total = episodios.size();
+        fprintf(f, "puesto,humedad_amarilla,presion_advertencia,tendencia_humedad,puntos_amarilla,puntos_roja,"
+                   "acierto,falsas,episodios_alerta,anticipacion_media_min,anticipacion_mediana_min,csi,"
+                   "roja_acierto,roja_falsas,roja_episodios_alerta,roja_anticipacion_media_min,"
+                   "roja_anticipacion_mediana_min,roja_csi\n");
+        for (size_t i = 0; i < resultados.size(); i++) {
+            const ResultadoCandidato& r = resultados[i];
+            const UmbralesCandidato& u = r.umbrales;
+            fprintf(f, "%zu,%.2f,%.2f,%.3f,%d,%d,%.4f,%u,%u,%.1f,%.1f,%.4f,%.4f,%u,%u,%.1f,%.1f,%.4f\n", i + 1,
+                    u.humedadAmarilla, u.presionAdvertencia, u.tendenciaHumedad, u.puntosAmarilla, u.puntosRoja,
+                    r.amarilla.tasaAcierto(total), r.amarilla.falsas, r.amarilla.episodiosAlerta,
+                    r.amarilla.anticipacionMedia, r.amarilla.anticipacionMediana, r.amarilla.csi(total),
+                    r.roja.tasaAcierto(total), r.roja.falsas, r.roja.episodiosAlerta, r.roja.anticipacionMedia,
+                    r.roja.anticipacionMediana, r.roja.csi(total));
+        }
+        fclose(f);
+        return true;
+    }
+};
+
+// Devuelve false si la traza o los episodios no se pudieron leer
+inline bool barrerUmbrales(const ConfigBarrido& config) {
+    if (config.rutaEventos.empty()) {
+        fprintf(stderr, "ERROR: --barrido necesita --eventos con los episodios de lluvia\n");
+        return false;
+    }
+    ArchivoMapeado traza;
+    if (!traza.abrir(config.rutaTraza)) {
+        fprintf(stderr, "ERROR: no se pudo abrir la traza %s\n", config.rutaTraza.c_str());
+        return false;
+    }
+    auto t0 = chrono::steady_clock::now();
+    ExtractorCaracteristicas extractor;
+    bool completa = recorrerTraza(traza, extractor);
+    extractor.filas.ordenar();
+    double segundosExtraccion = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    vector<EpisodioLluvia> episodios;
+    unsigned ignorados = 0;
+    if (!leerEpisodios(config.rutaEventos, extractor, episodios, ignorados)) {
+        fprintf(stderr, "ERROR: no se pudo abrir los episodios de lluvia %s\n", config.rutaEventos.c_str());
+        return false;
+    }
+
+    unsigned hilos = config.hilos > 0 ? config.hilos : max(1u, thread::hardware_concurrency());
+    BarridoUmbrales barrido(config, extractor.filas, episodios);
+    size_t distintas = barrido.verificar();
+    auto t1 = chrono::steady_clock::now();
+    size_t grupos = barrido.ejecutar(hilos);
+    double segundosBarrido = chrono::duration<double>(chrono::steady_clock::now() - t1).count();
+    size_t candidatos = barrido.candidatos().size();
+
+    printf("====================================\n");
+    printf("BARRIDO DE UMBRALES %s (%s, %.1f MB), lluvia %s\n", config.rutaTraza.c_str(),
+           esTrazaBinaria(traza) ? "binario" : "CSV", traza.size() / 1e6, config.rutaEventos.c_str());
+    printf("====================================\n");
+    printf("Estaciones: %zu  Lecturas: %llu  Invalidas: %llu  Lineas ignoradas: %llu  Predicciones: %zu\n",
+           extractor.nombres.size(), extractor.lecturas, extractor.invalidas, extractor.lineasIgnoradas,
+           extractor.filas.size());
+    printf("Episodios de lluvia: %zu (%u de estaciones sin lecturas, ignorados)  Anticipacion maxima: %lu min\n",
+           episodios.size(), ignorados, config.anticipacionMs / 60000);
+    printf("Candidatos: %zu (%s, %zu combinaciones de umbrales)  Hilos: %u\n", candidatos,
+           config.aleatorios > 0 ? "aleatorios" : "rejilla", grupos, hilos);
+    printf("Extraccion: %.3f s  Barrido: %.3f s (%.0f candidatos/s, %.0f M filas-candidato/s)\n", segundosExtraccion,
+           segundosBarrido, segundosBarrido > 0 ? candidatos / segundosBarrido : 0.0,
+           segundosBarrido > 0 ? (double)candidatos * extractor.filas.size() / segundosBarrido / 1e6 : 0.0);
+    barrido.imprimirMejores(stdout);
+    if (distintas > 0) {
+        fprintf(stderr, "AVISO: %zu filas puntuan distinto que puntosRiesgo() con los umbrales de config.h\n",
+                distintas);
+    }
+    if (!completa) fprintf(stderr, "AVISO: traza binaria truncada o corrupta\n");
+    if (!config.rutaResultado.empty() && !barrido.guardarCsv(config.rutaResultado)) {
+        fprintf(stderr, "ERROR: no se pudo crear %s\n", config.rutaResultado.c_str());
+        return false;
+    }
+    return completa;
+}
+
+#endif
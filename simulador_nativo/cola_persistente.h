@@ -0,0 +1,343 @@
+#ifndef COLA_PERSISTENTE_H
+#define COLA_PERSISTENTE_H
+
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "arduino_nativo.h"
+#include "http_backend_nativo.h"
+
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+using namespace std;
+
+// ======================
+// COLA PERSISTENTE (STORE-AND-FORWARD)
+// ======================
+// Buffer circular de registros de tamano fijo sobre un archivo mapeado en
+// memoria. Las lecturas que no se pudieron enviar se agregan al final y se
+// reenvian en bloque, en orden, cuando el backend vuelve. El archivo tiene
+// un tamano fijo: si la cola se llena se sobrescribe la lectura mas
+// antigua y se cuenta como descartada.
+struct CabeceraCola {
+    uint32_t magia;
+    uint32_t version;
+    uint32_t capacidad;
+    uint32_t tamRegistro;
+    uint64_t inicio;          // posicion del registro mas antiguo
+    uint64_t cantidad;
+    uint64_t siguienteSeq;
+    uint64_t descartados;
+};
+
+struct RegistroCola {
+    uint64_t seq;
+    uint64_t timestamp;
+    float temperatura;
+    float humedad;
+    float presion;
+    int32_t alerta;
+    char sensorId[32];
+};
+
+class ColaPersistente {
+private:
+    static const uint32_t MAGIA = 0x52534351;  // "RSCQ"
+    static const uint32_t VERSION = 1;
+
+    mutable mutex m;
+    uint8_t* mapa = nullptr;
+    size_t tamMapa = 0;
+    CabeceraCola* cabecera = nullptr;
+    RegistroCola* registros = nullptr;
+
+#ifdef _WIN32
+    HANDLE archivo = INVALID_HANDLE_VALUE;
+    HANDLE mapeo = NULL;
+#else
+    int fd = -1;
+#endif
+
+public:
+    ~ColaPersistente() { cerrar(); }
+
+    bool abrir(const string& ruta, uint32_t capacidad) {
+        lock_guard<mutex> lock(m);
+        tamMapa = sizeof(CabeceraCola) + (size_t)capacidad * sizeof(RegistroCola);
+        if (!mapear(ruta)) {
+            LOG_ERROR("No se pudo mapear la cola persistente %s", ruta.c_str());
+            return false;
+        }
+
+        cabecera = reinterpret_cast<CabeceraCola*>(mapa);
+        registros = reinterpret_cast<RegistroCola*>(mapa + sizeof(CabeceraCola));
+
+        // Archivo nuevo, de otra version o de otra capacidad: se reinicia
+        if (cabecera->magia != MAGIA || cabecera->version != VERSION ||
+            cabecera->capacidad != capacidad || cabecera->tamRegistro != sizeof(RegistroCola) ||
+            cabecera->cantidad > capacidad || cabecera->inicio >= capacidad) {
+            memset(cabecera, 0, sizeof(CabeceraCola));
+            cabecera->magia = MAGIA;
+            cabecera->version = VERSION;
+            cabecera->capacidad = capacidad;
+            cabecera->tamRegistro = sizeof(RegistroCola);
+            cabecera->siguienteSeq = 1;
+        }
+        return true;
+    }
+
+    bool abierta() const { return mapa != nullptr; }
+
+    size_t size() const {
+        lock_guard<mutex> lock(m);
+        return cabecera ? cabecera->cantidad : 0;
+    }
+
+    bool vacia() const { return size() == 0; }
+
+    uint64_t descartados() const {
+        lock_guard<mutex> lock(m);
+        return cabecera ? cabecera->descartados : 0;
+    }
+
+    void agregar(const LecturaLote& lectura) {
+        lock_guard<mutex> lock(m);
+        if (!cabecera) return;
+
+        uint64_t capacidad = cabecera->capacidad;
+        if (cabecera->cantidad == capacidad) {
+            cabecera->inicio = (cabecera->inicio + 1) % capacidad;
+            cabecera->cantidad--;
+            cabecera->descartados++;
+        }
+
+        RegistroCola& r = registros[(cabecera->inicio + cabecera->cantidad) % capacidad];
+        r.seq = cabecera->siguienteSeq++;
+        r.timestamp = lectura.timestamp;
+        r.temperatura = lectura.temperatura;
+        r.humedad = lectura.humedad;
+        r.presion = lectura.presion;
+        r.alerta = lectura.alerta;
+        memset(r.sensorId, 0, sizeof(r.sensorId));
+        strncpy(r.sensorId, lectura.sensorId.c_str(), sizeof(r.sensorId) - 1);
+        cabecera->cantidad++;
+    }
+
+    // Copia hasta max lecturas desde la mas antigua, sin retirarlas.
+    // ultimaSeq identifica el bloque para confirmarlo despues
+    size_t leer(size_t max, vector<LecturaLote>& destino, uint64_t& ultimaSeq) const {
+        lock_guard<mutex> lock(m);
+        destino.clear();
+        if (!cabecera) return 0;
+
+        size_t n = min<size_t>(max, cabecera->cantidad);
+        destino.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            const RegistroCola& r = registros[(cabecera->inicio + i) % cabecera->capacidad];
+            destino.push_back({string(r.sensorId), r.timestamp, r.temperatura, r.humedad, r.presion, r.alerta});
+            ultimaSeq = r.seq;
+        }
+        return n;
+    }
+
+    // Retira las lecturas con seq <= ultimaSeq. Se compara por secuencia y
+    // no por cantidad porque, si la cola se lleno mientras el bloque estaba
+    // en vuelo, parte de el ya pudo haber sido sobrescrita
+    void confirmarHasta(uint64_t ultimaSeq) {
+        lock_guard<mutex> lock(m);
+        if (!cabecera) return;
+        while (cabecera->cantidad > 0 && registros[cabecera->inicio].seq <= ultimaSeq) {
+            cabecera->inicio = (cabecera->inicio + 1) % cabecera->capacidad;
+            cabecera->cantidad--;
+        }
+        sincronizar();
+    }
+
+    void sincronizar() {
+        if (!mapa) return;
+#ifdef _WIN32
+        FlushViewOfFile(mapa, tamMapa);
+#else
+        msync(mapa, tamMapa, MS_ASYNC);
+#endif
+    }
+
+    void cerrar() {
+        lock_guard<mutex> lock(m);
+        if (!mapa) return;
+        sincronizar();
+#ifdef _WIN32
+        UnmapViewOfFile(mapa);
+        CloseHandle(mapeo);
+        CloseHandle(archivo);
+        mapeo = NULL;
+        archivo = INVALID_HANDLE_VALUE;
+#else
+        munmap(mapa, tamMapa);
+        close(fd);
+        fd = -1;
+#endif
+        mapa = nullptr;
+        cabecera = nullptr;
+        registros = nullptr;
+    }
+
+private:
+    bool mapear(const string& ruta) {
+#ifdef _WIN32
+        archivo = CreateFileA(ruta.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL,
+                              OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (archivo == INVALID_HANDLE_VALUE) return false;
+        mapeo = CreateFileMappingA(archivo, NULL, PAGE_READWRITE, (DWORD)((uint64_t)tamMapa >> 32),
+                                   (DWORD)(tamMapa & 0xFFFFFFFF), NULL);
+        if (!mapeo) {
+            CloseHandle(archivo);
+            return false;
+        }
+        mapa = static_cast<uint8_t*>(MapViewOfFile(mapeo, FILE_MAP_ALL_ACCESS, 0, 0, tamMapa));
+        return mapa != nullptr;
+#else
+        fd = open(ruta.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) return false;
+        if (ftruncate(fd, tamMapa) != 0) {
+            close(fd);
+            return false;
+        }
+        void* p = mmap(nullptr, tamMapa, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        mapa = static_cast<uint8_t*>(p);
+        return true;
+#endif
+    }
+};
+
+// ======================
+// REENVIO DE PENDIENTES
+// ======================
+// Guarda en la cola las lecturas fallidas y la vacia en bloques cuando el
+// backend responde: de inmediato tras un envio correcto, o cada
+// intervaloReintentoMs mientras siga caido o mientras el ultimo bloque no
+// haya llegado. Solo hay un bloque en vuelo.
+class ReenvioPendientes {
+private:
+    ColaPersistente& cola;
+    size_t maxPorBloque;
+    unsigned long intervaloReintentoMs;
+
+    mutex m;
+    unsigned long ultimoIntento = 0;
+    bool backendDisponible = false;
+    bool bloqueFallido = false;     // el ultimo bloque no llego: esperar el intervalo
+    bool enVuelo = false;
+    unsigned long long reenviadas = 0;
+    unsigned long long rechazadas = 0;
+
+public:
+    ReenvioPendientes(ColaPersistente& colaPersistente, size_t bloque = 100, unsigned long reintentoMs = 30000)
+        : cola(colaPersistente), maxPorBloque(bloque), intervaloReintentoMs(reintentoMs) {}
+
+    unsigned long long totalReenviadas() const { return reenviadas; }
+    unsigned long long totalRechazadas() const { return rechazadas; }
+
+    // Resultado de un envio normal: si fallo, la lectura se guarda; si fue
+    // bien, el backend esta disponible y conviene vaciar la cola ya
+    void registrarResultado(const LecturaLote& lectura, bool exito) {
+        if (!exito) {
+            cola.agregar(lectura);
+        }
+        lock_guard<mutex> lock(m);
+        backendDisponible = exito;
+    }
+
+    // Instante (en millis()) en que revisar() intentara el siguiente
+    // bloque, si hay algo que reenviar. Lo usa el bucle para saber hasta
+    // cuando puede dormir
+    bool vencimiento(unsigned long& limite) {
+        lock_guard<mutex> lock(m);
+        if (enVuelo || cola.vacia()) return false;
+        limite = esperaReintento() ? ultimoIntento + intervaloReintentoMs : millis();
+        return true;
+    }
+
+    // Llamar periodicamente desde el hilo que usa el backend
+    void revisar(HttpClientBackend& backend) {
+        {
+            lock_guard<mutex> lock(m);
+            if (enVuelo || cola.vacia()) return;
+            unsigned long ahora = millis();
+            if (esperaReintento() && ahora - ultimoIntento < intervaloReintentoMs) return;
+            ultimoIntento = ahora;
+            enVuelo = true;
+        }
+
+        vector<LecturaLote> bloque;
+        uint64_t ultimaSeq = 0;
+        size_t n = cola.leer(maxPorBloque, bloque, ultimaSeq);
+        if (n == 0) {
+            lock_guard<mutex> lock(m);
+            enVuelo = false;
+            return;
+        }
+
+        string cuerpo = backend.componerLote(bloque);
+
+        LOG_INFO("REENVIANDO %zu lecturas pendientes de la cola persistente", (size_t)n);
+
+        if (backend.esAsync()) {
+            backend.sendBatchAsync(cuerpo, n,
+                [this, ultimaSeq](bool entregado, const vector<bool>& resultados) {
+                    terminarBloque(ultimaSeq, entregado, resultados);
+                });
+        } else {
+            vector<bool> resultados;
+            bool entregado = backend.sendBatch(cuerpo, n, resultados);
+            terminarBloque(ultimaSeq, entregado, resultados);
+        }
+    }
+
+private:
+    // Con m tomado. Un envio normal correcto no basta para reintentar de
+    // inmediato si el ultimo bloque fallo: el backend puede aceptar
+    // lecturas sueltas y seguir devolviendo error a los bloques
+    bool esperaReintento() const { return !backendDisponible || bloqueFallido; }
+
+    // Si el POST no llego el bloque se queda para el proximo intento, tras
+    // intervaloReintentoMs. Si llego, se retira entero aunque el backend
+    // haya rechazado todas sus lecturas: esas se cuentan como rechazadas y
+    // no se reintentan para no bloquear la cola
+    void terminarBloque(uint64_t ultimaSeq, bool entregado, const vector<bool>& resultados) {
+        size_t aceptadas = 0;
+        for (bool r : resultados) if (r) aceptadas++;
+
+        if (entregado) {
+            cola.confirmarHasta(ultimaSeq);
+            if (aceptadas < resultados.size()) {
+                LOG_AVISO("El backend rechazo %zu de %zu lecturas reenviadas", resultados.size() - aceptadas,
+                          resultados.size());
+            }
+        }
+
+        lock_guard<mutex> lock(m);
+        enVuelo = false;
+        backendDisponible = entregado;
+        bloqueFallido = !entregado;
+        if (entregado) {
+            reenviadas += aceptadas;
+            rechazadas += resultados.size() - aceptadas;
+        }
+    }
+};
+
+#endif
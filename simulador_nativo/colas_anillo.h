@@ -0,0 +1,162 @@
+#ifndef COLAS_ANILLO_H
+#define COLAS_ANILLO_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+using namespace std;
+
+// ======================
+// COLAS EN ANILLO SIN BLOQUEOS
+// ======================
+// Colas acotadas entre los hilos del pipeline (flota_pipeline.h). La
+// capacidad se redondea a potencia de 2 para indexar con una mascara; los
+// indices crecen sin volver a 0 (64 bits no desbordan en la practica).
+// Encolar en una cola llena devuelve false en lugar de crecer o bloquear:
+// quien produce decide como esperar, y esa espera es la contrapresion que
+// frena a una etapa mas rapida que la siguiente.
+// Los indices de cada lado van en su propia linea de cache para que
+// productor y consumidor no se invaliden mutuamente en cada operacion.
+const size_t LINEA_CACHE = 64;
+
+inline size_t potenciaDeDos(size_t minimo) {
+    size_t n = 2;
+    while (n < minimo) n <<= 1;
+    return n;
+}
+
+// Un productor y un consumidor. Cada lado guarda una copia del indice del
+// otro y solo la relee (con adquisicion) cuando parece que no queda hueco
+// o no quedan elementos: en regimen, un encolado toca una sola linea
+// compartida
+template <typename T>
+class ColaSPSC {
+private:
+    const size_t capacidadTotal;
+    const size_t mascara;
+    unique_ptr<T[]> celdas;
+
+    alignas(LINEA_CACHE) atomic<size_t> posEscritura{0};
+    size_t lecturaVista = 0;       // del productor
+    alignas(LINEA_CACHE) atomic<size_t> posLectura{0};
+    size_t escrituraVista = 0;     // del consumidor
+
+public:
+    explicit ColaSPSC(size_t capacidadMinima)
+        : capacidadTotal(potenciaDeDos(capacidadMinima)), mascara(capacidadTotal - 1),
+          celdas(new T[capacidadTotal]) {}
+
+    ColaSPSC(const ColaSPSC&) = delete;
+    ColaSPSC& operator=(const ColaSPSC&) = delete;
+
+    // Solo desde el hilo productor
+    bool intentarEncolar(const T& valor) {
+        size_t pos = posEscritura.load(memory_order_relaxed);
+        if (pos - lecturaVista == capacidadTotal) {
+            lecturaVista = posLectura.load(memory_order_acquire);
+            if (pos - lecturaVista == capacidadTotal) return false;
+        }
+        celdas[pos & mascara] = valor;
+        posEscritura.store(pos + 1, memory_order_release);
+        return true;
+    }
+
+    // Solo desde el hilo consumidor
+    bool intentarDesencolar(T& valor) {
+        size_t pos = posLectura.load(memory_order_relaxed);
+        if (pos == escrituraVista) {
+            escrituraVista = posEscritura.load(memory_order_acquire);
+            if (pos == escrituraVista) return false;
+        }
+        valor = celdas[pos & mascara];
+        posLectura.store(pos + 1, memory_order_release);
+        return true;
+    }
+
+    // Aproximado si los dos lados estan activos; desde cualquier hilo
+    size_t size() const {
+        size_t lectura = posLectura.load(memory_order_acquire);
+        return posEscritura.load(memory_order_acquire) - lectura;
+    }
+
+    size_t capacidad() const { return capacidadTotal; }
+};
+
+// Varios productores y un consumidor (esquema de Vyukov). Cada celda lleva
+// un numero de secuencia: vale pos cuando esta libre para el encolado pos
+// y pos + 1 cuando ya tiene el dato. Los productores se reparten las
+// posiciones con un compare-exchange sobre posEscritura y publican con la
+// secuencia, asi que un productor lento no deja al consumidor leer una
+// celda a medio escribir. Con un solo consumidor leer no necesita CAS
+template <typename T>
+class ColaMPSC {
+private:
+    struct Celda {
+        atomic<size_t> secuencia;
+        T valor;
+    };
+
+    const size_t capacidadTotal;
+    const size_t mascara;
+    unique_ptr<Celda[]> celdas;
+
+    alignas(LINEA_CACHE) atomic<size_t> posEscritura{0};
+    alignas(LINEA_CACHE) atomic<size_t> posLectura{0};   // atomica solo para size()
+
+public:
+    explicit ColaMPSC(size_t capacidadMinima)
+        : capacidadTotal(potenciaDeDos(capacidadMinima)), mascara(capacidadTotal - 1),
+          celdas(new Celda[capacidadTotal]) {
+        for (size_t i = 0; i < capacidadTotal; i++) {
+            celdas[i].secuencia.store(i, memory_order_relaxed);
+        }
+    }
+
+    ColaMPSC(const ColaMPSC&) = delete;
+    ColaMPSC& operator=(const ColaMPSC&) = delete;
+
+    // Desde cualquier hilo
+    bool intentarEncolar(const T& valor) {
+        size_t pos = posEscritura.load(memory_order_relaxed);
+        Celda* celda;
+        while (true) {
+            celda = &celdas[pos & mascara];
+            size_t secuencia = celda->secuencia.load(memory_order_acquire);
+            intptr_t diferencia = (intptr_t)secuencia - (intptr_t)pos;
+            if (diferencia == 0) {
+                if (posEscritura.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) break;
+            } else if (diferencia < 0) {
+                return false;   // la celda aun tiene el dato de la vuelta anterior
+            } else {
+                pos = posEscritura.load(memory_order_relaxed);
+            }
+        }
+        celda->valor = valor;
+        celda->secuencia.store(pos + 1, memory_order_release);
+        return true;
+    }
+
+    // Solo desde el hilo consumidor
+    bool intentarDesencolar(T& valor) {
+        size_t pos = posLectura.load(memory_order_relaxed);
+        Celda& celda = celdas[pos & mascara];
+        if (celda.secuencia.load(memory_order_acquire) != pos + 1) return false;
+        valor = celda.valor;
+        celda.secuencia.store(pos + capacidadTotal, memory_order_release);
+        posLectura.store(pos + 1, memory_order_relaxed);
+        return true;
+    }
+
+    // Incluye encolados reservados que aun no se publicaron
+    size_t size() const {
+        size_t lectura = posLectura.load(memory_order_relaxed);
+        size_t escritura = posEscritura.load(memory_order_relaxed);
+        return escritura > lectura ? escritura - lectura : 0;
+    }
+
+    size_t capacidad() const { return capacidadTotal; }
+};
+
+#endif
@@ -0,0 +1,192 @@
+#ifndef COMPARACION_FORMATOS_H
+#define COMPARACION_FORMATOS_H
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include <json/json.h>
+#include "http_backend_nativo.h"
+#include "../src/formato_binario.h"
+
+using namespace std;
+
+// ======================
+// COMPARACION JSON vs BINARIO
+// ======================
+// simulador_native --comparar-formatos [N]
+// Serializa y decodifica N lecturas sinteticas en cada formato y muestra
+// bytes por lectura y lecturas por segundo. Verifica ademas que el binario
+// conserva los valores redondeados a 2 decimales.
+struct ResultadoFormato {
+    const char* nombre;
+    double bytesPorLectura;
+    double codificadasPorSeg;
+    double decodificadasPorSeg;
+};
+
+inline double segundosDesde(chrono::steady_clock::time_point inicio) {
+    return chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+}
+
+inline vector<LecturaLote> lecturasSinteticas(size_t n) {
+    minstd_rand generador(42);
+    vector<LecturaLote> lecturas;
+    lecturas.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        lecturas.push_back({"ARDUINO_TROPICAL_01", 1700000000000ULL + i * 60000ULL,
+                            roundToTwoDecimals(18.0f + (generador() % 2500) / 100.0f),
+                            roundToTwoDecimals(40.0f + (generador() % 6000) / 100.0f),
+                            roundToTwoDecimals(1000.0f + (generador() % 3000) / 100.0f),
+                            (int)(generador() % 3)});
+    }
+    return lecturas;
+}
+
+inline ResultadoFormato medirJson(const vector<LecturaLote>& lecturas, const char* nombre, const char* indentacion) {
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = indentacion;
+
+    vector<string> serializadas;
+    serializadas.reserve(lecturas.size());
+    size_t bytes = 0;
+
+    auto inicio = chrono::steady_clock::now();
+    for (const auto& l : lecturas) {
+        Json::Value jsonData;
+        jsonData["sensor_id"] = l.sensorId;
+        jsonData["timestamp"] = static_cast<Json::Int64>(l.timestamp);
+        jsonData["temperatura"] = l.temperatura;
+        jsonData["humedad"] = l.humedad;
+        jsonData["presion"] = l.presion;
+        jsonData["alerta"] = l.alerta;
+        jsonData["modo"] = "simulacion_nativo";
+        serializadas.push_back(Json::writeString(writer, jsonData));
+        bytes += serializadas.back().size();
+    }
+    double tCodificar = segundosDesde(inicio);
+
+    Json::CharReaderBuilder readerBuilder;
+    unique_ptr<Json::CharReader> reader(readerBuilder.newCharReader());
+    double suma = 0;
+    inicio = chrono::steady_clock::now();
+    for (const auto& s : serializadas) {
+        Json::Value v;
+        string errors;
+        reader->parse(s.data(), s.data() + s.size(), &v, &errors);
+        suma += v["presion"].asDouble();
+    }
+    double tDecodificar = segundosDesde(inicio);
+    if (suma < 0) printf(" ");  // evita que el compilador descarte el bucle
+
+    return {nombre, (double)bytes / lecturas.size(), lecturas.size() / tCodificar,
+            lecturas.size() / tDecodificar};
+}
+
+// El envio actual: EscritorJson sobre un buffer de pila, 2 decimales fijos.
+// La decodificacion es la misma (jsoncpp) que la del backend
+inline ResultadoFormato medirEscritor(const vector<LecturaLote>& lecturas, const char* nombre) {
+    vector<string> serializadas;
+    serializadas.reserve(lecturas.size());
+    char item[HttpClientBackend::TAM_MAX_LECTURA];
+    size_t bytes = 0;
+
+    auto inicio = chrono::steady_clock::now();
+    for (const auto& l : lecturas) {
+        bytes += HttpClientBackend::escribirLecturaJson(l, item, sizeof(item));
+    }
+    double tCodificar = segundosDesde(inicio);
+    for (const auto& l : lecturas) serializadas.push_back(HttpClientBackend::lecturaAJson(l));
+
+    unique_ptr<Json::CharReader> reader(Json::CharReaderBuilder().newCharReader());
+    double suma = 0;
+    inicio = chrono::steady_clock::now();
+    for (const auto& s : serializadas) {
+        Json::Value v;
+        reader->parse(s.data(), s.data() + s.size(), &v, nullptr);
+        suma += v["presion"].asDouble();
+    }
+    double tDecodificar = segundosDesde(inicio);
+    if (suma < 0) printf(" ");
+
+    return {nombre, (double)bytes / lecturas.size(), lecturas.size() / tCodificar,
+            lecturas.size() / tDecodificar};
+}
+
+inline ResultadoFormato medirBinario(const vector<LecturaLote>& lecturas, uint8_t porTrama,
+                                     const char* nombre, size_t& errores) {
+    vector<uint8_t> buffer(lecturas.size() / porTrama * tamTramaBinaria(32, porTrama) +
+                           tamTramaBinaria(32, porTrama));
+    vector<LecturaBinaria> binarias(porTrama);
+    size_t usado = 0;
+
+    auto inicio = chrono::steady_clock::now();
+    for (size_t i = 0; i < lecturas.size(); i += porTrama) {
+        uint8_t n = (uint8_t)min<size_t>(porTrama, lecturas.size() - i);
+        for (uint8_t k = 0; k < n; k++) {
+            const LecturaLote& l = lecturas[i + k];
+            binarias[k] = {l.timestamp, l.temperatura, l.humedad, l.presion, (uint8_t)l.alerta};
+        }
+        usado += codificarTramaBinaria(buffer.data() + usado, buffer.size() - usado,
+                                       lecturas[i].sensorId.c_str(), binarias.data(), n);
+    }
+    double tCodificar = segundosDesde(inicio);
+
+    char id[64];
+    size_t leidas = 0;
+    size_t pos = 0;
+    errores = 0;
+    inicio = chrono::steady_clock::now();
+    while (pos < usado) {
+        uint8_t n = 0;
+        size_t consumidos = decodificarTramaBinaria(buffer.data() + pos, usado - pos, id, sizeof(id),
+                                                   binarias.data(), porTrama, n);
+        if (consumidos == 0) {
+            errores++;
+            break;
+        }
+        for (uint8_t k = 0; k < n; k++) {
+            const LecturaLote& original = lecturas[leidas + k];
+            if (fabsf(binarias[k].presion - original.presion) > 0.006f ||
+                fabsf(binarias[k].temperatura - original.temperatura) > 0.006f ||
+                fabsf(binarias[k].humedad - original.humedad) > 0.006f ||
+                binarias[k].timestampMs != original.timestamp) {
+                errores++;
+            }
+        }
+        leidas += n;
+        pos += consumidos;
+    }
+    double tDecodificar = segundosDesde(inicio);
+    if (leidas != lecturas.size()) errores++;
+
+    return {nombre, (double)usado / lecturas.size(), lecturas.size() / tCodificar,
+            lecturas.size() / tDecodificar};
+}
+
+inline void compararFormatos(size_t n) {
+    if (n == 0) n = 100000;
+    vector<LecturaLote> lecturas = lecturasSinteticas(n);
+    size_t erroresUna = 0, erroresLote = 0;
+
+    ResultadoFormato resultados[] = {
+        medirJson(lecturas, "JSON indentado (jsoncpp)", "  "),
+        medirJson(lecturas, "JSON compacto (jsoncpp)", ""),
+        medirEscritor(lecturas, "JSON EscritorJson (envio actual)"),
+        medirBinario(lecturas, 1, "Binario, 1 lectura/trama", erroresUna),
+        medirBinario(lecturas, 50, "Binario, 50 lecturas/trama", erroresLote),
+    };
+
+    printf("====================================\n");
+    printf("COMPARACION DE FORMATOS (%zu lecturas)\n", n);
+    printf("====================================\n");
+    printf("%-32s %10s %16s %16s\n", "formato", "bytes/lect", "codif. lect/s", "decodif. lect/s");
+    for (const auto& r : resultados) {
+        printf("%-32s %10.1f %16.0f %16.0f\n", r.nombre, r.bytesPorLectura,
+               r.codificadasPorSeg, r.decodificadasPorSeg);
+    }
+    printf("Ida y vuelta binario: %s\n", erroresUna + erroresLote == 0 ? "OK" : "CON ERRORES");
+}
+
+#endif
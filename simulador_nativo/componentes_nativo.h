@@ -0,0 +1,223 @@
+#ifndef COMPONENTES_NATIVO_H
+#define COMPONENTES_NATIVO_H
+
+#include <cstdlib>
+#include <algorithm>
+#include <random>
+#include "arduino_nativo.h"
+#include "registro_nativo.h"
+#include "config_nativo.h"
+#include "../src/ventana_estadistica.h"
+#include "../src/puntuacion_riesgo.h"
+#include "../src/agregados_multiresolucion.h"
+#include "../src/filtro_robusto.h"
+#include "../src/filtro_kalman.h"
+
+// ======================
+// ESTRUCTURAS DE DATOS
+// ======================
+struct SensorData {
+    float temperatura;
+    float humedad;
+    float presion;
+    unsigned long timestamp;
+};
+
+struct FilteredData {
+    float temperatura;
+    float humedad;
+    float presion;
+};
+
+// ======================
+// CLASE SensorController
+// ======================
+class SensorController {
+private:
+    // Generador propio por estacion: rand() es global y, con muchas
+    // estaciones en varios hilos, ni es reproducible ni escala
+    minstd_rand generador;
+
+    unsigned int aleatorio(unsigned int limite) {
+        return generador() % limite;
+    }
+
+public:
+    void begin() {
+        LOG_INFO("SensorController inicializado (simulacion)");
+    }
+
+    void semilla(unsigned int valor) {
+        generador.seed(valor);
+    }
+
+    SensorData readSensors() {
+        SensorData data;
+        data.timestamp = millis();
+        
+        float baseHumedad = 40 + aleatorio(6000) / 100.0;
+        
+        if (baseHumedad > 80) {
+            data.presion = 1000.0 + aleatorio(1500) / 100.0;
+            data.temperatura = 18.0 + aleatorio(1500) / 100.0;
+        } else if (baseHumedad > 60) {
+            data.presion = 1010.0 + aleatorio(1500) / 100.0;
+            data.temperatura = 22.0 + aleatorio(1800) / 100.0;
+        } else {
+            data.presion = 1015.0 + aleatorio(1500) / 100.0;
+            data.temperatura = 25.0 + aleatorio(2000) / 100.0;
+        }
+        
+        data.humedad = max(30.0f, min(100.0f, baseHumedad));
+        
+        LOG_DEPURACION("SIMULACION - T:%.2fC H:%.2f%% P:%.2fhPa", data.temperatura, data.humedad, data.presion);
+        
+        return data;
+    }
+};
+
+// ======================
+// CLASE DataFilter
+// ======================
+class DataFilter {
+private:
+    // Acumuladores en float, como en el Arduino y en --reproducir: las tres
+    // rutas dan los mismos niveles incluso en el borde de un umbral
+    VentanaEstadistica<float, float, TAM_VENTANA_FILTRO> historialTemperatura;
+    VentanaEstadistica<float, float, TAM_VENTANA_FILTRO> historialHumedad;
+    VentanaEstadistica<float, float, TAM_VENTANA_FILTRO> historialPresion;
+#if AGREGADOS_MULTIRESOLUCION
+    // Resumenes a 1 min, 10 min y 1 h, como en el Arduino
+    AgregadosMultiresolucion agregados[NUM_VARIABLES];
+#endif
+    // Etapa robusta de filtro_robusto.h. En el Arduino se elige al compilar
+    // (FILTRO_ROBUSTO); aqui en ejecucion, para comparar en la flota. Solo
+    // se alimenta la del modo activo
+    int modoFiltro = FILTRO_ROBUSTO;
+    MedianaDeslizante<float, float, TAM_VENTANA_ROBUSTA> medianas[NUM_VARIABLES];
+    FiltroHampel<float, float, TAM_VENTANA_ROBUSTA> hampel[NUM_VARIABLES] = {
+        FiltroHampel<float, float, TAM_VENTANA_ROBUSTA>(HAMPEL_MINIMO_TEMPERATURA),
+        FiltroHampel<float, float, TAM_VENTANA_ROBUSTA>(HAMPEL_MINIMO_HUMEDAD),
+        FiltroHampel<float, float, TAM_VENTANA_ROBUSTA>(HAMPEL_MINIMO_PRESION)};
+
+    float robusto(VariableMedida variable, float valor, bool& atipica) {
+        if (modoFiltro == FILTRO_MEDIANA) {
+            medianas[variable].agregar(valor);
+            return medianas[variable].mediana();
+        }
+        if (modoFiltro == FILTRO_HAMPEL && hampel[variable].limpiar(valor)) atipica = true;
+        return valor;
+    }
+
+    // Motor de filtro_kalman.h o ventana; tambien se elige en ejecucion
+    // (MOTOR_FILTRO en el Arduino) y solo se alimenta el activo
+    int motor = MOTOR_FILTRO;
+    FiltroKalman kalman[NUM_VARIABLES] = {
+        FiltroKalman(KALMAN_MEDIDA_TEMPERATURA, KALMAN_ACELERACION_TEMPERATURA),
+        FiltroKalman(KALMAN_MEDIDA_HUMEDAD, KALMAN_ACELERACION_HUMEDAD),
+        FiltroKalman(KALMAN_MEDIDA_PRESION, KALMAN_ACELERACION_PRESION)};
+
+public:
+    void configurarFiltro(int modo) {
+        modoFiltro = modo;
+    }
+
+    // MOTOR_VENTANA o MOTOR_KALMAN (config.h)
+    void configurarMotor(int m) {
+        motor = m;
+    }
+
+    // Devuelve true si alguna variable de la muestra era atipica y entro
+    // en su lugar la mediana (solo con FILTRO_HAMPEL)
+    bool addData(float temp, float hum, float pres) {
+        bool atipica = false;
+        temp = robusto(VARIABLE_TEMPERATURA, temp, atipica);
+        hum = robusto(VARIABLE_HUMEDAD, hum, atipica);
+        pres = robusto(VARIABLE_PRESION, pres, atipica);
+        if (atipica) LOG_DEPURACION("FILTRADO - lectura atipica sustituida por la mediana");
+
+        if (motor == MOTOR_KALMAN) {
+            kalman[VARIABLE_TEMPERATURA].agregar(temp);
+            kalman[VARIABLE_HUMEDAD].agregar(hum);
+            kalman[VARIABLE_PRESION].agregar(pres);
+        } else {
+            historialTemperatura.add(temp);
+            historialHumedad.add(hum);
+            historialPresion.add(pres);
+        }
+#if AGREGADOS_MULTIRESOLUCION
+        agregados[VARIABLE_TEMPERATURA].agregar(temp);
+        agregados[VARIABLE_HUMEDAD].agregar(hum);
+        agregados[VARIABLE_PRESION].agregar(pres);
+#endif
+        return atipica;
+    }
+
+#if AGREGADOS_MULTIRESOLUCION
+    ResumenVentana resumen(VariableMedida variable, NivelResolucion nivel) const {
+        return agregados[variable].resumen(nivel);
+    }
+#endif
+
+    FilteredData filter() {
+        FilteredData result = {0, 0, 0};
+
+        if (motor == MOTOR_KALMAN) {
+            if (!kalman[VARIABLE_TEMPERATURA].iniciadoConDatos()) return result;
+            result.temperatura = kalman[VARIABLE_TEMPERATURA].nivel();
+            result.humedad = kalman[VARIABLE_HUMEDAD].nivel();
+            result.presion = kalman[VARIABLE_PRESION].nivel();
+        } else {
+            if (historialTemperatura.size() == 0) return result;
+            result.temperatura = historialTemperatura.media();
+            result.humedad = historialHumedad.media();
+            result.presion = historialPresion.media();
+        }
+
+        LOG_DEPURACION("FILTRADO - T:%.2fC H:%.2f%% P:%.2fhPa", result.temperatura, result.humedad, result.presion);
+
+        return result;
+    }
+
+    float calculateHumidityTrend() {
+        float pendiente = motor == MOTOR_KALMAN ? kalman[VARIABLE_HUMEDAD].tasa() : historialHumedad.pendiente();
+        
+        LOG_DEPURACION("   Tendencia humedad: %.2f", pendiente);
+        return pendiente;
+    }
+
+    float calculatePressureTrend() {
+        float pendiente = motor == MOTOR_KALMAN ? kalman[VARIABLE_PRESION].tasa() : historialPresion.pendiente();
+        
+        LOG_DEPURACION("   Tendencia presion: %.2f", pendiente);
+        return pendiente;
+    }
+};
+
+// ======================
+// CLASE PredictionEngine
+// ======================
+class PredictionEngine {
+public:
+    int predict(float temperatura, float humedad, float presion, float tendenciaHumedad, float tendenciaPresion) {
+        // Mismas reglas y umbrales que el Arduino (src/puntuacion_riesgo.h)
+        int puntos = puntosRiesgo(temperatura, humedad, presion, tendenciaHumedad, tendenciaPresion);
+        int nivel = nivelAlerta(puntos, humedad, presion);
+
+        if (nivel == 2) {
+            LOG_INFO("PREDICCION: ALERTA ROJA - Lluvia inminente");
+        }
+        else if (nivel == 1) {
+            LOG_INFO("PREDICCION: ALERTA AMARILLA - Posible lluvia");
+        }
+        else {
+            LOG_INFO("PREDICCION: NORMAL - Condiciones estables");
+        }
+
+        LOG_DEPURACION("   Puntos de riesgo: %d", puntos);
+
+        return nivel;
+    }
+};
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef CONEXIONES_HTTP_H
+#define CONEXIONES_HTTP_H
+
+#include <mutex>
+#include <curl/curl.h>
+#include "metricas_nativo.h"
+#include "registro_nativo.h"
+
+using namespace std;
+
+// ======================
+// CONEXIONES PERSISTENTES AL BACKEND
+// ======================
+// Opciones comunes a todos los handles que hablan con el backend para que
+// cada POST reutilice una conexion abierta en lugar de abrir otra:
+// - HTTP/1.1 persistente con keep-alive TCP. curl guarda la conexion en la
+//   cache del handle sincrono o del multi del transporte asincrono, asi
+//   que basta con no destruirlos entre envios
+// - HTTP/2 sin TLS (h2c, prior knowledge) con --http2: en curl_multi las
+//   solicitudes en vuelo se multiplexan sobre una sola conexion. El
+//   pipelining de HTTP/1.1 ya no existe en libcurl (7.62+)
+// - Tope de conexiones por host en cada multi: lo que no cabe espera
+//   dentro de curl a que una conexion quede libre
+// - Un CURLSH comparte la cache de DNS y las sesiones TLS entre los hilos
+//   de la flota. La cache de conexiones no: curl no admite compartirla
+//   entre hilos concurrentes, por eso cada hilo conserva la suya
+struct ConfigConexiones {
+    long maxConexiones = 0;   // por transporte asincrono; 0 = sin tope
+    bool http2 = false;
+};
+
+class ConexionesHttp {
+private:
+    ConfigConexiones config;
+    CURLSH* compartido = nullptr;
+    mutex cerrojos[CURL_LOCK_DATA_LAST];
+
+    static void bloquear(CURL*, curl_lock_data dato, curl_lock_access, void* usuario) {
+        static_cast<ConexionesHttp*>(usuario)->cerrojos[dato].lock();
+    }
+
+    static void desbloquear(CURL*, curl_lock_data dato, void* usuario) {
+        static_cast<ConexionesHttp*>(usuario)->cerrojos[dato].unlock();
+    }
+
+public:
+    explicit ConexionesHttp(const ConfigConexiones& cfg = ConfigConexiones()) : config(cfg) {
+        static once_flag curlIniciado;
+        call_once(curlIniciado, [] { curl_global_init(CURL_GLOBAL_DEFAULT); });
+
+        if (config.http2 && !(curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_HTTP2)) {
+            LOG_AVISO("libcurl sin soporte HTTP/2: se usa HTTP/1.1");
+            config.http2 = false;
+        }
+
+        compartido = curl_share_init();
+        if (compartido) {
+            curl_share_setopt(compartido, CURLSHOPT_LOCKFUNC, bloquear);
+            curl_share_setopt(compartido, CURLSHOPT_UNLOCKFUNC, desbloquear);
+            curl_share_setopt(compartido, CURLSHOPT_USERDATA, this);
+            curl_share_setopt(compartido, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(compartido, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        }
+    }
+
+    // Los handles que lo usan deben destruirse antes
+    ~ConexionesHttp() {
+        if (compartido) curl_share_cleanup(compartido);
+    }
+
+    ConexionesHttp(const ConexionesHttp&) = delete;
+    ConexionesHttp& operator=(const ConexionesHttp&) = delete;
+
+    const ConfigConexiones& configuracion() const { return config; }
+
+    // Tras curl_easy_reset() hay que volver a aplicarlo
+    void configurar(CURL* easy) const {
+        if (compartido) curl_easy_setopt(easy, CURLOPT_SHARE, compartido);
+        curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(easy, CURLOPT_TCP_KEEPIDLE, 30L);
+        curl_easy_setopt(easy, CURLOPT_TCP_KEEPINTVL, 15L);
+        curl_easy_setopt(easy, CURLOPT_HTTP_VERSION,
+                         config.http2 ? (long)CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE : (long)CURL_HTTP_VERSION_1_1);
+        // Con HTTP/2, esperar a poder multiplexar sobre la conexion que se
+        // esta abriendo antes que abrir otra en paralelo
+        curl_easy_setopt(easy, CURLOPT_PIPEWAIT, config.http2 ? 1L : 0L);
+    }
+
+    void configurarMulti(CURLM* multi) const {
+        curl_multi_setopt(multi, CURLMOPT_PIPELINING, config.http2 ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING);
+        if (config.maxConexiones > 0) {
+            curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, config.maxConexiones);
+        }
+    }
+};
+
+// Conexiones que abrio la transferencia (0 si reutilizo una abierta); las
+// suma a las metricas y las devuelve
+inline long contarConexiones(CURL* easy) {
+    long nuevas = 0;
+    if (curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &nuevas) == CURLE_OK && nuevas > 0) {
+        metricas.conexiones.fetch_add((uint64_t)nuevas, memory_order_relaxed);
+        return nuevas;
+    }
+    return 0;
+}
+
+#endif
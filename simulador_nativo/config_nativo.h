@@ -0,0 +1,16 @@
+#ifndef CONFIG_NATIVO_H
+#define CONFIG_NATIVO_H
+
+#include <string>
+#include "../src/config.h"   // tiempos, ventana y umbrales compartidos con el Arduino
+
+using namespace std;
+
+// ======================
+// CONFIGURACION
+// ======================
+// Configuración de la API
+const string API_URL = "http://localhost:4000/api/sensores";
+const string API_KEY = "tu-api-key-aqui";
+
+#endif
@@ -0,0 +1,251 @@
+#ifndef ESTACION_NATIVA_H
+#define ESTACION_NATIVA_H
+
+#include <functional>
+#include <string>
+#include "arduino_nativo.h"
+#include "config_nativo.h"
+#include "componentes_nativo.h"
+#include "http_backend_nativo.h"
+#include "lote_envios.h"
+#include "metricas_nativo.h"
+#include "../src/planificador.h"
+#include "../src/politica_reporte.h"
+
+using namespace std;
+
+// ======================
+// ESTACION VIRTUAL
+// ======================
+// Estado completo de una estacion: el mismo flujo leer -> filtrar -> enviar
+// que el bucle del Arduino, con el mismo planificador, pero encapsulado
+// para poder tener una sola estacion o miles de ellas en el mismo proceso.
+struct ResultadoTick {
+    bool leyo = false;
+    bool descartada = false;
+    int alerta = -1;         // -1 si no hubo prediccion en este tick
+    bool reportada = false;  // la lectura del envio se subio (o se intento)
+    bool suprimida = false;  // sin cambios fuera de banda: no se subio
+    bool atipica = false;    // el filtro de Hampel sustituyo alguna variable
+};
+
+class Estacion {
+public:
+    string sensorId;
+    SensorController sensorController;
+    DataFilter dataFilter;
+    PredictionEngine predictionEngine;
+
+    FilteredData datosFiltrados = {0, 0, 0};
+    // Tendencias del ultimo filtrado, para puntuar la flota en lote
+    float tendenciaHumedad = 0;
+    float tendenciaPresion = 0;
+    // Lectura, filtrado y envio, en ese orden; el reloj de las tareas es
+    // el local (ahora + desfase)
+    Planificador<3> planificador;
+    // Con reportePorBanda, lo que no sale de las bandas no se sube
+    bool reportePorBanda = REPORTE_POR_BANDA;
+    PoliticaReporte politica;
+
+    // Desplaza el reloj local para que las estaciones de una flota no
+    // lean, filtren y envien todas en el mismo instante
+    unsigned long desfase = 0;
+
+    // Resultado de cada envio directo (sincrono o asincrono); lo asigna
+    // quien gestiona la estacion. Los envios en lote informan por el
+    // callback del lote
+    function<void(const LecturaLote&, bool)> alTerminarEnvio;
+
+    Estacion(const string& id, unsigned int semilla, unsigned long desfaseMs = 0)
+        : sensorId(id), desfase(desfaseMs) {
+        sensorController.semilla(semilla);
+        // El reloj local arranca en desfase: cada tarea vence por primera
+        // vez al cumplirse su periodo o, si ya paso, en el primer tick
+        planificador.agregar(tareaLectura, INTERVALO_LECTURA, 0, primerInicio(INTERVALO_LECTURA));
+        planificador.agregar(tareaFiltrado, INTERVALO_FILTRADO, 0, primerInicio(INTERVALO_FILTRADO));
+        planificador.agregar(tareaEnvio, INTERVALO_ENVIO, 0, primerInicio(INTERVALO_ENVIO));
+        planificador.alSobrecarga([](uint8_t) { MetricasNativas::contar(metricas.sobrecargas); });
+    }
+
+    void begin() {
+        sensorController.begin();
+    }
+
+    // FILTRO_MEDIA, FILTRO_MEDIANA o FILTRO_HAMPEL y MOTOR_VENTANA o
+    // MOTOR_KALMAN (config.h)
+    void configurarFiltro(int modo, int motor) {
+        dataFilter.configurarFiltro(modo);
+        dataFilter.configurarMotor(motor);
+    }
+
+    void configurarReporte(bool porBanda, const BandasReporte& bandas) {
+        reportePorBanda = porBanda;
+        politica = PoliticaReporte(bandas);
+    }
+
+    // Lee los sensores y valida los rangos, sin tocar el filtro. Devuelve
+    // false si la lectura se descarto por invalida
+    bool muestrear(SensorData& datos) {
+        {
+            MedicionNativa m(metricas, ETAPA_LECTURA);
+            datos = sensorController.readSensors();
+        }
+        MetricasNativas::contar(metricas.lecturas);
+        // Mismos rangos que leerSensores() en sistema_controller.cpp
+        if (datos.temperatura > -40 && datos.temperatura < 85 &&
+            datos.humedad >= 0 && datos.humedad <= 100 &&
+            datos.presion > 800 && datos.presion < 1100) {
+            return true;
+        }
+        MetricasNativas::contar(metricas.descartadas);
+        return false;
+    }
+
+    // Lleva una lectura valida al filtro. Devuelve true si el filtro robusto
+    // sustituyo alguna variable por la mediana
+    bool incorporar(const SensorData& datos) {
+        bool atipica = dataFilter.addData(datos.temperatura, datos.humedad, datos.presion);
+        if (atipica) MetricasNativas::contar(metricas.atipicas);
+        return atipica;
+    }
+
+    // Devuelve false si la lectura se descarto por invalida; atipica indica
+    // si el filtro robusto sustituyo alguna variable por la mediana
+    bool leerSensores(bool& atipica) {
+        SensorData datos;
+        if (!muestrear(datos)) return false;
+        atipica = incorporar(datos);
+        return true;
+    }
+
+    // Devuelve el nivel de alerta, o -1 si aun no hay datos filtrados
+    int filtrarDatos() {
+        {
+            MedicionNativa m(metricas, ETAPA_FILTRADO);
+            datosFiltrados = dataFilter.filter();
+        }
+        if (datosFiltrados.humedad > 0) {
+            MedicionNativa m(metricas, ETAPA_PREDICCION);
+            tendenciaHumedad = dataFilter.calculateHumidityTrend();
+            tendenciaPresion = dataFilter.calculatePressureTrend();
+            return predictionEngine.predict(datosFiltrados.temperatura, datosFiltrados.humedad,
+                                            datosFiltrados.presion, tendenciaHumedad, tendenciaPresion);
+        }
+        return -1;
+    }
+
+    // Prediccion y politica de reporte del envio, sin enviar nada: deja la
+    // alerta en resultado y devuelve true si la lectura filtrada se sube.
+    // ahora es el instante de la politica (millis() o el tiempo simulado)
+    bool decidirEnvio(unsigned long ahora, ResultadoTick& resultado) {
+        if (datosFiltrados.humedad <= 0) return false;
+        int alerta;
+        {
+            MedicionNativa m(metricas, ETAPA_PREDICCION);
+            float tendenciaHumedad = dataFilter.calculateHumidityTrend();
+            float tendenciaPresion = dataFilter.calculatePressureTrend();
+            alerta = predictionEngine.predict(datosFiltrados.temperatura, datosFiltrados.humedad,
+                                              datosFiltrados.presion, tendenciaHumedad, tendenciaPresion);
+        }
+        resultado.alerta = alerta;
+
+        if (reportePorBanda &&
+            politica.evaluar(datosFiltrados.temperatura, datosFiltrados.humedad, datosFiltrados.presion,
+                             alerta, ahora) == REPORTE_SUPRIMIDO) {
+            resultado.suprimida = true;
+            MetricasNativas::contar(metricas.suprimidas);
+            return false;
+        }
+        resultado.reportada = true;
+        return true;
+    }
+
+    // Sin backend (flota con --sin-envio) se predice pero no se envia, aunque
+    // la politica de reporte se evalua igual. Con lote la lectura solo se
+    // encola: su resultado llega por el callback del lote cuando este se
+    // envia
+    bool enviarAlBackend(HttpClientBackend* httpBackend, LoteEnvios* lote, ResultadoTick& resultado) {
+        if (!decidirEnvio(millis(), resultado)) return false;
+        int alerta = resultado.alerta;
+        LecturaLote lectura = {sensorId, getUnixTimestampMillis(), datosFiltrados.temperatura,
+                               datosFiltrados.humedad, datosFiltrados.presion, alerta};
+        if (lote) {
+            lote->agregar(lectura);
+            return true;
+        }
+        if (!httpBackend) return false;
+
+        if (httpBackend->esAsync()) {
+            httpBackend->sendDataAsync(lectura, [this, lectura](bool exito) {
+                if (exito) LOG_DEPURACION("Envio exitoso a la API");
+                else LOG_AVISO("Fallo en el envio a la API");
+                if (alTerminarEnvio) alTerminarEnvio(lectura, exito);
+            });
+            return true;
+        }
+
+        // Redondear los datos ANTES de enviar
+        float temp_redondeada = roundToTwoDecimals(datosFiltrados.temperatura);
+        float hum_redondeada = roundToTwoDecimals(datosFiltrados.humedad);
+        float pres_redondeada = roundToTwoDecimals(datosFiltrados.presion);
+
+        // Ahora envía a la API real
+        bool exito = httpBackend->sendData(sensorId, temp_redondeada, hum_redondeada, pres_redondeada, alerta);
+        if (alTerminarEnvio) alTerminarEnvio(lectura, exito);
+
+        if (exito) {
+            LOG_DEPURACION("Envio exitoso a la API");
+        } else {
+            LOG_AVISO("Fallo en el envio a la API");
+        }
+
+        LOG_DEPURACION("------------------------------------");
+        return exito;
+    }
+
+    // Primer instante (en la escala de ahora) en que tick() hara algo: la
+    // proxima lectura, filtrado o envio. El bucle duerme (o, con el reloj
+    // virtual, salta) directamente hasta ahi
+    unsigned long proximoEvento(unsigned long ahora) const {
+        return ahora + planificador.restante(ahora + desfase);
+    }
+
+    ResultadoTick tick(unsigned long ahora, HttpClientBackend* httpBackend, LoteEnvios* lote = nullptr) {
+        ResultadoTick resultado;
+        ContextoTick contexto = {this, httpBackend, lote, &resultado};
+        planificador.ejecutarPendientes(ahora + desfase, &contexto);
+        return resultado;
+    }
+
+private:
+    unsigned long primerInicio(unsigned long periodo) const {
+        return desfase > periodo ? desfase - periodo : 0;
+    }
+
+    // Lo que las tareas necesitan del tick en curso; vive en la pila de
+    // tick(), asi que copiar o mover la estacion no deja punteros colgando
+    struct ContextoTick {
+        Estacion* estacion;
+        HttpClientBackend* httpBackend;
+        LoteEnvios* lote;
+        ResultadoTick* resultado;
+    };
+
+    static void tareaLectura(void* p) {
+        ContextoTick* c = static_cast<ContextoTick*>(p);
+        c->resultado->leyo = true;
+        c->resultado->descartada = !c->estacion->leerSensores(c->resultado->atipica);
+    }
+
+    static void tareaFiltrado(void* p) {
+        ContextoTick* c = static_cast<ContextoTick*>(p);
+        c->resultado->alerta = c->estacion->filtrarDatos();
+    }
+
+    static void tareaEnvio(void* p) {
+        ContextoTick* c = static_cast<ContextoTick*>(p);
+        c->estacion->enviarAlBackend(c->httpBackend, c->lote, *c->resultado);
+    }
+};
+
+#endif
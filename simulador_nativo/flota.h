@@ -0,0 +1,352 @@
+#ifndef FLOTA_H
+#define FLOTA_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "arduino_nativo.h"
+#include "config_nativo.h"
+#include "conexiones_http.h"
+#include "estacion_nativa.h"
+#include "http_backend_nativo.h"
+#include "lote_envios.h"
+#include "prediccion_lote.h"
+#include "pool_hilos.h"
+#include "cola_persistente.h"
+#include "transporte_async.h"
+
+using namespace std;
+
+// ======================
+// SIMULADOR DE FLOTA
+// ======================
+// N estaciones virtuales independientes en un solo proceso. En cada paso
+// se encola una tarea ligera por estacion en el pool con robo de tareas;
+// cada tarea ejecuta el tick de su estacion contra el reloj compartido.
+struct ConfigFlota {
+    int estaciones = 1000;
+    unsigned hilos = 0;                // 0 = un hilo por nucleo
+    unsigned long duracionMs = 0;      // 0 = sin limite
+    unsigned long pasoMs = 1000;
+    unsigned long intervaloResumenMs = 10000;
+    bool enviar = true;
+    unsigned int semilla = 1;
+    bool usarLote = false;
+    ConfigLote lote;
+    size_t maxEnVuelo = 0;             // 0 = envio sincrono
+    ConfigConexiones conexiones;
+    string rutaCola;                   // vacia = sin cola persistente
+    uint32_t capacidadCola = 100000;
+    bool formatoBinario = false;
+    bool reportePorBanda = REPORTE_POR_BANDA;
+    BandasReporte bandas;
+    int filtro = FILTRO_ROBUSTO;       // etapa robusta del DataFilter
+    int motor = MOTOR_FILTRO;          // ventana o Kalman
+    bool relojVirtual = false;         // saltar de evento en evento sin dormir
+    string rutaMetricas;               // vacia = sin volcado de metricas
+    unsigned long intervaloMetricasMs = 10000;
+    // --pipeline: hilos dedicados por etapa en lugar del pool
+    // (flota_pipeline.h)
+    bool pipeline = false;
+    unsigned hilosMuestreo = 1;
+    unsigned hilosAnalitica = 0;       // 0 = los nucleos que quedan libres
+    unsigned hilosEnvio = 1;
+    size_t capacidadEtapa = 4096;      // por cola entre etapas
+};
+
+struct EstadisticasFlota {
+    atomic<unsigned long long> lecturas{0};
+    atomic<unsigned long long> descartadas{0};
+    atomic<unsigned long long> envios{0};
+    atomic<unsigned long long> enviosFallidos{0};
+    atomic<unsigned long long> reportadas{0};
+    atomic<unsigned long long> suprimidas{0};
+    atomic<unsigned long long> atipicas{0};
+    atomic<unsigned long long> alertas[3];
+
+    EstadisticasFlota() {
+        for (auto& a : alertas) a = 0;
+    }
+
+    void registrarEnvio(bool exito) {
+        envios++;
+        if (!exito) enviosFallidos++;
+    }
+
+    void registrar(const ResultadoTick& r) {
+        if (r.leyo) lecturas++;
+        if (r.descartada) descartadas++;
+        if (r.reportada) reportadas++;
+        if (r.suprimida) suprimidas++;
+        if (r.atipica) atipicas++;
+        if (r.alerta >= 0 && r.alerta <= 2) alertas[r.alerta]++;
+    }
+};
+
+class SimuladorFlota {
+private:
+    ConfigFlota config;
+    vector<Estacion> estaciones;
+    PoolHilos pool;
+    // Opciones de conexion comunes y cache de DNS compartida. Se declara
+    // antes que backends y transportes para destruirse despues de ellos
+    ConexionesHttp conexiones;
+    // Un backend (handle CURL) por hilo trabajador: los handles no se
+    // pueden compartir entre hilos y asi no hace falta bloquearlos
+    vector<unique_ptr<HttpClientBackend>> backends;
+    // Con --lote cada hilo agrupa las lecturas de todas las estaciones que
+    // procesa y las sube con su propio backend
+    vector<unique_ptr<LoteEnvios>> lotes;
+    // Con --async cada backend tiene su transporte curl_multi; la red
+    // avanza mientras el pool espera al siguiente paso
+    vector<unique_ptr<TransporteAsync>> transportes;
+    // Cola persistente compartida por toda la flota para las lecturas que
+    // no se pudieron subir; se vacia con el backend del hilo 0
+    ColaPersistente cola;
+    unique_ptr<ReenvioPendientes> reenvio;
+    EstadisticasFlota stats;
+    vector<Estacion*> listas;   // estaciones a procesar en el paso actual
+    DatosPrediccionSoA estado;  // ultima lectura filtrada de cada estacion
+
+    static unsigned hilosPorDefecto(unsigned pedidos) {
+        if (pedidos > 0) return pedidos;
+        unsigned n = thread::hardware_concurrency();
+        return n > 0 ? n : 1;
+    }
+
+    void registrarResultado(const LecturaLote& lectura, bool exito) {
+        stats.registrarEnvio(exito);
+        if (reenvio) reenvio->registrarResultado(lectura, exito);
+    }
+
+public:
+    explicit SimuladorFlota(const ConfigFlota& cfg)
+        : config(cfg), pool(hilosPorDefecto(cfg.hilos)), conexiones(cfg.conexiones) {
+        if (config.enviar && !config.rutaCola.empty() &&
+            cola.abrir(config.rutaCola, config.capacidadCola)) {
+            reenvio.reset(new ReenvioPendientes(cola));
+        }
+
+        estaciones.reserve(config.estaciones);
+        minstd_rand generador(config.semilla);
+        for (int i = 0; i < config.estaciones; i++) {
+            char id[32];
+            snprintf(id, sizeof(id), "SIM_FLOTA_%05d", i + 1);
+            estaciones.emplace_back(id, generador(), generador() % INTERVALO_ENVIO);
+            estaciones.back().configurarReporte(config.reportePorBanda, config.bandas);
+            estaciones.back().configurarFiltro(config.filtro, config.motor);
+            estaciones.back().alTerminarEnvio = [this](const LecturaLote& lectura, bool exito) {
+                registrarResultado(lectura, exito);
+            };
+        }
+
+        if (config.enviar) {
+            for (unsigned i = 0; i < pool.size(); i++) {
+                backends.emplace_back(new HttpClientBackend());
+                backends.back()->begin(&conexiones);
+                backends.back()->usarFormatoBinario(config.formatoBinario);
+                if (config.maxEnVuelo > 0) {
+                    transportes.emplace_back(new TransporteAsync(config.maxEnVuelo, 1024, &conexiones));
+                    backends.back()->usarTransporte(transportes.back().get());
+                }
+                if (config.usarLote) {
+                    lotes.emplace_back(new LoteEnvios(*backends.back(), config.lote,
+                        [this](const LecturaLote& lectura, bool exito) { registrarResultado(lectura, exito); }));
+                }
+            }
+        }
+    }
+
+    const EstadisticasFlota& estadisticas() const { return stats; }
+
+    // Un paso: las estaciones con algo que hacer en este instante (las demas
+    // no harian nada en tick()) se reparten en bloques, una tarea por
+    // bloque, y se espera a que terminen todas
+    void paso(unsigned long ahora) {
+        listas.clear();
+        for (auto& estacion : estaciones) {
+            if (estacion.proximoEvento(ahora) == ahora) listas.push_back(&estacion);
+        }
+
+        size_t porTarea = max<size_t>(1, listas.size() / (pool.size() * 4));
+        for (size_t inicio = 0; inicio < listas.size(); inicio += porTarea) {
+            size_t fin = min(listas.size(), inicio + porTarea);
+            pool.submit([this, ahora, inicio, fin] {
+                int hilo = PoolHilos::hiloActual();
+                HttpClientBackend* backend = backends.empty() ? nullptr : backends[hilo].get();
+                LoteEnvios* lote = lotes.empty() ? nullptr : lotes[hilo].get();
+                for (size_t i = inicio; i < fin; i++) {
+                    stats.registrar(listas[i]->tick(ahora, backend, lote));
+                }
+            });
+        }
+        pool.esperar();
+
+        // Lotes que llevan demasiado tiempo abiertos. El pool esta ocioso,
+        // asi que cada lote (y su backend) lo usa una sola tarea a la vez
+        for (auto& lote : lotes) {
+            LoteEnvios* l = lote.get();
+            if (l->size() == 0) continue;
+            pool.submit([l] { l->revisar(); });
+        }
+        pool.esperar();
+
+        if (reenvio) {
+            pool.submit([this] { reenvio->revisar(*backends[0]); });
+            pool.esperar();
+        }
+    }
+
+    // Mientras no toca el siguiente paso, cada transporte procesa su red
+    // en paralelo hasta el limite; sin transportes simplemente se duerme
+    void esperarHasta(unsigned long limite) {
+        if (transportes.empty()) {
+            unsigned long ahora = millis();
+            if ((long)(limite - ahora) > 0) delay(limite - ahora);
+            return;
+        }
+        for (auto& transporte : transportes) {
+            TransporteAsync* t = transporte.get();
+            pool.submit([t, limite] { t->procesarHasta(limite); });
+        }
+        pool.esperar();
+    }
+
+    // Proximo paso (relativo a inicio): el primer vencimiento de cualquier
+    // estacion, lote o reintento de la cola, redondeado a pasoMs para que
+    // las estaciones que vencen casi a la vez se atiendan en un solo paso,
+    // y sin pasar del final de la simulacion. Si nada vence antes, no se
+    // despierta en vano cada pasoMs
+    unsigned long siguientePaso(unsigned long inicio, unsigned long ahora) {
+        unsigned long siguiente = ahora + INTERVALO_LECTURA;
+        for (const auto& estacion : estaciones) {
+            siguiente = min(siguiente, estacion.proximoEvento(ahora));
+        }
+        unsigned long limite;
+        for (const auto& lote : lotes) {
+            if (lote->vencimiento(limite)) siguiente = min(siguiente, limite - inicio);
+        }
+        if (reenvio && reenvio->vencimiento(limite)) siguiente = min(siguiente, limite - inicio);
+        siguiente = max(siguiente, ahora + 1);
+        siguiente = (siguiente + config.pasoMs - 1) / config.pasoMs * config.pasoMs;
+        if (config.duracionMs > 0) siguiente = min(siguiente, config.duracionMs);
+        return siguiente;
+    }
+
+    // Reloj virtual: lo que siga en vuelo se completa antes de avanzar (la
+    // red no consume tiempo simulado) y el reloj salta al siguiente paso
+    void saltarAlSiguienteEvento(unsigned long inicio, unsigned long ahora) {
+        for (auto& transporte : transportes) {
+            while (!transporte->ocioso()) transporte->procesar(100);
+        }
+        avanzarRelojHasta(inicio + siguientePaso(inicio, ahora));
+    }
+
+    // Vacia los lotes pendientes al terminar la simulacion y espera las
+    // respuestas de lo que siga en vuelo
+    void vaciarLotes() {
+        for (auto& lote : lotes) lote->enviar();
+        unsigned long limite = millis() + 15000;
+        for (auto& transporte : transportes) {
+            while (!transporte->ocioso() && (long)(limite - millis()) > 0) {
+                transporte->procesar(100);
+            }
+        }
+    }
+
+    // Nivel actual de toda la flota: copia el ultimo filtrado de cada
+    // estacion a columnas y las puntua de una pasada con puntuarLote()
+    void puntuarEstado(unsigned long (&niveles)[3]) {
+        estado.resize(estaciones.size());
+        size_t n = 0;
+        for (const auto& estacion : estaciones) {
+            if (estacion.datosFiltrados.humedad <= 0) continue;
+            estado.temperatura[n] = estacion.datosFiltrados.temperatura;
+            estado.humedad[n] = estacion.datosFiltrados.humedad;
+            estado.presion[n] = estacion.datosFiltrados.presion;
+            estado.tendenciaHumedad[n] = estacion.tendenciaHumedad;
+            estado.tendenciaPresion[n] = estacion.tendenciaPresion;
+            n++;
+        }
+        estado.resize(n);
+        estado.puntuar();
+        for (int32_t nivel : estado.nivel) niveles[nivel]++;
+    }
+
+    void imprimirResumen(unsigned long ahora) {
+        cout << "FLOTA t=" << ahora / 1000 << "s"
+             << " estaciones=" << estaciones.size()
+             << " lecturas=" << stats.lecturas
+             << " descartadas=" << stats.descartadas
+             << " envios=" << stats.envios
+             << " fallidos=" << stats.enviosFallidos;
+        if (config.reportePorBanda) {
+            cout << " reportadas=" << stats.reportadas
+                 << " suprimidas=" << stats.suprimidas;
+        }
+        if (config.filtro == FILTRO_HAMPEL) cout << " atipicas=" << stats.atipicas;
+        if (config.enviar) cout << " conexiones=" << metricas.conexiones;
+        if (reenvio) {
+            cout << " pendientes=" << cola.size()
+                 << " reenviadas=" << reenvio->totalReenviadas()
+                 << " rechazadas=" << reenvio->totalRechazadas();
+        }
+        cout
+             << " alertas[N/A/R]=" << stats.alertas[0] << "/"
+             << stats.alertas[1] << "/" << stats.alertas[2];
+        unsigned long niveles[3] = {0, 0, 0};
+        puntuarEstado(niveles);
+        cout << " estado[N/A/R]=" << niveles[0] << "/" << niveles[1] << "/" << niveles[2] << "\n";
+        cout.flush();
+    }
+
+    void ejecutar() {
+        cout << "====================================\n"
+             << "MODO FLOTA: " << estaciones.size() << " estaciones en "
+             << pool.size() << " hilos" << (config.enviar ? "" : " (sin envio)")
+             << (config.enviar && config.usarLote ? " (envio en lotes)" : "")
+             << (config.enviar && config.maxEnVuelo > 0 ? " (asincrono)" : "")
+             << (config.relojVirtual ? " (reloj virtual)" : "") << "\n"
+             << "====================================\n";
+
+        auto inicioReal = chrono::steady_clock::now();
+        unsigned long inicio = millis();
+        unsigned long ultimoResumen = 0;
+        unsigned long ultimasMetricas = 0;
+
+        while (true) {
+            unsigned long ahora = millis() - inicio;
+            if (config.duracionMs > 0 && ahora >= config.duracionMs) break;
+
+            paso(ahora);
+
+            if (ahora - ultimoResumen >= config.intervaloResumenMs) {
+                ultimoResumen = ahora;
+                imprimirResumen(ahora);
+            }
+            if (!config.rutaMetricas.empty() && ahora - ultimasMetricas >= config.intervaloMetricasMs) {
+                ultimasMetricas = ahora;
+                metricas.escribir(config.rutaMetricas, ahora);
+            }
+
+            if (config.relojVirtual) {
+                saltarAlSiguienteEvento(inicio, ahora);
+            } else {
+                esperarHasta(inicio + siguientePaso(inicio, ahora));
+            }
+        }
+
+        vaciarLotes();
+        imprimirResumen(millis() - inicio);
+        if (!config.rutaMetricas.empty()) metricas.escribir(config.rutaMetricas, millis() - inicio);
+        if (config.relojVirtual) {
+            double real = chrono::duration<double>(chrono::steady_clock::now() - inicioReal).count();
+            cout << "Simulados " << (millis() - inicio) / 1000 << "s en " << real << "s reales\n";
+        }
+    }
+};
+
+#endif
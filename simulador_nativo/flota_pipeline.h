@@ -0,0 +1,634 @@
+#ifndef FLOTA_PIPELINE_H
+#define FLOTA_PIPELINE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "arduino_nativo.h"
+#include "config_nativo.h"
+#include "colas_anillo.h"
+#include "flota.h"
+
+using namespace std;
+
+// ======================
+// FLOTA EN PIPELINE
+// ======================
+// Alternativa a SimuladorFlota con --pipeline. En lugar de un pool que
+// ejecuta el tick completo de cada estacion, cada etapa tiene sus hilos:
+//
+//   muestreo --SPSC--> analitica --MPSC--> envio
+//
+// - muestreo: lee y valida los sensores de su bloque de estaciones cada
+//   INTERVALO_LECTURA (con reloj virtual, tan rapido como pueda)
+// - analitica: filtro robusto, ventana o Kalman, prediccion y politica de
+//   reporte de su bloque; lo que se sube pasa a la cola de envio
+// - envio: serializa y sube con su propio backend, lote y transporte (con
+//   --sin-envio solo cuenta)
+// Cada estacion pertenece a un hilo de muestreo y a uno de analitica: el
+// primero solo toca sus sensores y el segundo su filtro, asi que no hace
+// falta bloquear nada. Hay una cola SPSC por cada par muestreo/analitica
+// y una MPSC por hilo de envio. Una cola llena frena a la etapa anterior
+// (contrapresion) en lugar de crecer: con reloj virtual el muestreo corre
+// tanto como le deja la etapa mas lenta, y los contadores de
+// metricas.pipeline dicen cual es.
+struct MuestraPipeline {
+    uint32_t estacion;
+    SensorData datos;             // timestamp: tiempo simulado en ms
+};
+
+// Sin el sensorId: las colas solo mueven datos planos, sin reservar
+// memoria por elemento. El hilo de envio lo toma de la estacion
+struct EnvioPipeline {
+    uint32_t estacion;
+    unsigned long long marca;     // UNIX en milisegundos
+    float temperatura;
+    float humedad;
+    float presion;
+    int alerta;
+};
+
+// Contadores de un hilo: se suman a EstadisticasFlota por tandas, no con
+// un atomico compartido por lectura
+struct ParcialFlota {
+    unsigned long long lecturas = 0;
+    unsigned long long descartadas = 0;
+    unsigned long long reportadas = 0;
+    unsigned long long suprimidas = 0;
+    unsigned long long atipicas = 0;
+    unsigned long long alertas[3] = {0, 0, 0};
+
+    void registrar(const ResultadoTick& r) {
+        if (r.reportada) reportadas++;
+        if (r.suprimida) suprimidas++;
+        if (r.atipica) atipicas++;
+        if (r.alerta >= 0 && r.alerta <= 2) alertas[r.alerta]++;
+    }
+
+    void volcar(EstadisticasFlota& stats) {
+        if (lecturas) stats.lecturas += lecturas;
+        if (descartadas) stats.descartadas += descartadas;
+        if (reportadas) stats.reportadas += reportadas;
+        if (suprimidas) stats.suprimidas += suprimidas;
+        if (atipicas) stats.atipicas += atipicas;
+        for (int i = 0; i < 3; i++) {
+            if (alertas[i]) stats.alertas[i] += alertas[i];
+        }
+        *this = ParcialFlota();
+    }
+};
+
+class SimuladorPipeline {
+private:
+    // Elementos como maximo por cola en cada vuelta de un consumidor: una
+    // entrada muy cargada no deja sin atender a las demas
+    static const size_t TANDA = 256;
+
+    struct Destino {
+        uint32_t estacion;
+        unsigned long primera;    // instante de su primera lectura
+        ColaSPSC<MuestraPipeline>* cola;
+    };
+
+    // Proximo filtrado y envio de una estacion, en tiempo simulado (el
+    // vencimiento del planificador, sin redondear al paso)
+    struct Agenda {
+        unsigned long filtrado;
+        unsigned long envio;
+    };
+
+    // Tiempo simulado que ya muestreo cada hilo de muestreo
+    struct alignas(LINEA_CACHE) Progreso {
+        atomic<unsigned long> ms{0};
+    };
+
+    ConfigFlota config;
+    unsigned nMuestreo;
+    unsigned nAnalitica;
+    unsigned nEnvio;
+    vector<Estacion> estaciones;
+    // Como en SimuladorFlota: conexiones antes que backends y transportes,
+    // y un backend (con su lote y su transporte) por hilo de envio
+    ConexionesHttp conexiones;
+    vector<unique_ptr<HttpClientBackend>> backends;
+    vector<unique_ptr<LoteEnvios>> lotes;
+    vector<unique_ptr<TransporteAsync>> transportes;
+    // Cola persistente compartida; la revisa el hilo de envio 0
+    ColaPersistente cola;
+    unique_ptr<ReenvioPendientes> reenvio;
+    EstadisticasFlota stats;
+    DatosPrediccionSoA estado;
+
+    vector<unique_ptr<ColaSPSC<MuestraPipeline>>> colasAnalitica;   // [muestreo * nAnalitica + analitica]
+    vector<unique_ptr<ColaMPSC<EnvioPipeline>>> colasEnvio;         // una por hilo de envio
+    unique_ptr<Progreso[]> progreso;
+    atomic<unsigned> muestreoActivos{0};
+    atomic<unsigned> analiticaActivos{0};
+    atomic<unsigned> envioActivos{0};
+    unsigned long inicio = 0;
+
+    static uint64_t microsegundosDesde(chrono::steady_clock::time_point t0) {
+        return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - t0).count();
+    }
+
+    // Primera estacion del bloque k de n hilos; el bloque es
+    // [inicioBloque(k, n), inicioBloque(k + 1, n))
+    size_t inicioBloque(unsigned k, unsigned n) const {
+        return estaciones.size() * k / n;
+    }
+
+    // Mismo calendario que el planificador de Estacion: la tarea vence al
+    // cumplirse su periodo en el reloj local (ahora + desfase) o, si el
+    // desfase ya lo supera, en el arranque; despues, cada periodo
+    static unsigned long primerVencimiento(unsigned long desfase, unsigned long periodo) {
+        return desfase >= periodo ? 0 : periodo - desfase;
+    }
+
+    // SimuladorFlota atiende cada vencimiento en el primer paso que lo
+    // alcanza (siguientePaso() redondea a pasoMs)
+    unsigned long enPaso(unsigned long vencimiento) const {
+        return (vencimiento + config.pasoMs - 1) / config.pasoMs * config.pasoMs;
+    }
+
+    // Contrapresion: con la cola de la etapa siguiente llena se cede el
+    // hilo hasta que haya hueco. Devuelve los microsegundos bloqueado
+    template <typename Cola, typename T>
+    static uint64_t encolar(Cola& destino, const T& valor, ContadoresPipeline& contadores) {
+        if (destino.intentarEncolar(valor)) return 0;
+        contadores.colaLlena.fetch_add(1, memory_order_relaxed);
+        auto t0 = chrono::steady_clock::now();
+        while (!destino.intentarEncolar(valor)) this_thread::yield();
+        return microsegundosDesde(t0);
+    }
+
+    // Consumidor sin trabajo: primero cede el hilo y, si sigue sin llegar
+    // nada, duerme un poco para no quemar un nucleo
+    static void esperarTrabajo(unsigned& vueltas) {
+        if (++vueltas < 64) {
+            this_thread::yield();
+        } else {
+            this_thread::sleep_for(chrono::microseconds(200));
+        }
+    }
+
+    void registrarResultado(const LecturaLote& lectura, bool exito) {
+        stats.registrarEnvio(exito);
+        if (reenvio) reenvio->registrarResultado(lectura, exito);
+    }
+
+    // ======================
+    // ETAPA DE MUESTREO
+    // ======================
+    void hiloMuestreo(unsigned m) {
+        ContadoresPipeline& contadores = metricas.pipeline[PIPELINE_MUESTREO];
+
+        // Las estaciones del bloque, agrupadas por el paso en que leen
+        // dentro de cada INTERVALO_LECTURA: cada paso solo recorre las suyas
+        unsigned long fases = max(1UL, INTERVALO_LECTURA / config.pasoMs);
+        unsigned long paso = INTERVALO_LECTURA / fases;
+        vector<vector<Destino>> porFase(fases);
+        size_t primera = inicioBloque(m, nMuestreo);
+        size_t ultima = inicioBloque(m + 1, nMuestreo);
+        for (unsigned a = 0; a < nAnalitica; a++) {
+            ColaSPSC<MuestraPipeline>* destino = colasAnalitica[m * nAnalitica + a].get();
+            size_t desde = max(primera, inicioBloque(a, nAnalitica));
+            size_t hasta = min(ultima, inicioBloque(a + 1, nAnalitica));
+            for (size_t i = desde; i < hasta; i++) {
+                unsigned long fase = primerVencimiento(estaciones[i].desfase, INTERVALO_LECTURA);
+                unsigned long primeraLectura = (fase + paso - 1) / paso * paso;
+                porFase[primeraLectura / paso % fases].push_back({(uint32_t)i, primeraLectura, destino});
+            }
+        }
+
+        ParcialFlota parcial;
+        unsigned long k = 0;
+        for (unsigned long ahora = 0; config.duracionMs == 0 || ahora < config.duracionMs; ahora += paso, k++) {
+            if (!config.relojVirtual) {
+                long resto = (long)(inicio + ahora - millis());
+                if (resto > 0) delay(resto);
+            }
+
+            auto t0 = chrono::steady_clock::now();
+            uint64_t bloqueado = 0;
+            size_t encoladas = 0;
+            for (const Destino& d : porFase[k % fases]) {
+                if (ahora < d.primera) continue;   // su primer periodo aun no se cumplio
+                MuestraPipeline muestra;
+                muestra.estacion = d.estacion;
+                parcial.lecturas++;
+                if (!estaciones[d.estacion].muestrear(muestra.datos)) {
+                    parcial.descartadas++;
+                    continue;
+                }
+                muestra.datos.timestamp = ahora;
+                bloqueado += encolar(*d.cola, muestra, contadores);
+                encoladas++;
+            }
+            parcial.volcar(stats);
+            contadores.sumar(encoladas, microsegundosDesde(t0));
+            contadores.bloqueadoUs.fetch_add(bloqueado, memory_order_relaxed);
+            progreso[m].ms.store(ahora + paso, memory_order_release);
+        }
+        muestreoActivos.fetch_sub(1, memory_order_release);
+    }
+
+    // ======================
+    // ETAPA DE ANALITICA
+    // ======================
+    // Filtrado y decision de envio de la estacion que SimuladorFlota habria
+    // ejecutado antes de limite, cada uno en su paso y en el orden de
+    // Estacion::tick() (a igual instante: lectura, filtrado, envio). Lo de
+    // cada instante se anota como un tick propio o, con enCurso, en el de
+    // la muestra que se esta analizando. Devuelve los microsegundos
+    // bloqueado en la cola de envio
+    uint64_t ejecutarVencidas(uint32_t id, Agenda& agenda, unsigned long limite, ResultadoTick* enCurso,
+                              ColaMPSC<EnvioPipeline>& salida, ParcialFlota& parcial,
+                              ContadoresPipeline& contadores) {
+        Estacion& estacion = estaciones[id];
+        uint64_t bloqueado = 0;
+        while (true) {
+            unsigned long filtrado = enPaso(agenda.filtrado);
+            unsigned long envio = enPaso(agenda.envio);
+            unsigned long instante = min(filtrado, envio);
+            if (instante >= limite) break;
+
+            ResultadoTick propio;
+            ResultadoTick& r = enCurso ? *enCurso : propio;
+            if (filtrado == instante) {
+                r.alerta = estacion.filtrarDatos();
+                agenda.filtrado += INTERVALO_FILTRADO;
+            }
+            if (envio == instante) {
+                agenda.envio += INTERVALO_ENVIO;
+                if (estacion.decidirEnvio(instante, r)) {
+                    unsigned long long marca = usandoRelojVirtual() ? relojVirtual.epocaMs + instante
+                                                                    : getUnixTimestampMillis();
+                    EnvioPipeline e = {id, marca, estacion.datosFiltrados.temperatura,
+                                       estacion.datosFiltrados.humedad, estacion.datosFiltrados.presion, r.alerta};
+                    bloqueado += encolar(salida, e, contadores);
+                }
+            }
+            if (!enCurso) parcial.registrar(propio);
+        }
+        return bloqueado;
+    }
+
+    // Una muestra: primero lo que vencio en pasos anteriores (la muestra
+    // no llega a esos filtrados), luego al filtro y lo que vence en su
+    // mismo paso. Devuelve los microsegundos bloqueado en la cola de envio
+    uint64_t analizar(const MuestraPipeline& muestra, Agenda& agenda, ColaMPSC<EnvioPipeline>& salida,
+                      ParcialFlota& parcial, ContadoresPipeline& contadores) {
+        unsigned long ahora = muestra.datos.timestamp;
+        uint64_t bloqueado = ejecutarVencidas(muestra.estacion, agenda, ahora, nullptr, salida, parcial, contadores);
+        ResultadoTick r;
+        r.atipica = estaciones[muestra.estacion].incorporar(muestra.datos);
+        bloqueado += ejecutarVencidas(muestra.estacion, agenda, ahora + 1, &r, salida, parcial, contadores);
+        parcial.registrar(r);
+        return bloqueado;
+    }
+
+    void hiloAnalitica(unsigned a) {
+        ContadoresPipeline& contadores = metricas.pipeline[PIPELINE_ANALITICA];
+        size_t primera = inicioBloque(a, nAnalitica);
+        size_t ultima = inicioBloque(a + 1, nAnalitica);
+        vector<Agenda> agenda(ultima - primera);
+        for (size_t i = primera; i < ultima; i++) {
+            agenda[i - primera] = {primerVencimiento(estaciones[i].desfase, INTERVALO_FILTRADO),
+                                   primerVencimiento(estaciones[i].desfase, INTERVALO_ENVIO)};
+        }
+        ColaMPSC<EnvioPipeline>& salida = *colasEnvio[a % nEnvio];
+
+        ParcialFlota parcial;
+        MuestraPipeline muestra;
+        unsigned vueltas = 0;
+        while (true) {
+            // Se mira antes de vaciar: si el muestreo ya habia terminado y
+            // no queda nada, no puede llegar nada mas
+            bool fin = muestreoActivos.load(memory_order_acquire) == 0;
+            auto t0 = chrono::steady_clock::now();
+            uint64_t bloqueado = 0;
+            size_t procesadas = 0;
+            for (unsigned m = 0; m < nMuestreo; m++) {
+                ColaSPSC<MuestraPipeline>& entrada = *colasAnalitica[m * nAnalitica + a];
+                for (size_t k = 0; k < TANDA && entrada.intentarDesencolar(muestra); k++) {
+                    bloqueado += analizar(muestra, agenda[muestra.estacion - primera], salida, parcial, contadores);
+                    procesadas++;
+                }
+            }
+            if (procesadas > 0) {
+                parcial.volcar(stats);
+                contadores.sumar(procesadas, microsegundosDesde(t0));
+                contadores.bloqueadoUs.fetch_add(bloqueado, memory_order_relaxed);
+                vueltas = 0;
+                continue;
+            }
+            if (fin) break;
+            esperarTrabajo(vueltas);
+        }
+        // Lo que vence despues de la ultima lectura y antes del final
+        if (config.duracionMs > 0) {
+            for (size_t i = primera; i < ultima; i++) {
+                ejecutarVencidas((uint32_t)i, agenda[i - primera], config.duracionMs, nullptr, salida, parcial,
+                                 contadores);
+            }
+            parcial.volcar(stats);
+        }
+        analiticaActivos.fetch_sub(1, memory_order_release);
+    }
+
+    // ======================
+    // ETAPA DE ENVIO
+    // ======================
+    void subir(const EnvioPipeline& envio, HttpClientBackend* backend, LoteEnvios* lote) {
+        if (!backend) return;   // --sin-envio: la etapa solo cuenta
+        LecturaLote lectura = {estaciones[envio.estacion].sensorId, envio.marca, envio.temperatura,
+                               envio.humedad, envio.presion, envio.alerta};
+        if (lote) {
+            lote->agregar(lectura);
+            return;
+        }
+        if (backend->esAsync()) {
+            backend->sendDataAsync(lectura, [this, lectura](bool exito) { registrarResultado(lectura, exito); });
+            return;
+        }
+        bool exito = backend->sendData(lectura.sensorId, roundToTwoDecimals(lectura.temperatura),
+                                       roundToTwoDecimals(lectura.humedad), roundToTwoDecimals(lectura.presion),
+                                       lectura.alerta);
+        registrarResultado(lectura, exito);
+    }
+
+    void hiloEnvio(unsigned e) {
+        ContadoresPipeline& contadores = metricas.pipeline[PIPELINE_ENVIO];
+        ColaMPSC<EnvioPipeline>& entrada = *colasEnvio[e];
+        HttpClientBackend* backend = backends.empty() ? nullptr : backends[e].get();
+        LoteEnvios* lote = lotes.empty() ? nullptr : lotes[e].get();
+        TransporteAsync* transporte = transportes.empty() ? nullptr : transportes[e].get();
+
+        EnvioPipeline envio;
+        unsigned vueltas = 0;
+        while (true) {
+            bool fin = analiticaActivos.load(memory_order_acquire) == 0;
+            auto t0 = chrono::steady_clock::now();
+            size_t subidas = 0;
+            while (subidas < TANDA && entrada.intentarDesencolar(envio)) {
+                subir(envio, backend, lote);
+                subidas++;
+            }
+            // Tras cada tanda: lote vencido por latencia y reintentos de la
+            // cola persistente
+            if (lote) lote->revisar();
+            if (reenvio && backend && e == 0) reenvio->revisar(*backend);
+            // Con envios en vuelo la etapa sigue ocupada: en lugar de dormir
+            // atiende la red (como mucho 1 ms si no llego nada nuevo)
+            bool enVuelo = transporte && !transporte->ocioso();
+            if (enVuelo) transporte->procesar(subidas > 0 ? 0 : 1);
+            if (subidas > 0 || enVuelo) {
+                contadores.sumar(subidas, microsegundosDesde(t0));
+                vueltas = 0;
+                continue;
+            }
+            if (fin) break;
+            esperarTrabajo(vueltas);
+        }
+
+        // Lo pendiente al terminar: el ultimo lote y lo que siga en vuelo
+        if (lote) lote->enviar();
+        if (transporte) {
+            unsigned long limite = millis() + 15000;
+            while (!transporte->ocioso() && (long)(limite - millis()) > 0) transporte->procesar(100);
+        }
+        envioActivos.fetch_sub(1, memory_order_release);
+    }
+
+    // ======================
+    // HILO PRINCIPAL: MONITOR
+    // ======================
+    // Tiempo simulado que ya muestrearon todos los hilos de muestreo
+    unsigned long tiempoMuestreado() const {
+        unsigned long t = progreso[0].ms.load(memory_order_acquire);
+        for (unsigned m = 1; m < nMuestreo; m++) t = min(t, progreso[m].ms.load(memory_order_acquire));
+        return t;
+    }
+
+    void medirColas() {
+        size_t profundidad[NUM_ETAPAS_PIPELINE] = {0, 0, 0};
+        for (const auto& c : colasAnalitica) profundidad[PIPELINE_ANALITICA] += c->size();
+        for (const auto& c : colasEnvio) profundidad[PIPELINE_ENVIO] += c->size();
+        for (int e = 0; e < NUM_ETAPAS_PIPELINE; e++) {
+            ContadoresPipeline& contadores = metricas.pipeline[e];
+            contadores.profundidad.store(profundidad[e], memory_order_relaxed);
+            if (profundidad[e] > contadores.profundidadMax.load(memory_order_relaxed)) {
+                contadores.profundidadMax.store(profundidad[e], memory_order_relaxed);
+            }
+        }
+    }
+
+    // Igual que SimuladorFlota::puntuarEstado(); solo con los hilos
+    // parados, porque lee el ultimo filtrado de cada estacion
+    void puntuarEstado(unsigned long (&niveles)[3]) {
+        estado.resize(estaciones.size());
+        size_t n = 0;
+        for (const auto& estacion : estaciones) {
+            if (estacion.datosFiltrados.humedad <= 0) continue;
+            estado.temperatura[n] = estacion.datosFiltrados.temperatura;
+            estado.humedad[n] = estacion.datosFiltrados.humedad;
+            estado.presion[n] = estacion.datosFiltrados.presion;
+            estado.tendenciaHumedad[n] = estacion.tendenciaHumedad;
+            estado.tendenciaPresion[n] = estacion.tendenciaPresion;
+            n++;
+        }
+        estado.resize(n);
+        estado.puntuar();
+        for (int32_t nivel : estado.nivel) niveles[nivel]++;
+    }
+
+    void imprimirResumen(unsigned long ahora, bool conEstado) {
+        cout << "FLOTA t=" << ahora / 1000 << "s"
+             << " estaciones=" << estaciones.size()
+             << " lecturas=" << stats.lecturas
+             << " descartadas=" << stats.descartadas
+             << " envios=" << stats.envios
+             << " fallidos=" << stats.enviosFallidos;
+        if (config.reportePorBanda) {
+            cout << " reportadas=" << stats.reportadas
+                 << " suprimidas=" << stats.suprimidas;
+        }
+        if (config.filtro == FILTRO_HAMPEL) cout << " atipicas=" << stats.atipicas;
+        if (config.enviar) cout << " conexiones=" << metricas.conexiones;
+        if (reenvio) {
+            cout << " pendientes=" << cola.size()
+                 << " reenviadas=" << reenvio->totalReenviadas()
+                 << " rechazadas=" << reenvio->totalRechazadas();
+        }
+        cout << " alertas[N/A/R]=" << stats.alertas[0] << "/"
+             << stats.alertas[1] << "/" << stats.alertas[2];
+        if (conEstado) {
+            unsigned long niveles[3] = {0, 0, 0};
+            puntuarEstado(niveles);
+            cout << " estado[N/A/R]=" << niveles[0] << "/" << niveles[1] << "/" << niveles[2];
+        }
+        cout << "\n";
+
+        cout << "PIPELINE";
+        for (int e = 0; e < NUM_ETAPAS_PIPELINE; e++) {
+            const ContadoresPipeline& c = metricas.pipeline[e];
+            cout << " " << NOMBRES_ETAPA_PIPELINE[e] << "=" << c.procesados.load(memory_order_relaxed);
+        }
+        cout << " colas[A/E]=" << metricas.pipeline[PIPELINE_ANALITICA].profundidad << "/"
+             << metricas.pipeline[PIPELINE_ENVIO].profundidad
+             << " llenas[M/A]=" << metricas.pipeline[PIPELINE_MUESTREO].colaLlena << "/"
+             << metricas.pipeline[PIPELINE_ANALITICA].colaLlena << "\n";
+        cout.flush();
+    }
+
+    // Ocupacion util: fraccion del tiempo real en que los hilos de la etapa
+    // trabajaron sin estar bloqueados por la siguiente. La mas alta es el
+    // cuello de botella
+    void imprimirEtapas(double segundosReales) {
+        char linea[160];
+        cout << "ETAPA      hilos  procesados     por_s  ocupacion  bloqueo  cola_max/capacidad  llenas\n";
+        int cuello = 0;
+        double maxOcupacion = -1;
+        for (int e = 0; e < NUM_ETAPAS_PIPELINE; e++) {
+            const ContadoresPipeline& c = metricas.pipeline[e];
+            double disponibleUs = segundosReales * 1e6 * c.hilos.load();
+            double ocupado = c.ocupadoUs.load() / disponibleUs;
+            double bloqueo = c.bloqueadoUs.load() / disponibleUs;
+            if (ocupado - bloqueo > maxOcupacion) {
+                maxOcupacion = ocupado - bloqueo;
+                cuello = e;
+            }
+            char cola[32] = "-";
+            if (e != PIPELINE_MUESTREO) {
+                snprintf(cola, sizeof(cola), "%llu/%llu", (unsigned long long)c.profundidadMax.load(),
+                         (unsigned long long)c.capacidad.load());
+            }
+            snprintf(linea, sizeof(linea), "%-10s %5u %11llu %9.0f %9.1f%% %7.1f%% %19s %7llu\n",
+                     NOMBRES_ETAPA_PIPELINE[e], c.hilos.load(), (unsigned long long)c.procesados.load(),
+                     c.procesados.load() / segundosReales, 100 * (ocupado - bloqueo), 100 * bloqueo, cola,
+                     (unsigned long long)c.colaLlena.load());
+            cout << linea;
+        }
+        cout << "Cuello de botella: " << NOMBRES_ETAPA_PIPELINE[cuello]
+             << " (ocupacion util " << (int)(100 * maxOcupacion + 0.5) << "%)\n";
+    }
+
+public:
+    explicit SimuladorPipeline(const ConfigFlota& cfg) : config(cfg), conexiones(cfg.conexiones) {
+        unsigned nucleos = max(1u, thread::hardware_concurrency());
+        nMuestreo = max(1u, config.hilosMuestreo);
+        nEnvio = max(1u, config.hilosEnvio);
+        nAnalitica = config.hilosAnalitica > 0 ? config.hilosAnalitica
+                                               : max(1u, nucleos > nMuestreo + nEnvio ? nucleos - nMuestreo - nEnvio : 1u);
+
+        if (config.enviar && !config.rutaCola.empty() &&
+            cola.abrir(config.rutaCola, config.capacidadCola)) {
+            reenvio.reset(new ReenvioPendientes(cola));
+        }
+
+        // Mismas estaciones (ids, semillas y desfases) que SimuladorFlota
+        estaciones.reserve(config.estaciones);
+        minstd_rand generador(config.semilla);
+        for (int i = 0; i < config.estaciones; i++) {
+            char id[32];
+            snprintf(id, sizeof(id), "SIM_FLOTA_%05d", i + 1);
+            estaciones.emplace_back(id, generador(), generador() % INTERVALO_ENVIO);
+            estaciones.back().configurarReporte(config.reportePorBanda, config.bandas);
+            estaciones.back().configurarFiltro(config.filtro, config.motor);
+        }
+
+        if (config.enviar) {
+            for (unsigned i = 0; i < nEnvio; i++) {
+                backends.emplace_back(new HttpClientBackend());
+                backends.back()->begin(&conexiones);
+                backends.back()->usarFormatoBinario(config.formatoBinario);
+                if (config.maxEnVuelo > 0) {
+                    transportes.emplace_back(new TransporteAsync(config.maxEnVuelo, 1024, &conexiones));
+                    backends.back()->usarTransporte(transportes.back().get());
+                }
+                if (config.usarLote) {
+                    lotes.emplace_back(new LoteEnvios(*backends.back(), config.lote,
+                        [this](const LecturaLote& lectura, bool exito) { registrarResultado(lectura, exito); }));
+                }
+            }
+        }
+
+        for (unsigned i = 0; i < nMuestreo * nAnalitica; i++) {
+            colasAnalitica.emplace_back(new ColaSPSC<MuestraPipeline>(config.capacidadEtapa));
+        }
+        for (unsigned i = 0; i < nEnvio; i++) {
+            colasEnvio.emplace_back(new ColaMPSC<EnvioPipeline>(config.capacidadEtapa));
+        }
+        progreso.reset(new Progreso[nMuestreo]);
+
+        const unsigned hilos[NUM_ETAPAS_PIPELINE] = {nMuestreo, nAnalitica, nEnvio};
+        const size_t capacidad[NUM_ETAPAS_PIPELINE] = {
+            0, colasAnalitica.size() * colasAnalitica[0]->capacidad(), colasEnvio.size() * colasEnvio[0]->capacidad()};
+        for (int e = 0; e < NUM_ETAPAS_PIPELINE; e++) {
+            metricas.pipeline[e].hilos = hilos[e];
+            metricas.pipeline[e].capacidad = capacidad[e];
+        }
+    }
+
+    const EstadisticasFlota& estadisticas() const { return stats; }
+
+    void ejecutar() {
+        cout << "====================================\n"
+             << "MODO FLOTA EN PIPELINE: " << estaciones.size() << " estaciones, hilos muestreo/analitica/envio "
+             << nMuestreo << "/" << nAnalitica << "/" << nEnvio
+             << (config.enviar ? "" : " (sin envio)")
+             << (config.enviar && config.usarLote ? " (envio en lotes)" : "")
+             << (config.enviar && config.maxEnVuelo > 0 ? " (asincrono)" : "")
+             << (config.relojVirtual ? " (reloj virtual)" : "") << "\n"
+             << "====================================\n";
+
+        auto inicioReal = chrono::steady_clock::now();
+        inicio = millis();
+        muestreoActivos = nMuestreo;
+        analiticaActivos = nAnalitica;
+        envioActivos = nEnvio;
+
+        vector<thread> hilos;
+        for (unsigned e = 0; e < nEnvio; e++) hilos.emplace_back([this, e] { hiloEnvio(e); });
+        for (unsigned a = 0; a < nAnalitica; a++) hilos.emplace_back([this, a] { hiloAnalitica(a); });
+        for (unsigned m = 0; m < nMuestreo; m++) hilos.emplace_back([this, m] { hiloMuestreo(m); });
+
+        // El reloj global (lotes, cola persistente) sigue al muestreo: con
+        // reloj virtual avanza hasta lo que ya muestrearon todos los hilos
+        unsigned long ultimoResumen = 0;
+        unsigned long ultimasMetricas = 0;
+        while (envioActivos.load(memory_order_acquire) > 0) {
+            this_thread::sleep_for(chrono::milliseconds(10));
+            unsigned long ahora = tiempoMuestreado();
+            if (config.relojVirtual) avanzarRelojHasta(inicio + ahora);
+            medirColas();
+            if (ahora - ultimoResumen >= config.intervaloResumenMs) {
+                ultimoResumen = ahora;
+                imprimirResumen(ahora, false);
+            }
+            if (!config.rutaMetricas.empty() && ahora - ultimasMetricas >= config.intervaloMetricasMs) {
+                ultimasMetricas = ahora;
+                metricas.escribir(config.rutaMetricas, ahora);
+            }
+        }
+        for (auto& hilo : hilos) hilo.join();
+
+        double real = chrono::duration<double>(chrono::steady_clock::now() - inicioReal).count();
+        unsigned long simulado = tiempoMuestreado();
+        if (config.duracionMs > 0) simulado = min(simulado, config.duracionMs);
+        medirColas();
+        imprimirResumen(simulado, true);
+        imprimirEtapas(real);
+        if (!config.rutaMetricas.empty()) metricas.escribir(config.rutaMetricas, simulado);
+        if (config.relojVirtual) {
+            cout << "Simulados " << simulado / 1000 << "s en " << real << "s reales\n";
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,296 @@
+#ifndef GENERADOR_CARGA_H
+#define GENERADOR_CARGA_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "arduino_nativo.h"
+#include "config_nativo.h"
+#include "conexiones_http.h"
+#include "http_backend_nativo.h"
+#include "flota.h"
+
+using namespace std;
+
+// ======================
+// GENERADOR DE CARGA DEL ENVIO
+// ======================
+// simulador_native --carga [--hilos N] [--duracion SEG] [--solicitudes N]
+//                  [--ritmo SOL_S] [--lote N] [--formato json|binario]
+//                  [--reintentos N] [--espera-reintento MS] [--conexiones N]
+// Castiga API_URL con el mismo HttpClientBackend del simulador, sin
+// sensores ni filtro: cada hilo es una conexion (su propio handle curl con
+// keep-alive) que envia lecturas sueltas (sendData) o lotes (sendBatch).
+// Pensado contra servidor_mock/, que simula latencia, errores y cortes.
+// - Sin --ritmo cada hilo envia en cuanto llega la respuesta (carga
+//   cerrada). Con --ritmo las solicitudes se programan a intervalos fijos
+//   y la latencia se mide desde el instante programado: si el backend se
+//   atrasa, la espera acumulada cuenta (sin omision coordinada)
+// - Una solicitud fallida (transporte, codigo no 2xx o lecturas
+//   rechazadas del lote) se reintenta hasta --reintentos veces, con espera
+//   que se duplica en cada intento, solo con las lecturas que fallaron
+// - Si el backend corta una conexion reutilizada, curl reenvia el POST por
+//   otra nueva sin avisar y la solicitud sale bien: esos cortes no llegan
+//   a fallos de transporte. Como el backend no cierra por su cuenta las
+//   conexiones keep-alive, cada conexion abierta tras la primera de un
+//   hilo es un corte; se informan como reconexiones (CURLINFO_NUM_CONNECTS)
+struct ConfigCarga {
+    unsigned hilos = 0;                    // 0 = uno por nucleo
+    unsigned long duracionMs = 0;          // 0 y sin solicitudes = 10 s
+    unsigned long long solicitudes = 0;    // 0 = hasta duracionMs
+    double ritmo = 0;                      // solicitudes/s entre todos; 0 = carga cerrada
+    size_t lecturasPorSolicitud = 1;       // >1: lotes con sendBatch
+    unsigned reintentos = 0;
+    unsigned long esperaReintentoMs = 100;
+    bool formatoBinario = false;
+    ConfigConexiones conexiones;
+    unsigned semilla = 1;
+
+    // Lo comun con la flota (--hilos, --duracion, --lote, --formato,
+    // --conexiones, --semilla) ya viene leido en ConfigFlota
+    explicit ConfigCarga(const ConfigFlota& flota)
+        : hilos(flota.hilos), duracionMs(flota.duracionMs),
+          lecturasPorSolicitud(flota.usarLote ? max<size_t>(1, flota.lote.maxLecturas) : 1),
+          formatoBinario(flota.formatoBinario), conexiones(flota.conexiones), semilla(flota.semilla) {}
+};
+
+inline void leerOpcionesCarga(int argc, char* argv[], ConfigCarga& config) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hayValor = i + 1 < argc;
+        if (arg == "--solicitudes" && hayValor) {
+            config.solicitudes = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--ritmo" && hayValor) {
+            config.ritmo = atof(argv[++i]);
+        } else if (arg == "--reintentos" && hayValor) {
+            config.reintentos = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--espera-reintento" && hayValor) {
+            config.esperaReintentoMs = strtoul(argv[++i], nullptr, 10);
+        }
+    }
+}
+
+class GeneradorCarga {
+private:
+    // Lo que cuenta cada hilo; se junta al terminar
+    struct ResultadoHilo {
+        vector<uint32_t> latenciasUs;      // de cada primer intento
+        unsigned long long solicitudes = 0;
+        unsigned long long posts = 0;      // primeros intentos + reintentos
+        unsigned long long lecturasOk = 0;
+        unsigned long long lecturasFallidas = 0;   // en el primer intento
+        unsigned long long fallosTransporte = 0;
+        unsigned long long conexiones = 0;
+        unsigned long long reconexiones = 0;   // conexiones tras la primera
+        unsigned long long reintentos = 0;
+        unsigned long long recuperadas = 0;
+        unsigned long long perdidas = 0;
+        map<long, unsigned long long> codigos;
+    };
+
+    ConfigCarga config;
+    ConexionesHttp conexiones;
+    vector<ResultadoHilo> resultados;
+    atomic<unsigned long long> reservadas{0};
+    atomic<unsigned long long> posts{0};     // para el progreso por segundo
+    chrono::steady_clock::time_point inicio;
+    chrono::steady_clock::time_point fin;
+
+    static uint32_t microsegundos(chrono::steady_clock::duration d) {
+        long long us = chrono::duration_cast<chrono::microseconds>(d).count();
+        return (uint32_t)min<long long>(max<long long>(us, 0), UINT32_MAX);
+    }
+
+    // Un POST con las lecturas; deja el veredicto de cada una en ok
+    bool enviar(HttpClientBackend& backend, const vector<LecturaLote>& lecturas, vector<bool>& ok,
+                ResultadoHilo& r) {
+        bool exito;
+        if (config.lecturasPorSolicitud == 1) {
+            const LecturaLote& l = lecturas[0];
+            exito = backend.sendData(l.sensorId, l.temperatura, l.humedad, l.presion, l.alerta);
+            ok.assign(1, exito);
+        } else {
+            exito = backend.sendBatch(backend.componerLote(lecturas), lecturas.size(), ok);
+        }
+        r.posts++;
+        posts.fetch_add(1, memory_order_relaxed);
+        r.conexiones += backend.conexionesUltimoPost();
+        long codigo = backend.ultimoCodigoHttp();
+        if (codigo == 0) r.fallosTransporte++;
+        else r.codigos[codigo]++;
+        return exito;
+    }
+
+    void hilo(unsigned h) {
+        ResultadoHilo& r = resultados[h];
+        HttpClientBackend backend;
+        backend.begin(&conexiones);
+        backend.usarFormatoBinario(config.formatoBinario);
+
+        minstd_rand generador(config.semilla + h);
+        char id[32];
+        snprintf(id, sizeof(id), "CARGA_%03u", h + 1);
+        vector<LecturaLote> lecturas(config.lecturasPorSolicitud);
+        vector<LecturaLote> fallidas;
+        vector<bool> ok;
+
+        // Con ritmo, cada hilo lleva su parte y arranca desfasado para no
+        // disparar todos a la vez
+        unsigned hilos = (unsigned)resultados.size();
+        chrono::duration<double, micro> intervalo(config.ritmo > 0 ? 1e6 * hilos / config.ritmo : 0);
+        for (unsigned long long k = 0;; k++) {
+            if (config.solicitudes > 0 && reservadas.fetch_add(1, memory_order_relaxed) >= config.solicitudes) break;
+            auto programado = chrono::steady_clock::now();
+            if (config.ritmo > 0) {
+                programado = inicio + chrono::duration_cast<chrono::steady_clock::duration>(
+                                          intervalo * (k + (double)h / hilos));
+                if (programado >= fin) break;
+                this_thread::sleep_until(programado);
+            } else if (programado >= fin) {
+                break;
+            }
+
+            for (LecturaLote& l : lecturas) {
+                l = {id, getUnixTimestampMillis(), 20.0f + generador() % 1500 / 100.0f,
+                     40.0f + generador() % 6000 / 100.0f, 1000.0f + generador() % 3000 / 100.0f,
+                     (int)(generador() % 3)};
+            }
+            enviar(backend, lecturas, ok, r);
+            r.latenciasUs.push_back(microsegundos(chrono::steady_clock::now() - programado));
+            r.solicitudes++;
+
+            fallidas.clear();
+            for (size_t i = 0; i < lecturas.size(); i++) {
+                if (ok[i]) r.lecturasOk++;
+                else fallidas.push_back(lecturas[i]);
+            }
+            r.lecturasFallidas += fallidas.size();
+
+            // Reintentos solo con lo que fallo, con espera exponencial
+            unsigned long espera = config.esperaReintentoMs;
+            for (unsigned intento = 0; intento < config.reintentos && !fallidas.empty(); intento++) {
+                this_thread::sleep_for(chrono::milliseconds(espera));
+                espera *= 2;
+                r.reintentos++;
+                enviar(backend, fallidas, ok, r);
+                size_t quedan = 0;
+                for (size_t i = 0; i < fallidas.size(); i++) {
+                    if (ok[i]) r.recuperadas++;
+                    else fallidas[quedan++] = fallidas[i];
+                }
+                fallidas.resize(quedan);
+            }
+            r.perdidas += fallidas.size();
+        }
+        r.reconexiones = r.conexiones > 0 ? r.conexiones - 1 : 0;
+    }
+
+    static double percentil(const vector<uint32_t>& ordenadas, double p) {
+        if (ordenadas.empty()) return 0;
+        size_t i = (size_t)(p * (ordenadas.size() - 1) + 0.5);
+        return ordenadas[i] / 1000.0;
+    }
+
+    void imprimirResultado(double segundos) {
+        ResultadoHilo total;
+        for (ResultadoHilo& r : resultados) {
+            total.latenciasUs.insert(total.latenciasUs.end(), r.latenciasUs.begin(), r.latenciasUs.end());
+            total.solicitudes += r.solicitudes;
+            total.posts += r.posts;
+            total.lecturasOk += r.lecturasOk;
+            total.lecturasFallidas += r.lecturasFallidas;
+            total.fallosTransporte += r.fallosTransporte;
+            total.reconexiones += r.reconexiones;
+            total.reintentos += r.reintentos;
+            total.recuperadas += r.recuperadas;
+            total.perdidas += r.perdidas;
+            for (const auto& c : r.codigos) total.codigos[c.first] += c.second;
+        }
+        sort(total.latenciasUs.begin(), total.latenciasUs.end());
+
+        char linea[256];
+        unsigned long long lecturas = total.solicitudes * config.lecturasPorSolicitud;
+        snprintf(linea, sizeof(linea),
+                 "RESULTADO %.1fs solicitudes=%llu (%.0f/s) posts=%llu (%.0f/s) lecturas=%llu (%.0f/s) "
+                 "ok=%llu fallidas=%llu\n",
+                 segundos, total.solicitudes, total.solicitudes / segundos, total.posts, total.posts / segundos,
+                 lecturas, lecturas / segundos, total.lecturasOk, total.lecturasFallidas);
+        cout << linea;
+        snprintf(linea, sizeof(linea), "LATENCIA p50=%.2fms p90=%.2fms p99=%.2fms p99.9=%.2fms max=%.2fms%s\n",
+                 percentil(total.latenciasUs, 0.5), percentil(total.latenciasUs, 0.9),
+                 percentil(total.latenciasUs, 0.99), percentil(total.latenciasUs, 0.999),
+                 percentil(total.latenciasUs, 1.0), config.ritmo > 0 ? " (desde el instante programado)" : "");
+        cout << linea;
+        // Los cortes que curl tapo reenviando son las reconexiones que no
+        // vinieron de un fallo de transporte
+        cout << "ERRORES transporte=" << total.fallosTransporte << " reconexiones=" << total.reconexiones
+             << " (reenviadas por curl "
+             << (total.reconexiones > total.fallosTransporte ? total.reconexiones - total.fallosTransporte : 0)
+             << ") codigos";
+        for (const auto& c : total.codigos) cout << " " << c.first << ":" << c.second;
+        cout << "\n";
+        if (config.reintentos > 0 || total.perdidas > 0) {
+            cout << "REINTENTOS reintentos=" << total.reintentos << " recuperadas=" << total.recuperadas
+                 << " perdidas=" << total.perdidas << "\n";
+        }
+        cout.flush();
+    }
+
+public:
+    explicit GeneradorCarga(const ConfigCarga& cfg) : config(cfg), conexiones(cfg.conexiones) {
+        if (config.hilos == 0) config.hilos = max(1u, thread::hardware_concurrency());
+        if (config.duracionMs == 0 && config.solicitudes == 0) config.duracionMs = 10000;
+    }
+
+    void ejecutar() {
+        cout << "====================================\n"
+             << "PRUEBA DE CARGA: " << API_URL << ", " << config.hilos << " hilos, "
+             << config.lecturasPorSolicitud << " lecturas por solicitud"
+             << (config.formatoBinario ? " (binario)" : "");
+        if (config.ritmo > 0) cout << ", ritmo " << config.ritmo << "/s";
+        if (config.reintentos > 0) cout << ", " << config.reintentos << " reintentos";
+        cout << "\n====================================" << endl;
+
+        resultados.assign(config.hilos, ResultadoHilo());
+        inicio = chrono::steady_clock::now();
+        fin = config.duracionMs > 0 ? inicio + chrono::milliseconds(config.duracionMs)
+                                    : chrono::steady_clock::time_point::max();
+        vector<thread> hilos;
+        atomic<unsigned> activos{config.hilos};
+        for (unsigned h = 0; h < config.hilos; h++) {
+            hilos.emplace_back([this, h, &activos] {
+                hilo(h);
+                activos--;
+            });
+        }
+
+        // Progreso cada segundo mientras queden hilos
+        auto ultimo = inicio;
+        unsigned long long postsAntes = 0;
+        while (activos > 0) {
+            this_thread::sleep_for(chrono::milliseconds(50));
+            auto ahora = chrono::steady_clock::now();
+            double intervalo = chrono::duration<double>(ahora - ultimo).count();
+            if (intervalo < 1.0) continue;
+            unsigned long long enviados = posts.load(memory_order_relaxed);
+            printf("t=%.0fs posts/s=%.0f total=%llu\n", chrono::duration<double>(ahora - inicio).count(),
+                   (enviados - postsAntes) / intervalo, enviados);
+            fflush(stdout);
+            postsAntes = enviados;
+            ultimo = ahora;
+        }
+        for (auto& h : hilos) h.join();
+        vaciarRegistro();
+        imprimirResultado(chrono::duration<double>(chrono::steady_clock::now() - inicio).count());
+    }
+};
+
+#endif
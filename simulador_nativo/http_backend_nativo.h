@@ -0,0 +1,381 @@
+#ifndef HTTP_BACKEND_NATIVO_H
+#define HTTP_BACKEND_NATIVO_H
+
+#include <mutex>
+#include <vector>
+#include <functional>
+#include <curl/curl.h>
+#include <json/json.h>
+#include "arduino_nativo.h"
+#include "registro_nativo.h"
+#include "config_nativo.h"
+#include "metricas_nativo.h"
+#include "conexiones_http.h"
+#include "transporte_async.h"
+#include "../src/escritor_json.h"
+#include "../src/formato_binario.h"
+
+// ======================
+// FUNCIÓN DE CALLBACK PARA CURL
+// ======================
+inline size_t WriteCallback(void* contents, size_t size, size_t nmemb, string* response) {
+    size_t totalSize = size * nmemb;
+    response->append((char*)contents, totalSize);
+    return totalSize;
+}
+
+// ======================
+// LECTURA PARA ENVIO EN LOTE
+// ======================
+struct LecturaLote {
+    string sensorId;
+    unsigned long long timestamp;   // UNIX en milisegundos
+    float temperatura;
+    float humedad;
+    float presion;
+    int alerta;
+};
+
+// ======================
+// CLASE HttpClientBackend CORREGIDA
+// ======================
+class HttpClientBackend {
+public:
+    // Una lectura serializada (JSON o trama binaria) siempre cabe aqui
+    // salvo con ids de mas de ~300 caracteres, que se rechazan
+    static const size_t TAM_MAX_LECTURA = 512;
+
+private:
+    CURL* curl = nullptr;
+    // Cabeceras fijas: se crean una vez en begin() y no en cada POST
+    curl_slist* headersJson = nullptr;
+    curl_slist* headersBinario = nullptr;
+    // Buffers reutilizados: tras el primer envio, enviar una lectura no
+    // pide memoria al heap
+    char bufferEnvio[TAM_MAX_LECTURA];
+    string cuerpoAsync;
+    string responseBuffer;
+    // Si se asigna, los envios *Async van por curl_multi sin bloquear
+    TransporteAsync* transporte = nullptr;
+    // Tramas de formato_binario.h en lugar de JSON (--formato binario)
+    bool binario = false;
+    // Codigo HTTP del ultimo POST sincrono; 0 si fallo el transporte
+    long ultimoCodigo = 0;
+    // Conexiones que abrio el ultimo POST sincrono, contando la que curl
+    // abre por su cuenta para reenviar si la reutilizada estaba muerta
+    long ultimasConexiones = 0;
+    
+public:
+    // El handle se conserva entre envios: con el, curl conserva la conexion
+    // abierta (keep-alive) y cada POST solo cambia el cuerpo y la cabecera
+    // de tipo. conexiones (opcional) aplica las opciones comunes de
+    // conexiones_http.h y debe vivir mas que el backend
+    void begin(const ConexionesHttp* conexiones = nullptr) {
+        // curl_global_init no es seguro entre hilos: en modo flota cada
+        // hilo trabajador tiene su propio backend, asi que se hace una vez
+        static once_flag curlIniciado;
+        call_once(curlIniciado, [] { curl_global_init(CURL_GLOBAL_DEFAULT); });
+
+        curl = curl_easy_init();
+        if (curl) {
+            headersJson = curl_slist_append(headersJson, "Content-Type: application/json");
+            headersJson = curl_slist_append(headersJson, ("X-API-Key: " + API_KEY).c_str());
+            headersBinario = curl_slist_append(headersBinario, "Content-Type: application/x-rainsense");
+            headersBinario = curl_slist_append(headersBinario, ("X-API-Key: " + API_KEY).c_str());
+
+            curl_easy_setopt(curl, CURLOPT_URL, API_URL.c_str());
+            curl_easy_setopt(curl, CURLOPT_POST, 1L);
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBuffer);
+            curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
+            if (conexiones) conexiones->configurar(curl);
+            LOG_INFO("HttpClientBackend inicializado (conexion real)");
+        } else {
+            LOG_ERROR("No se pudo inicializar CURL");
+        }
+    }
+    
+    ~HttpClientBackend() {
+        if (curl) {
+            curl_easy_cleanup(curl);
+        }
+        curl_slist_free_all(headersJson);
+        curl_slist_free_all(headersBinario);
+    }
+
+    bool sendData(float temperatura, float humedad, float presion, int alerta) {
+        return sendData("ARDUINO_TROPICAL_01", temperatura, humedad, presion, alerta);
+    }
+
+    bool sendData(const string& sensorId, float temperatura, float humedad, float presion, int alerta) {
+        if (!curl) {
+            LOG_ERROR("CURL no inicializado");
+            return false;
+        }
+        
+        // REDONDEAR VALORES A 2 DECIMALES
+        float temp_rounded = roundToTwoDecimals(temperatura);
+        float hum_rounded = roundToTwoDecimals(humedad);
+        float pres_rounded = roundToTwoDecimals(presion);
+        
+        // Lectura con valores redondeados y timestamp en MILISEGUNDOS
+        LecturaLote lectura = {sensorId, getUnixTimestampMillis(), temp_rounded, hum_rounded, pres_rounded, alerta};
+        size_t largo;
+        {
+            MedicionNativa m(metricas, ETAPA_SERIALIZACION);
+            largo = serializarLectura(lectura, bufferEnvio, sizeof(bufferEnvio));
+        }
+        if (largo == 0) {
+            LOG_ERROR("Lectura demasiado grande para serializar (%s)", sensorId.c_str());
+            metricas.contarEnvio(false);
+            return false;
+        }
+        
+        LOG_INFO("ENVIANDO A API REAL: %s", API_URL.c_str());
+        LOG_DEPURACION("TIMESTAMP (ms): %llu", lectura.timestamp);
+        LOG_DEPURACION("DATOS REDONDEADOS: T=%.2f°C, H=%.2f%%, P=%.2f hPa", temp_rounded, hum_rounded, pres_rounded);
+        
+        if (binario) {
+            LOG_DEPURACION("TRAMA BINARIA: %zu bytes", largo);
+        } else {
+            LOG_DEPURACION("JSON: %s", bufferEnvio);
+        }
+        
+        long http_code = 0;
+        if (!post(bufferEnvio, largo, http_code)) {
+            metricas.contarEnvio(false);
+            return false;
+        }
+        
+        if (http_code >= 200 && http_code < 300) {
+            LOG_DEPURACION("Datos enviados correctamente al backend");
+            metricas.contarEnvio(true);
+            return true;
+        } else {
+            LOG_AVISO("Error en respuesta del servidor");
+            metricas.contarEnvio(false);
+            return false;
+        }
+    }
+
+    // Envia un lote como un unico array JSON y devuelve el resultado de
+    // cada lectura. Si el backend responde con un array (o con un objeto
+    // {"resultados": [...]}) del mismo tamano, se usa su veredicto por
+    // elemento (bool u objeto con "ok"); si no, todo el lote comparte el
+    // codigo HTTP. Devuelve si el POST llego (respuesta 2xx), aunque el
+    // backend haya rechazado lecturas sueltas.
+    bool sendBatch(const string& cuerpo, size_t cantidad, vector<bool>& resultados) {
+        resultados.assign(cantidad, false);
+        if (!curl) {
+            LOG_ERROR("CURL no inicializado");
+            return false;
+        }
+
+        LOG_INFO("ENVIANDO LOTE A API REAL: %zu lecturas, %zu bytes", cantidad, cuerpo.size());
+
+        long http_code = 0;
+        bool exito = post(cuerpo.data(), cuerpo.size(), http_code) &&
+                     interpretarRespuestaLote(http_code, responseBuffer, cantidad, resultados);
+        contarEnvios(resultados);
+        return exito;
+    }
+
+    void usarTransporte(TransporteAsync* transporteAsync) {
+        transporte = transporteAsync;
+    }
+
+    void usarFormatoBinario(bool activar) { binario = activar; }
+    bool formatoBinario() const { return binario; }
+    long ultimoCodigoHttp() const { return ultimoCodigo; }
+    long conexionesUltimoPost() const { return ultimasConexiones; }
+
+    // Una lectura en el formato activo (objeto JSON compacto o trama
+    // binaria) escrita en destino. Devuelve los bytes escritos, 0 si no cabe
+    size_t serializarLectura(const LecturaLote& lectura, char* destino, size_t capacidad) const {
+        if (!binario) return escribirLecturaJson(lectura, destino, capacidad);
+        return escribirLecturaBinaria(lectura, destino, capacidad);
+    }
+
+    // Cuerpo completo para varias lecturas: array JSON o tramas seguidas.
+    // Las que no se pueden serializar se omiten
+    string componerLote(const vector<LecturaLote>& lecturas) const {
+        MedicionNativa m(metricas, ETAPA_SERIALIZACION);
+        char item[TAM_MAX_LECTURA];
+        string cuerpo;
+        cuerpo.reserve(lecturas.size() * (binario ? 40 : 160) + 2);
+        if (!binario) cuerpo += '[';
+        for (const LecturaLote& lectura : lecturas) {
+            size_t largo = serializarLectura(lectura, item, sizeof(item));
+            if (largo == 0) continue;
+            if (!binario && cuerpo.size() > 1) cuerpo += ',';
+            cuerpo.append(item, largo);
+        }
+        if (!binario) cuerpo += ']';
+        return cuerpo;
+    }
+
+    static size_t escribirLecturaBinaria(const LecturaLote& lectura, char* destino, size_t capacidad) {
+        LecturaBinaria b = {lectura.timestamp, lectura.temperatura, lectura.humedad,
+                            lectura.presion, (uint8_t)lectura.alerta};
+        return codificarTramaBinaria(reinterpret_cast<uint8_t*>(destino), capacidad,
+                                     lectura.sensorId.c_str(), &b, 1);
+    }
+
+    static string lecturaABinario(const LecturaLote& lectura) {
+        char trama[TAM_CABECERA_TRAMA + 255 + TAM_REGISTRO_BINARIO];
+        return string(trama, escribirLecturaBinaria(lectura, trama, sizeof(trama)));
+    }
+
+    bool esAsync() const { return transporte != nullptr; }
+
+    // Como sendData(), pero solo encola el POST: el resultado llega por
+    // alTerminar cuando el bucle principal procesa el transporte
+    void sendDataAsync(const LecturaLote& lectura, function<void(bool)> alTerminar) {
+        size_t largo;
+        {
+            MedicionNativa m(metricas, ETAPA_SERIALIZACION);
+            largo = serializarLectura(lectura, bufferEnvio, sizeof(bufferEnvio));
+        }
+        if (largo == 0) {
+            LOG_ERROR("Lectura demasiado grande para serializar (%s)", lectura.sensorId.c_str());
+            metricas.contarEnvio(false);
+            alTerminar(false);
+            return;
+        }
+        cuerpoAsync.assign(bufferEnvio, largo);
+        transporte->enviar(cuerpoAsync,
+            [alTerminar](bool transporteOk, long http_code, const string& respuesta) {
+                if (!transporteOk) {
+                    LOG_ERROR("Envio HTTP: %s", respuesta.c_str());
+                }
+                bool exito = transporteOk && http_code >= 200 && http_code < 300;
+                metricas.contarEnvio(exito);
+                alTerminar(exito);
+            }, binario);
+    }
+
+    // cuerpo se intercambia con un buffer reciclado del transporte: vuelve
+    // vacio pero con capacidad, listo para componer el siguiente lote.
+    // alTerminar recibe, como el retorno de sendBatch(), si el POST llego
+    void sendBatchAsync(string& cuerpo, size_t cantidad,
+                        function<void(bool entregado, const vector<bool>&)> alTerminar) {
+        LOG_INFO("ENCOLANDO LOTE ASINCRONO: %zu lecturas, %zu bytes", cantidad, cuerpo.size());
+        transporte->enviar(cuerpo,
+            [cantidad, alTerminar](bool transporteOk, long http_code, const string& respuesta) {
+                vector<bool> resultados(cantidad, false);
+                bool entregado = false;
+                if (transporteOk) {
+                    entregado = interpretarRespuestaLote(http_code, respuesta, cantidad, resultados);
+                } else {
+                    LOG_ERROR("Envio HTTP: %s", respuesta.c_str());
+                }
+                contarEnvios(resultados);
+                alTerminar(entregado, resultados);
+            }, binario);
+    }
+
+    static void contarEnvios(const vector<bool>& resultados) {
+        for (bool ok : resultados) metricas.contarEnvio(ok);
+    }
+
+    static bool interpretarRespuestaLote(long http_code, const string& respuestaHttp, size_t cantidad,
+                                         vector<bool>& resultados) {
+        bool exito = http_code >= 200 && http_code < 300;
+        resultados.assign(cantidad, exito);
+        if (!exito || respuestaHttp.empty()) {
+            return exito;
+        }
+
+        // Un lector por hilo, creado una vez: sin stringstream ni builder
+        // por respuesta
+        static thread_local unique_ptr<Json::CharReader> lector(Json::CharReaderBuilder().newCharReader());
+        Json::Value respuesta;
+        if (!lector->parse(respuestaHttp.data(), respuestaHttp.data() + respuestaHttp.size(), &respuesta, nullptr)) {
+            return exito;
+        }
+        const Json::Value& detalle = respuesta.isObject() ? respuesta["resultados"] : respuesta;
+        if (!detalle.isArray() || detalle.size() != cantidad) {
+            return exito;
+        }
+        for (Json::ArrayIndex i = 0; i < detalle.size(); i++) {
+            const Json::Value& r = detalle[i];
+            resultados[i] = r.isBool() ? r.asBool() : (r.isObject() && r["ok"].asBool());
+        }
+        return exito;
+    }
+
+    // Una lectura como objeto JSON compacto, con el escritor de
+    // src/escritor_json.h (el mismo formato que el Arduino): sin
+    // Json::Value ni StreamWriterBuilder por lectura. Redondea a 2 decimales
+    static size_t escribirLecturaJson(const LecturaLote& lectura, char* destino, size_t capacidad) {
+        EscritorJson json(destino, capacidad);
+        json.abrirObjeto();
+        json.clave("sensor_id");
+        json.texto(lectura.sensorId.c_str());
+        json.clave("timestamp");
+        json.sinSigno(lectura.timestamp);   // MILISEGUNDOS
+        json.clave("temperatura");
+        json.real(lectura.temperatura);
+        json.clave("humedad");
+        json.real(lectura.humedad);
+        json.clave("presion");
+        json.real(lectura.presion);
+        json.clave("alerta");
+        json.entero(lectura.alerta);
+        json.clave("modo");
+        json.texto("simulacion_nativo");
+        json.cerrarObjeto();
+        if (json.desbordado()) return 0;
+        json.c_str();
+        return json.size();
+    }
+
+    static string lecturaAJson(const LecturaLote& lectura) {
+        char item[TAM_MAX_LECTURA];
+        return string(item, escribirLecturaJson(lectura, item, sizeof(item)));
+    }
+
+private:
+    // POST del cuerpo (JSON o binario segun el formato activo) a API_URL.
+    // Devuelve false solo si falla el transporte; el codigo HTTP queda en
+    // http_code
+    bool post(const char* datos, size_t largo, long& http_code) {
+        // El resto de opciones se fijaron en begin()
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, datos);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)largo);
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, binario ? headersBinario : headersJson);
+        
+        responseBuffer.clear();
+        ultimoCodigo = 0;
+        
+        // Realizar la solicitud
+        CURLcode res = curl_easy_perform(curl);
+        
+        registrarTiempoHttp(curl);
+        ultimasConexiones = contarConexiones(curl);
+        
+        if (res != CURLE_OK) {
+            LOG_ERROR("Envio HTTP: %s", curl_easy_strerror(res));
+            return false;
+        }
+        
+        // Obtener código de respuesta HTTP
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+        ultimoCodigo = http_code;
+        
+        if (http_code >= 200 && http_code < 300) LOG_DEPURACION("Respuesta HTTP: %ld", http_code);
+        else LOG_AVISO("Respuesta HTTP: %ld", http_code);
+        
+        // El cuerpo se muestra tal cual: parsearlo (y reescribirlo indentado)
+        // en cada respuesta costaba mas que serializar la lectura. Solo los
+        // lotes lo interpretan, en interpretarRespuestaLote()
+        if (!responseBuffer.empty()) {
+            if (http_code >= 200 && http_code < 300) LOG_DEPURACION("Body respuesta: %s", responseBuffer.c_str());
+            else LOG_AVISO("Body respuesta: %s", responseBuffer.c_str());
+        }
+        
+        return true;
+    }
+};
+
+#endif
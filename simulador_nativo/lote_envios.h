@@ -0,0 +1,136 @@
+#ifndef LOTE_ENVIOS_H
+#define LOTE_ENVIOS_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "arduino_nativo.h"
+#include "http_backend_nativo.h"
+
+using namespace std;
+
+// ======================
+// LOTES DE ENVIO
+// ======================
+// Acumula lecturas (de una estacion a lo largo del tiempo o de muchas
+// estaciones de la flota) y las envia como un unico array JSON cuando se
+// alcanza el numero maximo de lecturas, el tamano maximo del cuerpo o la
+// latencia maxima de la lectura mas antigua.
+struct ConfigLote {
+    size_t maxLecturas = 50;
+    size_t maxBytes = 16 * 1024;
+    unsigned long maxLatenciaMs = 5000;
+};
+
+typedef function<void(const LecturaLote& lectura, bool exito)> ResultadoLectura;
+
+class LoteEnvios {
+private:
+    HttpClientBackend& backend;
+    ConfigLote config;
+    ResultadoLectura alTerminar;
+
+    vector<LecturaLote> lecturas;
+    vector<bool> resultados;
+    string cuerpo;                  // array JSON abierto (o tramas binarias seguidas)
+    unsigned long inicioLote = 0;   // millis() de la lectura mas antigua
+
+public:
+    LoteEnvios(HttpClientBackend& backendHttp, const ConfigLote& cfg, ResultadoLectura callback)
+        : backend(backendHttp), config(cfg), alTerminar(move(callback)) {
+        lecturas.reserve(config.maxLecturas);
+        cuerpo.reserve(config.maxBytes + 256);
+    }
+
+    size_t size() const { return lecturas.size(); }
+
+    void agregar(const LecturaLote& lectura) {
+        // La lectura se serializa en la pila y se copia al cuerpo, que
+        // conserva su capacidad entre lotes
+        char item[HttpClientBackend::TAM_MAX_LECTURA];
+        size_t largo;
+        {
+            MedicionNativa m(metricas, ETAPA_SERIALIZACION);
+            largo = backend.serializarLectura(lectura, item, sizeof(item));
+        }
+        if (largo == 0) {
+            LOG_ERROR("Lectura demasiado grande para el lote (%s)", lectura.sensorId.c_str());
+            if (alTerminar) alTerminar(lectura, false);
+            return;
+        }
+        bool binario = backend.formatoBinario();
+
+        // Si no cabe en el lote actual, se envia lo que hay primero
+        if (!lecturas.empty() && cuerpo.size() + largo + 2 > config.maxBytes) {
+            enviar();
+        }
+
+        if (lecturas.empty()) {
+            inicioLote = millis();
+            cuerpo.clear();
+            if (!binario) cuerpo += '[';
+        } else if (!binario) {
+            cuerpo += ',';
+        }
+        cuerpo.append(item, largo);
+        lecturas.push_back(lectura);
+
+        if (lecturas.size() >= config.maxLecturas || cuerpo.size() + 1 >= config.maxBytes) {
+            enviar();
+        }
+    }
+
+    // Se llama periodicamente para respetar la latencia maxima
+    void revisar() {
+        if (!lecturas.empty() && millis() - inicioLote >= config.maxLatenciaMs) {
+            enviar();
+        }
+    }
+
+    // Instante (en millis()) en que revisar() cerrara el lote abierto. Lo
+    // usa el reloj virtual para no saltarse el vencimiento
+    bool vencimiento(unsigned long& limite) const {
+        if (lecturas.empty()) return false;
+        limite = inicioLote + config.maxLatenciaMs;
+        return true;
+    }
+
+    void enviar() {
+        if (lecturas.empty()) return;
+
+        if (!backend.formatoBinario()) cuerpo += ']';
+
+        if (backend.esAsync()) {
+            // El lote viaja con el callback; este objeto queda libre para
+            // seguir acumulando mientras la red responde. El cuerpo vuelve
+            // vacio con la capacidad de una solicitud ya terminada
+            auto enviadas = make_shared<vector<LecturaLote>>(move(lecturas));
+            ResultadoLectura callback = alTerminar;
+            size_t cantidad = enviadas->size();
+            backend.sendBatchAsync(cuerpo, cantidad,
+                [enviadas, callback](bool, const vector<bool>& resultadosLote) {
+                    if (!callback) return;
+                    for (size_t i = 0; i < enviadas->size(); i++) {
+                        callback((*enviadas)[i], resultadosLote[i]);
+                    }
+                });
+            lecturas = vector<LecturaLote>();
+            lecturas.reserve(config.maxLecturas);
+            return;
+        }
+
+        backend.sendBatch(cuerpo, lecturas.size(), resultados);
+
+        if (alTerminar) {
+            for (size_t i = 0; i < lecturas.size(); i++) {
+                alTerminar(lecturas[i], resultados[i]);
+            }
+        }
+
+        lecturas.clear();
+        cuerpo.clear();
+    }
+};
+
+#endif
@@ -0,0 +1,251 @@
+#ifndef METRICAS_NATIVO_H
+#define METRICAS_NATIVO_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "../src/metricas.h"
+
+using namespace std;
+
+// ======================
+// METRICAS DEL SIMULADOR
+// ======================
+// Mismas etapas que el Arduino (src/metricas.h), con histograma completo
+// por etapa y contadores compartidos por toda la flota. Todo son atomicos
+// relaxed: las estaciones de todos los hilos registran sin bloquearse.
+// Con --metricas ARCHIVO se vuelcan periodicamente en formato de texto de
+// Prometheus (apto para el textfile collector de node_exporter).
+inline uint32_t relojMetricasUs() {
+    static auto inicio = chrono::steady_clock::now();
+    return (uint32_t)chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - inicio).count();
+}
+
+static const char* const NOMBRES_ETAPA[NUM_ETAPAS] = {
+    "lectura", "filtrado", "prediccion", "serializacion", "http"
+};
+
+// Cubetas en potencias de 2 de microsegundos: la k cuenta lo que tardo
+// como mucho 2^k us (1 us .. ~8.4 s) y la ultima el resto
+class HistogramaLatencia {
+public:
+    static const int CUBETAS = 24;
+
+private:
+    atomic<uint64_t> cubetas[CUBETAS + 1];
+    atomic<uint64_t> n{0};
+    atomic<uint64_t> sumaUs{0};
+    atomic<uint32_t> maxUs{0};
+
+public:
+    HistogramaLatencia() {
+        for (auto& c : cubetas) c = 0;
+    }
+
+    static int cubeta(uint32_t us) {
+        if (us <= 1) return 0;
+        int k = 32 - __builtin_clz(us - 1);   // menor k con us <= 2^k
+        return k < CUBETAS ? k : CUBETAS;
+    }
+
+    void registrar(uint32_t us) {
+        cubetas[cubeta(us)].fetch_add(1, memory_order_relaxed);
+        n.fetch_add(1, memory_order_relaxed);
+        sumaUs.fetch_add(us, memory_order_relaxed);
+        uint32_t actual = maxUs.load(memory_order_relaxed);
+        while (us > actual && !maxUs.compare_exchange_weak(actual, us, memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t total() const { return n.load(memory_order_relaxed); }
+    uint64_t totalUs() const { return sumaUs.load(memory_order_relaxed); }
+    uint32_t maximoUs() const { return maxUs.load(memory_order_relaxed); }
+    uint64_t enCubeta(int k) const { return cubetas[k].load(memory_order_relaxed); }
+};
+
+// Etapas del simulador con --pipeline (flota_pipeline.h), cada una en sus
+// propios hilos: no confundir con las etapas de medicion de src/metricas.h
+enum EtapaPipeline {
+    PIPELINE_MUESTREO,
+    PIPELINE_ANALITICA,
+    PIPELINE_ENVIO,
+    NUM_ETAPAS_PIPELINE
+};
+
+static const char* const NOMBRES_ETAPA_PIPELINE[NUM_ETAPAS_PIPELINE] = {
+    "muestreo", "analitica", "envio"
+};
+
+// Cada hilo suma por tandas, no por elemento. La profundidad es la de la
+// cola de entrada de la etapa (el muestreo no tiene), muestreada por el
+// hilo principal. Una etapa saturada tiene ocupacion util cercana a 1 y
+// la anterior acumula bloqueo por cola llena
+struct ContadoresPipeline {
+    atomic<uint64_t> procesados{0};
+    atomic<uint64_t> ocupadoUs{0};       // trabajando, bloqueos incluidos
+    atomic<uint64_t> bloqueadoUs{0};     // esperando hueco en la cola de salida
+    atomic<uint64_t> colaLlena{0};       // encolados que encontraron la salida llena
+    atomic<uint64_t> profundidad{0};
+    atomic<uint64_t> profundidadMax{0};
+    atomic<uint64_t> capacidad{0};
+    atomic<uint32_t> hilos{0};           // 0: sin --pipeline
+
+    void sumar(uint64_t elementos, uint64_t us) {
+        procesados.fetch_add(elementos, memory_order_relaxed);
+        ocupadoUs.fetch_add(us, memory_order_relaxed);
+    }
+};
+
+class MetricasNativas {
+private:
+    HistogramaLatencia etapas[NUM_ETAPAS];
+
+public:
+    atomic<uint64_t> lecturas{0};
+    atomic<uint64_t> descartadas{0};
+    atomic<uint64_t> envios{0};
+    atomic<uint64_t> enviosFallidos{0};
+    atomic<uint64_t> sobrecargas{0};
+    atomic<uint64_t> conexiones{0};
+    atomic<uint64_t> suprimidas{0};
+    atomic<uint64_t> atipicas{0};
+    ContadoresPipeline pipeline[NUM_ETAPAS_PIPELINE];
+
+    void registrar(EtapaMetrica etapa, uint32_t us) { etapas[etapa].registrar(us); }
+
+    const HistogramaLatencia& etapa(EtapaMetrica e) const { return etapas[e]; }
+
+    void contarEnvio(bool exito) {
+        envios.fetch_add(1, memory_order_relaxed);
+        if (!exito) enviosFallidos.fetch_add(1, memory_order_relaxed);
+    }
+
+    static void contar(atomic<uint64_t>& contador) { contador.fetch_add(1, memory_order_relaxed); }
+
+    // Instantanea en formato de texto de Prometheus. tiempoSimuladoMs
+    // permite calcular el throughput en tiempo simulado con el reloj virtual
+    string prometheus(unsigned long tiempoSimuladoMs) const {
+        string s;
+        char linea[256];
+
+        s += "# HELP rainsense_etapa_segundos Latencia de cada etapa del pipeline\n";
+        s += "# TYPE rainsense_etapa_segundos histogram\n";
+        for (int e = 0; e < NUM_ETAPAS; e++) {
+            const HistogramaLatencia& h = etapas[e];
+            uint64_t acumulado = 0;
+            for (int k = 0; k < HistogramaLatencia::CUBETAS; k++) {
+                acumulado += h.enCubeta(k);
+                snprintf(linea, sizeof(linea), "rainsense_etapa_segundos_bucket{etapa=\"%s\",le=\"%g\"} %llu\n",
+                         NOMBRES_ETAPA[e], (double)(1u << k) / 1e6, (unsigned long long)acumulado);
+                s += linea;
+            }
+            snprintf(linea, sizeof(linea), "rainsense_etapa_segundos_bucket{etapa=\"%s\",le=\"+Inf\"} %llu\n",
+                     NOMBRES_ETAPA[e], (unsigned long long)h.total());
+            s += linea;
+            snprintf(linea, sizeof(linea), "rainsense_etapa_segundos_sum{etapa=\"%s\"} %.6f\n",
+                     NOMBRES_ETAPA[e], h.totalUs() / 1e6);
+            s += linea;
+            snprintf(linea, sizeof(linea), "rainsense_etapa_segundos_count{etapa=\"%s\"} %llu\n",
+                     NOMBRES_ETAPA[e], (unsigned long long)h.total());
+            s += linea;
+        }
+
+        s += "# HELP rainsense_etapa_max_segundos Latencia maxima observada por etapa\n";
+        s += "# TYPE rainsense_etapa_max_segundos gauge\n";
+        for (int e = 0; e < NUM_ETAPAS; e++) {
+            snprintf(linea, sizeof(linea), "rainsense_etapa_max_segundos{etapa=\"%s\"} %.6f\n",
+                     NOMBRES_ETAPA[e], etapas[e].maximoUs() / 1e6);
+            s += linea;
+        }
+
+        const struct { const char* nombre; const char* ayuda; const atomic<uint64_t>& valor; } contadores[] = {
+            {"rainsense_lecturas_total", "Lecturas de sensores", lecturas},
+            {"rainsense_lecturas_descartadas_total", "Lecturas invalidas descartadas", descartadas},
+            {"rainsense_envios_total", "Lecturas enviadas al backend", envios},
+            {"rainsense_envios_fallidos_total", "Lecturas cuyo envio fallo", enviosFallidos},
+            {"rainsense_sobrecargas_total", "Activaciones de tareas perdidas por retraso", sobrecargas},
+            {"rainsense_conexiones_total", "Conexiones TCP abiertas al backend", conexiones},
+            {"rainsense_lecturas_suprimidas_total", "Lecturas sin cambios fuera de banda no enviadas", suprimidas},
+            {"rainsense_lecturas_atipicas_total", "Lecturas con alguna variable sustituida por la mediana", atipicas},
+        };
+        for (const auto& c : contadores) {
+            snprintf(linea, sizeof(linea), "# HELP %s %s\n# TYPE %s counter\n%s %llu\n", c.nombre, c.ayuda,
+                     c.nombre, c.nombre, (unsigned long long)c.valor.load(memory_order_relaxed));
+            s += linea;
+        }
+
+        if (pipeline[PIPELINE_MUESTREO].hilos.load(memory_order_relaxed) > 0) s += prometheusPipeline();
+
+        s += "# HELP rainsense_tiempo_simulado_segundos Tiempo simulado transcurrido\n";
+        s += "# TYPE rainsense_tiempo_simulado_segundos gauge\n";
+        snprintf(linea, sizeof(linea), "rainsense_tiempo_simulado_segundos %.3f\n", tiempoSimuladoMs / 1000.0);
+        s += linea;
+        return s;
+    }
+
+    string prometheusPipeline() const {
+        string s;
+        char linea[256];
+        const struct {
+            const char* nombre; const char* tipo; const char* ayuda;
+            const atomic<uint64_t> ContadoresPipeline::*campo; double escala;
+        } series[] = {
+            {"rainsense_pipeline_procesados_total", "counter", "Elementos procesados por etapa",
+             &ContadoresPipeline::procesados, 1},
+            {"rainsense_pipeline_ocupado_segundos_total", "counter", "Tiempo de trabajo de los hilos de la etapa",
+             &ContadoresPipeline::ocupadoUs, 1e-6},
+            {"rainsense_pipeline_bloqueado_segundos_total", "counter", "Tiempo esperando hueco en la cola de salida",
+             &ContadoresPipeline::bloqueadoUs, 1e-6},
+            {"rainsense_pipeline_cola_llena_total", "counter", "Encolados que encontraron la cola de salida llena",
+             &ContadoresPipeline::colaLlena, 1},
+            {"rainsense_pipeline_cola_profundidad", "gauge", "Elementos en la cola de entrada de la etapa",
+             &ContadoresPipeline::profundidad, 1},
+            {"rainsense_pipeline_cola_profundidad_max", "gauge", "Maxima profundidad observada de la cola de entrada",
+             &ContadoresPipeline::profundidadMax, 1},
+            {"rainsense_pipeline_cola_capacidad", "gauge", "Capacidad total de la cola de entrada",
+             &ContadoresPipeline::capacidad, 1},
+        };
+        for (const auto& serie : series) {
+            snprintf(linea, sizeof(linea), "# HELP %s %s\n# TYPE %s %s\n", serie.nombre, serie.ayuda,
+                     serie.nombre, serie.tipo);
+            s += linea;
+            for (int e = 0; e < NUM_ETAPAS_PIPELINE; e++) {
+                double valor = (pipeline[e].*serie.campo).load(memory_order_relaxed) * serie.escala;
+                snprintf(linea, sizeof(linea), "%s{etapa=\"%s\"} %.15g\n", serie.nombre,
+                         NOMBRES_ETAPA_PIPELINE[e], valor);
+                s += linea;
+            }
+        }
+        s += "# HELP rainsense_pipeline_hilos Hilos dedicados a cada etapa\n";
+        s += "# TYPE rainsense_pipeline_hilos gauge\n";
+        for (int e = 0; e < NUM_ETAPAS_PIPELINE; e++) {
+            snprintf(linea, sizeof(linea), "rainsense_pipeline_hilos{etapa=\"%s\"} %u\n",
+                     NOMBRES_ETAPA_PIPELINE[e], pipeline[e].hilos.load(memory_order_relaxed));
+            s += linea;
+        }
+        return s;
+    }
+
+    // Escribe a un temporal y lo renombra: quien lee nunca ve un archivo
+    // a medio escribir
+    bool escribir(const string& ruta, unsigned long tiempoSimuladoMs) const {
+        string temporal = ruta + ".tmp";
+        FILE* f = fopen(temporal.c_str(), "wb");
+        if (!f) return false;
+        string texto = prometheus(tiempoSimuladoMs);
+        bool ok = fwrite(texto.data(), 1, texto.size(), f) == texto.size();
+        ok = fclose(f) == 0 && ok;
+#ifdef _WIN32
+        remove(ruta.c_str());   // en Windows rename() no reemplaza
+#endif
+        return ok && rename(temporal.c_str(), ruta.c_str()) == 0;
+    }
+};
+
+inline MetricasNativas metricas;
+
+typedef MedicionEtapa<MetricasNativas> MedicionNativa;
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef POOL_HILOS_H
+#define POOL_HILOS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// ======================
+// POOL DE HILOS CON ROBO DE TAREAS
+// ======================
+// Cada hilo tiene su propia cola: consume por el final (LIFO, datos calientes
+// en cache) y, cuando se vacia, roba por el principio de las colas ajenas.
+// Las tareas se reparten en round-robin al encolarse desde fuera del pool.
+class PoolHilos {
+private:
+    struct ColaHilo {
+        mutex m;
+        deque<function<void()>> tareas;
+    };
+
+    vector<unique_ptr<ColaHilo>> colas;
+    vector<thread> hilos;
+
+    atomic<size_t> encoladas{0};    // en alguna cola, aun sin tomar
+    atomic<size_t> pendientes{0};   // encoladas + en ejecucion
+    atomic<unsigned> siguienteCola{0};
+    atomic<bool> detener{false};
+
+    mutex mEspera;
+    condition_variable cvTrabajo;
+    condition_variable cvFin;
+
+    static int& indiceActual() {
+        static thread_local int indice = -1;
+        return indice;
+    }
+
+public:
+    explicit PoolHilos(unsigned numHilos) {
+        if (numHilos == 0) numHilos = 1;
+        for (unsigned i = 0; i < numHilos; i++) {
+            colas.emplace_back(new ColaHilo());
+        }
+        for (unsigned i = 0; i < numHilos; i++) {
+            hilos.emplace_back([this, i] { bucle(i); });
+        }
+    }
+
+    ~PoolHilos() {
+        {
+            lock_guard<mutex> lock(mEspera);
+            detener = true;
+        }
+        cvTrabajo.notify_all();
+        for (auto& h : hilos) h.join();
+    }
+
+    PoolHilos(const PoolHilos&) = delete;
+    PoolHilos& operator=(const PoolHilos&) = delete;
+
+    unsigned size() const { return hilos.size(); }
+
+    // Indice del hilo del pool que ejecuta la llamada, -1 fuera del pool
+    static int hiloActual() { return indiceActual(); }
+
+    void submit(function<void()> tarea) {
+        int propio = indiceActual();
+        unsigned destino = propio >= 0 ? (unsigned)propio
+                                       : siguienteCola++ % colas.size();
+        pendientes++;
+        {
+            // Se cuenta antes de encolar para que un hilo que la tome
+            // enseguida nunca deje el contador por debajo de cero
+            lock_guard<mutex> lock(mEspera);
+            encoladas++;
+        }
+        {
+            lock_guard<mutex> lock(colas[destino]->m);
+            colas[destino]->tareas.push_back(move(tarea));
+        }
+        cvTrabajo.notify_one();
+    }
+
+    // Bloquea hasta que no quede ninguna tarea encolada ni en ejecucion
+    void esperar() {
+        unique_lock<mutex> lock(mEspera);
+        cvFin.wait(lock, [this] { return pendientes == 0; });
+    }
+
+private:
+    bool tomarPropia(unsigned indice, function<void()>& tarea) {
+        ColaHilo& cola = *colas[indice];
+        lock_guard<mutex> lock(cola.m);
+        if (cola.tareas.empty()) return false;
+        tarea = move(cola.tareas.back());
+        cola.tareas.pop_back();
+        return true;
+    }
+
+    bool robar(unsigned indice, function<void()>& tarea) {
+        for (size_t i = 1; i < colas.size(); i++) {
+            ColaHilo& victima = *colas[(indice + i) % colas.size()];
+            lock_guard<mutex> lock(victima.m);
+            if (victima.tareas.empty()) continue;
+            tarea = move(victima.tareas.front());
+            victima.tareas.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    void bucle(unsigned indice) {
+        indiceActual() = indice;
+        function<void()> tarea;
+
+        while (true) {
+            if (tomarPropia(indice, tarea) || robar(indice, tarea)) {
+                encoladas--;
+                tarea();
+                tarea = nullptr;
+                if (--pendientes == 0) {
+                    lock_guard<mutex> lock(mEspera);
+                    cvFin.notify_all();
+                }
+                continue;
+            }
+
+            unique_lock<mutex> lock(mEspera);
+            cvTrabajo.wait(lock, [this] { return detener || encoladas > 0; });
+            if (detener && encoladas == 0) return;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,167 @@
+#ifndef PRECISION_PUNTO_FIJO_H
+#define PRECISION_PUNTO_FIJO_H
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include "arduino_nativo.h"
+#include "componentes_nativo.h"
+#include "../src/ventana_estadistica.h"
+#include "../src/punto_fijo.h"
+#include "../src/puntuacion_riesgo.h"
+
+using namespace std;
+
+// ======================
+// PRECISION DEL PUNTO FIJO FRENTE A FLOAT
+// ======================
+// simulador_native --precision-punto-fijo [N]   (y pio test -e native)
+// Pasa N lecturas por la ruta float del Arduino (VentanaEstadistica con
+// acumuladores float) y por la de punto fijo, y compara puntos de riesgo y
+// nivel de alerta tras cada lectura. Las medias y tendencias en punto fijo
+// se comparan ademas con una referencia exacta (acumuladores double), no con
+// la ruta float: el error propio del float (sumas de presion ~20000 con 24
+// bits de mantisa) no debe contar contra el punto fijo. Se usan dos
+// escenarios: las lecturas aleatorias del SensorController (tendencias
+// cerca de cero) y un paseo aleatorio con deriva (tendencias grandes).
+struct ErroresPuntoFijo {
+    double media[3] = {0, 0, 0};        // temperatura, humedad, presion
+    double tendencia[2] = {0, 0};       // humedad, presion
+    unsigned long evaluaciones = 0;
+    unsigned long puntosDistintos = 0;
+    unsigned long nivelesDistintos = 0;
+
+    void registrar(double& maximo, double error) {
+        if (error > maximo) maximo = error;
+    }
+};
+
+// Cotas frente a la referencia exacta. La referencia recibe las mismas
+// centesimas que el punto fijo (las lecturas del sensor tienen dos
+// decimales, asi que aFijo() no pierde nada) y todo se compara en double:
+// lo unico que se mide es el redondeo de VentanaPuntoFijo, no la
+// representacion float de 1010.37
+// - media: la suma en centesimas es exacta y dividirRedondeando() se
+//   desvia a lo sumo media centesima: 0.005
+// - tendencia: numerador y denominador de la regresion son enteros exactos
+//   y el cociente se redondea a la milesima: 0.0005
+// El margen solo absorbe el redondeo de la referencia en double. Si un
+// cambio de escala en punto_fijo.h perdiera precision, se notaria aqui
+// - niveles: los umbrales caen en la rejilla de centesimas, asi que solo
+//   discrepan las medias a menos de media centesima de un umbral
+const double TOLERANCIA_MEDIA = 0.005 + 1e-9;
+const double TOLERANCIA_TENDENCIA = 0.0005 + 1e-9;
+const double TOLERANCIA_NIVELES = 0.001;   // fraccion de evaluaciones
+
+typedef VentanaEstadistica<double, double, TAM_VENTANA_FILTRO> VentanaExacta;
+
+inline void compararLectura(float t, float h, float p, VentanaExacta exacta[3],
+                            VentanaEstadistica<float, float, TAM_VENTANA_FILTRO> referencia[3],
+                            VentanaPuntoFijo<TAM_VENTANA_FILTRO> fija[3], ErroresPuntoFijo& e) {
+    const double BASES[3] = {0, 0, PRESION_BASE_FIJO};
+    float valores[3] = {t, h, p};
+    for (int i = 0; i < 3; i++) {
+        int16_t centesimas = aFijo(valores[i], BASES[i]);
+        fija[i].add(centesimas);
+        exacta[i].add(centesimas / (double)ESCALA_FIJO + BASES[i]);
+        referencia[i].add(valores[i]);
+    }
+    if (referencia[0].size() < 2) return;
+
+    DatosFijos d = {fija[0].media(), fija[1].media(), fija[2].media()};
+    int32_t tendHFija = fija[1].pendienteMilesimas();
+    int32_t tendPFija = fija[2].pendienteMilesimas();
+
+    int16_t mediasFijas[3] = {d.temperatura, d.humedad, d.presion};
+    for (int i = 0; i < 3; i++) {
+        e.registrar(e.media[i], fabs(mediasFijas[i] / (double)ESCALA_FIJO + BASES[i] - exacta[i].media()));
+    }
+    e.registrar(e.tendencia[0], fabs(tendHFija / 1000.0 - exacta[1].pendiente()));
+    e.registrar(e.tendencia[1], fabs(tendPFija / 1000.0 - exacta[2].pendiente()));
+
+    // Lo que decide el Arduino: ruta float frente a ruta en punto fijo
+    float medias[3] = {referencia[0].media(), referencia[1].media(), referencia[2].media()};
+    float tendH = referencia[1].pendiente();
+    float tendP = referencia[2].pendiente();
+    int puntos = puntosRiesgo(medias[0], medias[1], medias[2], tendH, tendP);
+    int puntosFijos = puntosRiesgoFijo(d, tendHFija, tendPFija);
+    e.evaluaciones++;
+    if (puntos != puntosFijos) e.puntosDistintos++;
+    if (nivelAlerta(puntos, medias[1], medias[2]) != nivelAlertaFijo(puntosFijos, d)) e.nivelesDistintos++;
+}
+
+inline ErroresPuntoFijo medirPuntoFijo(size_t n) {
+    ErroresPuntoFijo e;
+
+    // Escenario 1: lecturas del simulador
+    {
+        bool silencioso = Serial.estaSilenciado();
+        Serial.silenciar(true);
+        SensorController sensor;
+        sensor.semilla(7);
+        VentanaExacta exacta[3];
+        VentanaEstadistica<float, float, TAM_VENTANA_FILTRO> referencia[3];
+        VentanaPuntoFijo<TAM_VENTANA_FILTRO> fija[3];
+        for (size_t i = 0; i < n / 2; i++) {
+            SensorData d = sensor.readSensors();
+            compararLectura(d.temperatura, d.humedad, d.presion, exacta, referencia, fija, e);
+        }
+        Serial.silenciar(silencioso);
+    }
+
+    // Escenario 2: paseo aleatorio con deriva que cambia cada 100 lecturas
+    {
+        minstd_rand generador(11);
+        uniform_real_distribution<float> ruido(-0.3f, 0.3f);
+        uniform_real_distribution<float> deriva(-0.8f, 0.8f);
+        VentanaExacta exacta[3];
+        VentanaEstadistica<float, float, TAM_VENTANA_FILTRO> referencia[3];
+        VentanaPuntoFijo<TAM_VENTANA_FILTRO> fija[3];
+        float t = 25, h = 70, p = 1010;
+        float dt = 0, dh = 0, dp = 0;
+        for (size_t i = 0; i < n - n / 2; i++) {
+            if (i % 100 == 0) {
+                dt = deriva(generador) / 4;
+                dh = deriva(generador);
+                dp = deriva(generador) / 2;
+            }
+            t = min(45.0f, max(5.0f, t + dt + ruido(generador)));
+            h = min(100.0f, max(30.0f, h + dh + ruido(generador)));
+            p = min(1040.0f, max(980.0f, p + dp + ruido(generador)));
+            compararLectura(roundToTwoDecimals(t), roundToTwoDecimals(h), roundToTwoDecimals(p),
+                            exacta, referencia, fija, e);
+        }
+    }
+    return e;
+}
+
+inline bool dentroDeTolerancia(const ErroresPuntoFijo& e) {
+    double fraccionNiveles = (double)e.nivelesDistintos / e.evaluaciones;
+    return e.media[0] <= TOLERANCIA_MEDIA && e.media[1] <= TOLERANCIA_MEDIA &&
+           e.media[2] <= TOLERANCIA_MEDIA && e.tendencia[0] <= TOLERANCIA_TENDENCIA &&
+           e.tendencia[1] <= TOLERANCIA_TENDENCIA && fraccionNiveles <= TOLERANCIA_NIVELES;
+}
+
+// Devuelve false si algun error supera la tolerancia
+inline bool compararPuntoFijo(size_t n) {
+    if (n == 0) n = 200000;
+    ErroresPuntoFijo e = medirPuntoFijo(n);
+    bool ok = dentroDeTolerancia(e);
+
+    printf("====================================\n");
+    printf("PRECISION PUNTO FIJO vs FLOAT (%zu lecturas, ventana %d)\n", n, TAM_VENTANA_FILTRO);
+    printf("====================================\n");
+    printf("Error max. media        T: %.5f C  H: %.5f %%  P: %.5f hPa (cota %.5f)\n", e.media[0], e.media[1],
+           e.media[2], TOLERANCIA_MEDIA);
+    printf("Error max. tendencia    H: %.5f  P: %.5f por muestra (cota %.5f)\n", e.tendencia[0], e.tendencia[1],
+           TOLERANCIA_TENDENCIA);
+    printf("Puntos de riesgo distintos: %lu de %lu (%.4f%%)\n", e.puntosDistintos, e.evaluaciones,
+           100.0 * e.puntosDistintos / e.evaluaciones);
+    printf("Niveles de alerta distintos: %lu de %lu (%.4f%%)\n", e.nivelesDistintos, e.evaluaciones,
+           100.0 * e.nivelesDistintos / e.evaluaciones);
+    printf("Resultado: %s\n", ok ? "OK" : "FUERA DE TOLERANCIA");
+    return ok;
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef PREDICCION_LOTE_H
+#define PREDICCION_LOTE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "config_nativo.h"
+#include "../src/puntuacion_riesgo.h"
+
+using namespace std;
+
+// ======================
+// PREDICCION EN LOTE (STRUCTURE OF ARRAYS)
+// ======================
+// Puntua miles de estaciones de una pasada. puntosRiesgo() y nivelAlerta()
+// se generan desde REGLAS_RIESGO como sumas de comparaciones sin saltos,
+// asi que el bucle se vectoriza (SSE2 siempre en x86-64; AVX2 con
+// -march=native) y el resultado es identico bit a bit al escalar: se
+// comparan los mismos float con los mismos umbrales.
+//
+// GCC 12 solo vectoriza por defecto a -O3; el atributo lo activa para esta
+// funcion con el -O2 de los entornos native y benchmark.
+#if defined(__GNUC__) && !defined(__clang__)
+#define VECTORIZAR_LOTE __attribute__((optimize("tree-vectorize", "vect-cost-model=dynamic")))
+#else
+#define VECTORIZAR_LOTE
+#endif
+
+VECTORIZAR_LOTE inline void puntuarLote(size_t n,
+                        const float* __restrict temperatura, const float* __restrict humedad,
+                        const float* __restrict presion, const float* __restrict tendenciaHumedad,
+                        const float* __restrict tendenciaPresion,
+                        int32_t* __restrict puntos, int32_t* __restrict nivel) {
+    for (size_t i = 0; i < n; i++) {
+        int32_t pts = puntosRiesgo(temperatura[i], humedad[i], presion[i],
+                                   tendenciaHumedad[i], tendenciaPresion[i]);
+        puntos[i] = pts;
+        nivel[i] = nivelAlerta(pts, humedad[i], presion[i]);
+    }
+}
+
+// Columnas de entrada y salida para puntuarLote()
+struct DatosPrediccionSoA {
+    vector<float> temperatura;
+    vector<float> humedad;
+    vector<float> presion;
+    vector<float> tendenciaHumedad;
+    vector<float> tendenciaPresion;
+    vector<int32_t> puntos;
+    vector<int32_t> nivel;
+
+    size_t size() const { return temperatura.size(); }
+
+    void resize(size_t n) {
+        temperatura.resize(n);
+        humedad.resize(n);
+        presion.resize(n);
+        tendenciaHumedad.resize(n);
+        tendenciaPresion.resize(n);
+        puntos.resize(n);
+        nivel.resize(n);
+    }
+
+    void puntuar() {
+        puntuarLote(size(), temperatura.data(), humedad.data(), presion.data(),
+                    tendenciaHumedad.data(), tendenciaPresion.data(), puntos.data(), nivel.data());
+    }
+};
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef REGISTRO_NATIVO_H
+#define REGISTRO_NATIVO_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/registro.h"
+
+using namespace std;
+
+// ======================
+// REGISTRO ASINCRONO
+// ======================
+// Salida de Serial y de LOG_* en el simulador. Quien registra solo copia
+// la linea a un buffer circular de tamano fijo; un hilo de fondo la
+// escribe en stdout por bloques, con un solo fflush por bloque en lugar
+// de un endl por linea. Si el buffer se llena, quien registra espera: no
+// se pierden lineas. vaciar() espera a que todo lo encolado este escrito,
+// para intercalar con salida directa por cout.
+class RegistroAsincrono {
+private:
+    static constexpr size_t CAPACIDAD = 1024;       // lineas en vuelo
+    static constexpr size_t LARGO_BLOQUE = 256;     // las lineas largas ocupan varios
+
+    struct Bloque {
+        uint16_t largo;
+        char texto[LARGO_BLOQUE];
+    };
+
+    vector<Bloque> bloques;
+    uint64_t escritos = 0;     // bloques encolados
+    uint64_t leidos = 0;       // bloques copiados por el hilo de fondo
+    uint64_t volcados = 0;     // bloques ya escritos en stdout
+    bool terminar = false;
+    atomic<bool> silencioso{false};
+    mutex mtx;
+    condition_variable hayLineas;
+    condition_variable hayEspacio;
+    condition_variable vaciado;
+    thread escritor;
+
+    void ejecutarEscritor() {
+        string pendiente;
+        unique_lock<mutex> lock(mtx);
+        while (true) {
+            hayLineas.wait(lock, [this] { return terminar || leidos != escritos; });
+            if (leidos == escritos && terminar) break;
+
+            pendiente.clear();
+            uint64_t hasta = escritos;
+            for (; leidos != hasta; leidos++) {
+                const Bloque& b = bloques[leidos % CAPACIDAD];
+                pendiente.append(b.texto, b.largo);
+            }
+            hayEspacio.notify_all();
+
+            lock.unlock();
+            fwrite(pendiente.data(), 1, pendiente.size(), stdout);
+            fflush(stdout);
+            lock.lock();
+
+            volcados = hasta;
+            vaciado.notify_all();
+        }
+    }
+
+public:
+    RegistroAsincrono() : bloques(CAPACIDAD) {
+        escritor = thread(&RegistroAsincrono::ejecutarEscritor, this);
+    }
+
+    ~RegistroAsincrono() {
+        {
+            lock_guard<mutex> lock(mtx);
+            terminar = true;
+        }
+        hayLineas.notify_all();
+        escritor.join();
+    }
+
+    void silenciar(bool valor) { silencioso = valor; }
+    bool estaSilenciado() const { return silencioso.load(memory_order_relaxed); }
+
+    // Encola texto tal cual (incluido el salto de linea). Los bloques de
+    // una misma llamada quedan contiguos aunque escriban varios hilos
+    void escribir(const char* texto, size_t largo) {
+        if (largo == 0) return;
+        size_t necesarios = (largo + LARGO_BLOQUE - 1) / LARGO_BLOQUE;
+        if (necesarios > CAPACIDAD) {
+            necesarios = CAPACIDAD;
+            largo = CAPACIDAD * LARGO_BLOQUE;
+        }
+
+        unique_lock<mutex> lock(mtx);
+        hayEspacio.wait(lock, [&] { return escritos + necesarios - leidos <= CAPACIDAD; });
+        for (size_t i = 0; i < necesarios; i++) {
+            Bloque& b = bloques[escritos++ % CAPACIDAD];
+            b.largo = (uint16_t)min(largo, LARGO_BLOQUE);
+            memcpy(b.texto, texto, b.largo);
+            texto += b.largo;
+            largo -= b.largo;
+        }
+        lock.unlock();
+        hayLineas.notify_one();
+    }
+
+    void vaciar() {
+        unique_lock<mutex> lock(mtx);
+        uint64_t objetivo = escritos;
+        hayLineas.notify_one();
+        vaciado.wait(lock, [&] { return volcados >= objetivo; });
+    }
+};
+
+inline RegistroAsincrono& registroNativo() {
+    static RegistroAsincrono registro;
+    return registro;
+}
+
+inline void vaciarRegistro() {
+    registroNativo().vaciar();
+}
+
+inline void registrarFormato(uint8_t nivel, FormatoRegistro formato, ...) {
+    RegistroAsincrono& registro = registroNativo();
+    if (registro.estaSilenciado()) return;
+
+    char linea[512];
+    int n = 0;
+    if (nivel == REGISTRO_ERROR) n = snprintf(linea, sizeof(linea), "ERROR: ");
+    else if (nivel == REGISTRO_AVISO) n = snprintf(linea, sizeof(linea), "AVISO: ");
+
+    va_list args;
+    va_start(args, formato);
+    int m = vsnprintf(linea + n, sizeof(linea) - n - 1, formato, args);
+    va_end(args);
+
+    // Truncada si no cabe; siempre termina en salto de linea
+    size_t largo = min((size_t)n + (m > 0 ? (size_t)m : 0), sizeof(linea) - 2);
+    linea[largo++] = '\n';
+    registro.escribir(linea, largo);
+}
+
+#endif
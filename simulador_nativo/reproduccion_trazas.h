@@ -0,0 +1,560 @@
+#ifndef REPRODUCCION_TRAZAS_H
+#define REPRODUCCION_TRAZAS_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "arduino_nativo.h"
+#include "config_nativo.h"
+#include "../src/ventana_estadistica.h"
+#include "../src/punto_fijo.h"
+#include "../src/puntuacion_riesgo.h"
+#include "../src/formato_binario.h"
+#include "../src/politica_reporte.h"
+#include "../src/filtro_robusto.h"
+#include "../src/filtro_kalman.h"
+
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+using namespace std;
+
+// ======================
+// ARCHIVO MAPEADO DE SOLO LECTURA
+// ======================
+class ArchivoMapeado {
+private:
+    const uint8_t* datos = nullptr;
+    size_t largo = 0;
+#ifdef _WIN32
+    HANDLE archivo = INVALID_HANDLE_VALUE;
+    HANDLE mapeo = NULL;
+#endif
+
+public:
+    ~ArchivoMapeado() { cerrar(); }
+
+    bool abrir(const string& ruta) {
+#ifdef _WIN32
+        archivo = CreateFileA(ruta.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (archivo == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER tam;
+        if (!GetFileSizeEx(archivo, &tam)) return false;
+        largo = (size_t)tam.QuadPart;
+        if (largo == 0) return true;
+        mapeo = CreateFileMappingA(archivo, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!mapeo) return false;
+        datos = static_cast<const uint8_t*>(MapViewOfFile(mapeo, FILE_MAP_READ, 0, 0, 0));
+        return datos != nullptr;
+#else
+        int fd = open(ruta.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            return false;
+        }
+        largo = (size_t)st.st_size;
+        if (largo == 0) {
+            close(fd);
+            return true;
+        }
+        void* p = mmap(nullptr, largo, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) return false;
+        // Se recorre una sola vez de principio a fin
+        madvise(p, largo, MADV_SEQUENTIAL);
+        datos = static_cast<const uint8_t*>(p);
+        return true;
+#endif
+    }
+
+    const uint8_t* data() const { return datos; }
+    size_t size() const { return largo; }
+
+    void cerrar() {
+#ifdef _WIN32
+        if (datos) UnmapViewOfFile(datos);
+        if (mapeo) CloseHandle(mapeo);
+        if (archivo != INVALID_HANDLE_VALUE) CloseHandle(archivo);
+        mapeo = NULL;
+        archivo = INVALID_HANDLE_VALUE;
+#else
+        if (datos) munmap(const_cast<uint8_t*>(datos), largo);
+#endif
+        datos = nullptr;
+        largo = 0;
+    }
+};
+
+// ======================
+// REPRODUCCION DE TRAZAS
+// ======================
+// simulador_native --reproducir TRAZA [--linea-tiempo ARCHIVO]
+// Pasa lecturas grabadas por la misma logica que el Arduino (validacion de
+// leerSensores(), etapa robusta FILTRO_ROBUSTO, ventana de
+// TAM_VENTANA_FILTRO muestras con acumuladores float o punto fijo segun
+// USAR_PUNTO_FIJO o Kalman segun MOTOR_FILTRO, y las reglas de
+// puntuacion_riesgo.h), sin SensorController ni esperas. El filtrado y la
+// prediccion se disparan cada INTERVALO_FILTRADO segun los timestamps de la
+// traza, por estacion.
+//
+// Formatos (se detecta por los primeros bytes):
+//   CSV:     timestamp_ms,temperatura,humedad,presion,estacion
+//            (cabecera opcional; se ignoran las lineas que no empiezan
+//            por un digito)
+//   Binario: tramas de formato_binario.h seguidas, como las del envio
+//
+// Salida: los cambios de nivel de alerta de cada estacion (linea de
+// tiempo, CSV) y un resumen con el rendimiento en lecturas por segundo.
+// Cada INTERVALO_ENVIO se evalua ademas la politica de reporte por banda
+// (politica_reporte.h): el resumen da cuantos envios se habrian ahorrado y
+// el error maximo de la serie que reconstruiria el backend manteniendo el
+// ultimo valor recibido.
+struct LecturaTraza {
+    uint64_t timestampMs;
+    float temperatura;
+    float humedad;
+    float presion;
+    string_view estacion;
+};
+
+class EstacionReproducida {
+private:
+#if MOTOR_FILTRO == MOTOR_KALMAN
+    FiltroKalman kalman[3] = {
+        FiltroKalman(KALMAN_MEDIDA_TEMPERATURA, KALMAN_ACELERACION_TEMPERATURA),
+        FiltroKalman(KALMAN_MEDIDA_HUMEDAD, KALMAN_ACELERACION_HUMEDAD),
+        FiltroKalman(KALMAN_MEDIDA_PRESION, KALMAN_ACELERACION_PRESION)};
+#elif USAR_PUNTO_FIJO
+    VentanaPuntoFijo<TAM_VENTANA_FILTRO> historialTemperatura;
+    VentanaPuntoFijo<TAM_VENTANA_FILTRO> historialHumedad;
+    VentanaPuntoFijo<TAM_VENTANA_FILTRO> historialPresion;
+#else
+    VentanaEstadistica<float, float, TAM_VENTANA_FILTRO> historialTemperatura;
+    VentanaEstadistica<float, float, TAM_VENTANA_FILTRO> historialHumedad;
+    VentanaEstadistica<float, float, TAM_VENTANA_FILTRO> historialPresion;
+#endif
+#if USAR_PUNTO_FIJO
+    typedef int16_t ValorRobusto;
+    typedef int32_t AcumRobusto;
+#else
+    typedef float ValorRobusto;
+    typedef float AcumRobusto;
+#endif
+#if FILTRO_ROBUSTO == FILTRO_MEDIANA
+    MedianaDeslizante<ValorRobusto, AcumRobusto, TAM_VENTANA_ROBUSTA> robusto[3];
+#elif FILTRO_ROBUSTO == FILTRO_HAMPEL
+    FiltroHampel<ValorRobusto, AcumRobusto, TAM_VENTANA_ROBUSTA> robusto[3] = {
+  #if USAR_PUNTO_FIJO
+        FiltroHampel<ValorRobusto, AcumRobusto, TAM_VENTANA_ROBUSTA>(aFijo(HAMPEL_MINIMO_TEMPERATURA)),
+        FiltroHampel<ValorRobusto, AcumRobusto, TAM_VENTANA_ROBUSTA>(aFijo(HAMPEL_MINIMO_HUMEDAD)),
+        FiltroHampel<ValorRobusto, AcumRobusto, TAM_VENTANA_ROBUSTA>(aFijo(HAMPEL_MINIMO_PRESION))};
+  #else
+        FiltroHampel<ValorRobusto, AcumRobusto, TAM_VENTANA_ROBUSTA>(HAMPEL_MINIMO_TEMPERATURA),
+        FiltroHampel<ValorRobusto, AcumRobusto, TAM_VENTANA_ROBUSTA>(HAMPEL_MINIMO_HUMEDAD),
+        FiltroHampel<ValorRobusto, AcumRobusto, TAM_VENTANA_ROBUSTA>(HAMPEL_MINIMO_PRESION)};
+  #endif
+#endif
+    uint64_t ultimoFiltrado = 0;
+    bool hayFiltrado = false;
+    uint64_t ultimoEnvio = 0;
+    bool hayEnvio = false;
+
+public:
+    int nivel = -1;      // ultimo nivel de alerta, -1 antes de la primera prediccion
+    int puntos = 0;
+    PoliticaReporte politica;
+    float reconstruida[3] = {0, 0, 0};   // lo que el backend tendria: T, H, P
+
+    // Igual que leerSensores() en sistema_controller.cpp
+    static bool valida(const LecturaTraza& l) {
+        return l.temperatura > -40 && l.temperatura < 85 &&
+               l.humedad >= 0 && l.humedad <= 100 &&
+               l.presion > 800 && l.presion < 1100;
+    }
+
+    // Como DataFilter::addData(): devuelve true si alguna variable era
+    // atipica y entro la mediana en su lugar
+    bool agregar(const LecturaTraza& l) {
+#if USAR_PUNTO_FIJO
+        ValorRobusto valores[3] = {aFijo(l.temperatura), aFijo(l.humedad), aFijo(l.presion, PRESION_BASE_FIJO)};
+#else
+        ValorRobusto valores[3] = {l.temperatura, l.humedad, l.presion};
+#endif
+        bool atipica = false;
+#if FILTRO_ROBUSTO == FILTRO_MEDIANA
+        for (int i = 0; i < 3; i++) {
+            robusto[i].agregar(valores[i]);
+            valores[i] = robusto[i].mediana();
+        }
+#elif FILTRO_ROBUSTO == FILTRO_HAMPEL
+        for (int i = 0; i < 3; i++) {
+            if (robusto[i].limpiar(valores[i])) atipica = true;
+        }
+#endif
+#if MOTOR_FILTRO == MOTOR_KALMAN
+  #if USAR_PUNTO_FIJO
+        kalman[0].agregar(desdeFijo(valores[0]));
+        kalman[1].agregar(desdeFijo(valores[1]));
+        kalman[2].agregar(desdeFijo(valores[2], PRESION_BASE_FIJO));
+  #else
+        for (int i = 0; i < 3; i++) kalman[i].agregar(valores[i]);
+  #endif
+#else
+        historialTemperatura.add(valores[0]);
+        historialHumedad.add(valores[1]);
+        historialPresion.add(valores[2]);
+#endif
+        return atipica;
+    }
+
+    bool hayDatos() const {
+#if MOTOR_FILTRO == MOTOR_KALMAN
+        return kalman[0].iniciadoConDatos();
+#else
+        return historialTemperatura.size() > 0;
+#endif
+    }
+
+    // Devuelve true si en este instante toca filtrar y predecir
+    bool tocaFiltrar(uint64_t timestampMs) {
+        if (!hayFiltrado) {
+            hayFiltrado = true;
+            ultimoFiltrado = timestampMs;
+            return false;
+        }
+        if (timestampMs - ultimoFiltrado < INTERVALO_FILTRADO) return false;
+        ultimoFiltrado = timestampMs;
+        return hayDatos();
+    }
+
+    // Como tocaFiltrar(), cada INTERVALO_ENVIO y solo con una prediccion hecha
+    bool tocaEnviar(uint64_t timestampMs) {
+        if (nivel < 0) return false;
+        if (!hayEnvio) {
+            hayEnvio = true;
+            ultimoEnvio = timestampMs;
+            return true;
+        }
+        if (timestampMs - ultimoEnvio < INTERVALO_ENVIO) return false;
+        ultimoEnvio = timestampMs;
+        return true;
+    }
+
+#if USAR_PUNTO_FIJO
+    DatosFijos filtradosFijos() const {
+  #if MOTOR_FILTRO == MOTOR_KALMAN
+        DatosFijos d = {aFijo(kalman[0].nivel()), aFijo(kalman[1].nivel()),
+                        aFijo(kalman[2].nivel(), PRESION_BASE_FIJO)};
+  #else
+        DatosFijos d = {historialTemperatura.media(), historialHumedad.media(), historialPresion.media()};
+  #endif
+        return d;
+    }
+#endif
+
+    void medias(float (&valores)[3]) const {
+#if USAR_PUNTO_FIJO
+        DatosFijos d = filtradosFijos();
+        valores[0] = desdeFijo(d.temperatura);
+        valores[1] = desdeFijo(d.humedad);
+        valores[2] = desdeFijo(d.presion, PRESION_BASE_FIJO);
+#elif MOTOR_FILTRO == MOTOR_KALMAN
+        for (int i = 0; i < 3; i++) valores[i] = kalman[i].nivel();
+#else
+        valores[0] = historialTemperatura.media();
+        valores[1] = historialHumedad.media();
+        valores[2] = historialPresion.media();
+#endif
+    }
+
+    int predecir() {
+#if USAR_PUNTO_FIJO
+        DatosFijos d = filtradosFijos();
+  #if MOTOR_FILTRO == MOTOR_KALMAN
+        puntos = puntosRiesgoFijo(d, tendenciaAFijo(kalman[1].tasa()), tendenciaAFijo(kalman[2].tasa()));
+  #else
+        puntos = puntosRiesgoFijo(d, historialHumedad.pendienteMilesimas(), historialPresion.pendienteMilesimas());
+  #endif
+        return nivelAlertaFijo(puntos, d);
+#else
+        EntradaRiesgo e = caracteristicas();
+        puntos = puntosRiesgo(e.temperatura, e.humedad, e.presion, e.tendenciaHumedad, e.tendenciaPresion);
+        return nivelAlerta(puntos, e.humedad, e.presion);
+#endif
+    }
+
+    // Lo que ven las reglas de riesgo, en float tambien con punto fijo
+    // (barrido_umbrales.h las evalua con umbrales que cambian en ejecucion)
+    EntradaRiesgo caracteristicas() const {
+        float valores[3];
+        medias(valores);
+        EntradaRiesgo e = {valores[0], valores[1], valores[2], 0, 0};
+#if MOTOR_FILTRO == MOTOR_KALMAN
+        e.tendenciaHumedad = kalman[1].tasa();
+        e.tendenciaPresion = kalman[2].tasa();
+#elif USAR_PUNTO_FIJO
+        e.tendenciaHumedad = historialHumedad.pendienteMilesimas() / 1000.0f;
+        e.tendenciaPresion = historialPresion.pendienteMilesimas() / 1000.0f;
+#else
+        e.tendenciaHumedad = historialHumedad.pendiente();
+        e.tendenciaPresion = historialPresion.pendiente();
+#endif
+        return e;
+    }
+};
+
+struct ResumenReproduccion {
+    unsigned long long lecturas = 0;
+    unsigned long long invalidas = 0;
+    unsigned long long atipicas = 0;
+    unsigned long long lineasIgnoradas = 0;
+    unsigned long long predicciones = 0;
+    unsigned long long cambios = 0;
+    unsigned long long alertas[3] = {0, 0, 0};
+    unsigned long long envios = 0;        // evaluaciones de la politica de reporte
+    unsigned long long reportadas = 0;
+    float errorMaximo[3] = {0, 0, 0};     // T, H, P reconstruidas por el backend
+};
+
+class ReproductorTrazas {
+private:
+    unordered_map<string, EstacionReproducida> estaciones;
+    // Las trazas suelen venir agrupadas por estacion: se evita buscar en el
+    // mapa mientras no cambie
+    string idActual;
+    EstacionReproducida* actual = nullptr;
+
+    FILE* lineaTiempo;
+    ResumenReproduccion resumen;
+
+    EstacionReproducida& estacion(string_view id) {
+        if (actual && id == idActual) return *actual;
+        idActual.assign(id.data(), id.size());
+        actual = &estaciones[idActual];   // unordered_map no invalida referencias
+        return *actual;
+    }
+
+public:
+    explicit ReproductorTrazas(FILE* salidaLineaTiempo) : lineaTiempo(salidaLineaTiempo) {
+        if (lineaTiempo) fprintf(lineaTiempo, "timestamp_ms,estacion,nivel_anterior,nivel,puntos\n");
+    }
+
+    const ResumenReproduccion& estadisticas() const { return resumen; }
+    size_t numEstaciones() const { return estaciones.size(); }
+
+    void procesar(const LecturaTraza& l) {
+        resumen.lecturas++;
+        EstacionReproducida& e = estacion(l.estacion);
+        if (EstacionReproducida::valida(l)) {
+            if (e.agregar(l)) resumen.atipicas++;
+        } else {
+            resumen.invalidas++;
+        }
+
+        if (e.tocaFiltrar(l.timestampMs)) predecir(e, l);
+        if (e.tocaEnviar(l.timestampMs)) evaluarReporte(e, l.timestampMs);
+    }
+
+    void lineaIgnorada() { resumen.lineasIgnoradas++; }
+
+private:
+    void predecir(EstacionReproducida& e, const LecturaTraza& l) {
+        int nivel = e.predecir();
+        resumen.predicciones++;
+        resumen.alertas[nivel]++;
+        if (nivel != e.nivel) {
+            if (e.nivel >= 0) resumen.cambios++;
+            if (lineaTiempo) {
+                fprintf(lineaTiempo, "%llu,%.*s,%d,%d,%d\n", (unsigned long long)l.timestampMs,
+                        (int)l.estacion.size(), l.estacion.data(), e.nivel, nivel, e.puntos);
+            }
+            e.nivel = nivel;
+        }
+    }
+
+    void evaluarReporte(EstacionReproducida& e, uint64_t timestampMs) {
+        float valores[3];
+        e.medias(valores);
+        resumen.envios++;
+        if (e.politica.evaluar(valores[0], valores[1], valores[2], e.nivel, (unsigned long)timestampMs) !=
+            REPORTE_SUPRIMIDO) {
+            resumen.reportadas++;
+            for (int i = 0; i < 3; i++) e.reconstruida[i] = valores[i];
+            return;
+        }
+        for (int i = 0; i < 3; i++) {
+            float error = fabsf(valores[i] - e.reconstruida[i]);
+            if (error > resumen.errorMaximo[i]) resumen.errorMaximo[i] = error;
+        }
+    }
+};
+
+// Numero decimal sin exponente ("-12.34"); avanza p. Mas rapido que strtof
+// y suficiente para las lecturas con dos decimales de los registros
+inline bool leerDecimal(const char*& p, const char* fin, float& valor) {
+    static const double POTENCIAS[] = {1, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+    bool negativo = false;
+    if (p < fin && (*p == '-' || *p == '+')) negativo = *p++ == '-';
+
+    uint64_t mantisa = 0;
+    int decimales = 0;
+    const char* inicio = p;
+    while (p < fin && *p >= '0' && *p <= '9') mantisa = mantisa * 10 + (*p++ - '0');
+    if (p < fin && *p == '.') {
+        p++;
+        while (p < fin && *p >= '0' && *p <= '9') {
+            if (decimales < 9) {
+                mantisa = mantisa * 10 + (*p - '0');
+                decimales++;
+            }
+            p++;
+        }
+    }
+    if (p == inicio) return false;
+    double v = mantisa / POTENCIAS[decimales];
+    valor = (float)(negativo ? -v : v);
+    return true;
+}
+
+inline bool leerEntero(const char*& p, const char* fin, uint64_t& valor) {
+    const char* inicio = p;
+    valor = 0;
+    while (p < fin && *p >= '0' && *p <= '9') valor = valor * 10 + (*p++ - '0');
+    return p != inicio;
+}
+
+inline bool saltarComa(const char*& p, const char* fin) {
+    while (p < fin && *p == ' ') p++;
+    if (p >= fin || *p != ',') return false;
+    p++;
+    while (p < fin && *p == ' ') p++;
+    return true;
+}
+
+// Destino: ReproductorTrazas o cualquier clase con procesar(LecturaTraza) y
+// lineaIgnorada() (ExtractorCaracteristicas en barrido_umbrales.h)
+template <class Destino>
+inline void reproducirCsv(const char* p, const char* fin, Destino& reproductor) {
+    while (p < fin) {
+        const char* finLinea = static_cast<const char*>(memchr(p, '\n', fin - p));
+        if (!finLinea) finLinea = fin;
+        const char* siguiente = finLinea + (finLinea < fin ? 1 : 0);
+        if (finLinea > p && finLinea[-1] == '\r') finLinea--;
+
+        LecturaTraza l;
+        const char* c = p;
+        bool ok = leerEntero(c, finLinea, l.timestampMs) && saltarComa(c, finLinea) &&
+                  leerDecimal(c, finLinea, l.temperatura) && saltarComa(c, finLinea) &&
+                  leerDecimal(c, finLinea, l.humedad) && saltarComa(c, finLinea) &&
+                  leerDecimal(c, finLinea, l.presion) && saltarComa(c, finLinea);
+        if (ok) {
+            const char* finId = finLinea;
+            while (finId > c && finId[-1] == ' ') finId--;
+            l.estacion = string_view(c, finId - c);
+            reproductor.procesar(l);
+        } else if (finLinea > p) {
+            reproductor.lineaIgnorada();   // cabecera o linea corrupta
+        }
+        p = siguiente;
+    }
+}
+
+// Devuelve false si encuentra una trama corrupta
+template <class Destino>
+inline bool reproducirBinario(const uint8_t* p, const uint8_t* fin, Destino& reproductor) {
+    LecturaBinaria lecturas[255];
+    char id[256];
+    while (p < fin) {
+        uint8_t n = 0;
+        size_t consumidos = decodificarTramaBinaria(p, fin - p, id, sizeof(id), lecturas, 255, n);
+        if (consumidos == 0) return false;
+        string_view estacion(id);
+        for (uint8_t i = 0; i < n; i++) {
+            LecturaTraza l = {lecturas[i].timestampMs, lecturas[i].temperatura, lecturas[i].humedad,
+                              lecturas[i].presion, estacion};
+            reproductor.procesar(l);
+        }
+        p += consumidos;
+    }
+    return true;
+}
+
+// Reconoce el formato por los primeros bytes y pasa cada lectura al
+// destino. Devuelve false si la traza binaria esta truncada o corrupta
+inline bool esTrazaBinaria(const ArchivoMapeado& traza) {
+    return traza.size() >= 2 && traza.data()[0] == 'R' && traza.data()[1] == 'S';
+}
+
+template <class Destino>
+inline bool recorrerTraza(const ArchivoMapeado& traza, Destino& destino) {
+    const uint8_t* inicio = traza.data();
+    const uint8_t* fin = inicio + traza.size();
+    if (esTrazaBinaria(traza)) return reproducirBinario(inicio, fin, destino);
+    reproducirCsv(reinterpret_cast<const char*>(inicio), reinterpret_cast<const char*>(fin), destino);
+    return true;
+}
+
+// Devuelve false si la traza no se pudo abrir o leer entera
+inline bool reproducirTraza(const string& ruta, const string& rutaLineaTiempo) {
+    ArchivoMapeado traza;
+    if (!traza.abrir(ruta)) {
+        fprintf(stderr, "ERROR: no se pudo abrir la traza %s\n", ruta.c_str());
+        return false;
+    }
+
+    FILE* salida = stdout;
+    if (!rutaLineaTiempo.empty()) {
+        salida = fopen(rutaLineaTiempo.c_str(), "w");
+        if (!salida) {
+            fprintf(stderr, "ERROR: no se pudo crear %s\n", rutaLineaTiempo.c_str());
+            return false;
+        }
+    }
+    // La linea de tiempo puede tener millones de filas: buffer grande
+    static char bufferSalida[1 << 20];
+    setvbuf(salida, bufferSalida, _IOFBF, sizeof(bufferSalida));
+
+    bool binario = esTrazaBinaria(traza);
+    ReproductorTrazas reproductor(salida);
+    auto t0 = chrono::steady_clock::now();
+    bool completa = recorrerTraza(traza, reproductor);
+    double segundos = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    fflush(salida);
+    if (salida != stdout) fclose(salida);
+
+    // El resumen va a stderr para no mezclarse con la linea de tiempo
+    const ResumenReproduccion& r = reproductor.estadisticas();
+    fprintf(stderr, "====================================\n");
+    fprintf(stderr, "REPRODUCCION %s (%s, %.1f MB)%s\n", ruta.c_str(), binario ? "binario" : "CSV",
+            traza.size() / 1e6, USAR_PUNTO_FIJO ? " [punto fijo]" : "");
+    fprintf(stderr, "====================================\n");
+    fprintf(stderr, "Estaciones: %zu  Lecturas: %llu  Invalidas: %llu  Atipicas: %llu  Lineas ignoradas: %llu\n",
+            reproductor.numEstaciones(), r.lecturas, r.invalidas, r.atipicas, r.lineasIgnoradas);
+    fprintf(stderr, "Predicciones: %llu  alertas[N/A/R]=%llu/%llu/%llu  Cambios de nivel: %llu\n",
+            r.predicciones, r.alertas[0], r.alertas[1], r.alertas[2], r.cambios);
+    const BandasReporte bandas;
+    fprintf(stderr, "Reporte por banda (%.2f/%.2f/%.2f, latido %lu s): %llu de %llu envios (%.1f%%), "
+            "error max T/H/P=%.2f/%.2f/%.2f\n", bandas.temperatura, bandas.humedad, bandas.presion,
+            bandas.latidoMs / 1000, r.reportadas, r.envios, r.envios > 0 ? 100.0 * r.reportadas / r.envios : 0.0,
+            r.errorMaximo[0], r.errorMaximo[1], r.errorMaximo[2]);
+    fprintf(stderr, "Tiempo: %.3f s  Rendimiento: %.0f lecturas/s (%.0f MB/s)\n", segundos,
+            segundos > 0 ? r.lecturas / segundos : 0.0, segundos > 0 ? traza.size() / 1e6 / segundos : 0.0);
+    if (!completa) fprintf(stderr, "AVISO: traza binaria truncada o corrupta\n");
+    return completa;
+}
+
+#endif
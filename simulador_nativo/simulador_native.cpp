@@ -1,524 +1,356 @@
-#include <iostream>
-#include <string>
 #include <cstdlib>
 #include <ctime>
-#include <thread>
-#include <chrono>
-#include <vector>
-#include <cmath>
-#include <iomanip>
-#include <sstream>
-#include <curl/curl.h>
-#include <json/json.h>
-
-using namespace std;
-
-// ======================
-// CONFIGURACION
-// ======================
-const unsigned long INTERVALO_LECTURA = 5000;
-const unsigned long INTERVALO_FILTRADO = 30000;
-const unsigned long INTERVALO_ENVIO = 60000;
-
-// Configuración de la API
-const string API_URL = "http://localhost:4000/api/sensores";
-const string API_KEY = "tu-api-key-aqui";
-
-// ======================
-// FUNCIONES UTILITARIAS MEJORADAS
-// ======================
-// Función para obtener timestamp UNIX en MILISEGUNDOS
-unsigned long long getUnixTimestampMillis() {
-    auto now = chrono::system_clock::now();
-    auto duration = now.time_since_epoch();
-    return chrono::duration_cast<chrono::milliseconds>(duration).count();
-}
-
-// Función para redondear a 2 decimales
-float roundToTwoDecimals(float value) {
-    return roundf(value * 100.0f) / 100.0f;
-}
-
-// Función para formatear float con precisión (para display)
-string formatFloat(float value, int precision = 2) {
-    stringstream ss;
-    ss << fixed << setprecision(precision) << value;
-    return ss.str();
-}
+#include <memory>
+#include "arduino_nativo.h"
+#include "config_nativo.h"
+#include "componentes_nativo.h"
+#include "http_backend_nativo.h"
+#include "estacion_nativa.h"
+#include "flota.h"
+#include "flota_pipeline.h"
+#include "cola_persistente.h"
+#include "comparacion_formatos.h"
+#include "precision_punto_fijo.h"
+#include "reproduccion_trazas.h"
+#include "generador_carga.h"
+#include "barrido_umbrales.h"
 
 // ======================
-// SIMULACION DE ARDUINO
+// OPCIONES DE LINEA DE COMANDOS
 // ======================
-unsigned long millis() {
-    static auto start = chrono::steady_clock::now();
-    auto now = chrono::steady_clock::now();
-    return chrono::duration_cast<chrono::milliseconds>(now - start).count();
-}
-
-void delay(unsigned long ms) {
-    this_thread::sleep_for(chrono::milliseconds(ms));
-}
-
-class SerialClass {
-public:
-    void begin(int baud) { 
-        cout << "Serial iniciado a " << baud << " baudios" << endl; 
-    }
-    void println(const string& msg) { cout << msg << endl; }
-    void print(const string& msg) { cout << msg; }
-    void println(float value) { 
-        cout << fixed << setprecision(2) << value << endl;
-        cout.unsetf(ios::fixed);
-    }
-    void print(float value) { 
-        cout << fixed << setprecision(2) << value;
-        cout.unsetf(ios::fixed);
-    }
-    void println(int value) { cout << value << endl; }
-    void print(int value) { cout << value; }
-    // Nuevo método para imprimir float con precisión personalizada
-    void print(float value, int precision) { 
-        cout << fixed << setprecision(precision) << value;
-        cout.unsetf(ios::fixed);
+// Se imprime ante una opcion desconocida o sin su valor
+static const char* const USO =
+    "Uso: simulador_native [--flota N] [--hilos M] [--duracion SEG] [--sin-envio] [--semilla S]\n"
+    "                      [--lote N] [--lote-bytes B] [--lote-latencia MS] [--async MAX_EN_VUELO]\n"
+    "                      [--outbox ARCHIVO] [--outbox-capacidad N] [--formato json|binario]\n"
+    "                      [--reloj-virtual] [--metricas ARCHIVO] [--metricas-intervalo SEG]\n"
+    "                      [--conexiones N] [--http2] [--reporte bandas|continuo]\n"
+    "                      [--bandas T,H,P] [--latido SEG] [--filtro media|mediana|hampel]\n"
+    "                      [--motor ventana|kalman] [--pipeline [M,A,E]] [--cola-etapa N]\n"
+    "     simulador_native --comparar-formatos [N]\n"
+    "     simulador_native --precision-punto-fijo [N]\n"
+    "     simulador_native --reproducir TRAZA [--linea-tiempo ARCHIVO]\n"
+    "     simulador_native --barrido TRAZA --eventos LLUVIA [--aleatorio N] [--hilos N]\n"
+    "                      (opciones completas en barrido_umbrales.h)\n"
+    "     simulador_native --carga [--hilos N] [--duracion SEG] [--solicitudes N] [--ritmo SOL_S]\n"
+    "                      [--lote N] [--formato json|binario] [--reintentos N]\n"
+    "                      [--espera-reintento MS] [--conexiones N]\n";
+
+// --pipeline reparte muestreo, analitica y envio en M, A y E hilos
+// (flota_pipeline.h); sin --flota simula una sola estacion.
+// Devuelve false (tras imprimir USO) si una opcion no se reconoce, le
+// falta el valor o no es uno de los listados; en flota queda si se pidio
+// el modo flota
+static bool leerOpciones(int argc, char* argv[], ConfigFlota& config, bool& flota) {
+    flota = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hayValor = i + 1 < argc;
+        bool valido = true;
+        if (arg == "--flota" && hayValor) {
+            flota = true;
+            config.estaciones = atoi(argv[++i]);
+        } else if (arg == "--hilos" && hayValor) {
+            config.hilos = atoi(argv[++i]);
+        } else if (arg == "--duracion" && hayValor) {
+            config.duracionMs = strtoul(argv[++i], nullptr, 10) * 1000UL;
+        } else if (arg == "--semilla" && hayValor) {
+            config.semilla = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--lote" && hayValor) {
+            config.usarLote = true;
+            config.lote.maxLecturas = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--lote-bytes" && hayValor) {
+            config.lote.maxBytes = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--lote-latencia" && hayValor) {
+            config.lote.maxLatenciaMs = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--async" && hayValor) {
+            config.maxEnVuelo = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--conexiones" && hayValor) {
+            config.conexiones.maxConexiones = strtol(argv[++i], nullptr, 10);
+        } else if (arg == "--http2") {
+            config.conexiones.http2 = true;
+        } else if (arg == "--outbox" && hayValor) {
+            config.rutaCola = argv[++i];
+        } else if (arg == "--outbox-capacidad" && hayValor) {
+            config.capacidadCola = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--formato" && hayValor) {
+            string formato = argv[++i];
+            valido = formato == "json" || formato == "binario";
+            config.formatoBinario = formato == "binario";
+        } else if (arg == "--reporte" && hayValor) {
+            string reporte = argv[++i];
+            valido = reporte == "bandas" || reporte == "continuo";
+            config.reportePorBanda = reporte == "bandas";
+        } else if (arg == "--bandas" && hayValor) {
+            sscanf(argv[++i], "%f,%f,%f", &config.bandas.temperatura, &config.bandas.humedad,
+                   &config.bandas.presion);
+        } else if (arg == "--latido" && hayValor) {
+            config.bandas.latidoMs = strtoul(argv[++i], nullptr, 10) * 1000UL;
+        } else if (arg == "--filtro" && hayValor) {
+            string modo = argv[++i];
+            if (modo == "media") config.filtro = FILTRO_MEDIA;
+            else if (modo == "mediana") config.filtro = FILTRO_MEDIANA;
+            else if (modo == "hampel") config.filtro = FILTRO_HAMPEL;
+            else valido = false;
+        } else if (arg == "--motor" && hayValor) {
+            string motor = argv[++i];
+            if (motor == "ventana") config.motor = MOTOR_VENTANA;
+            else if (motor == "kalman") config.motor = MOTOR_KALMAN;
+            else valido = false;
+        } else if (arg == "--pipeline") {
+            config.pipeline = true;
+            if (hayValor && argv[i + 1][0] != '-') {
+                sscanf(argv[++i], "%u,%u,%u", &config.hilosMuestreo, &config.hilosAnalitica, &config.hilosEnvio);
+            }
+        } else if (arg == "--cola-etapa" && hayValor) {
+            config.capacidadEtapa = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--metricas" && hayValor) {
+            config.rutaMetricas = argv[++i];
+        } else if (arg == "--metricas-intervalo" && hayValor) {
+            config.intervaloMetricasMs = strtoul(argv[++i], nullptr, 10) * 1000UL;
+        } else if (arg == "--sin-envio") {
+            config.enviar = false;
+        } else if (arg == "--reloj-virtual") {
+            config.relojVirtual = true;
+        } else if (arg == "--carga") {
+            // El resto de --carga lo lee leerOpcionesCarga()
+        } else if ((arg == "--solicitudes" || arg == "--ritmo" || arg == "--reintentos" ||
+                    arg == "--espera-reintento") && hayValor) {
+            i++;
+        } else {
+            cerr << "Opcion desconocida o sin valor: " << arg << "\n" << USO;
+            return false;
+        }
+        if (!valido) {
+            cerr << "Valor no valido para " << arg << ": " << argv[i] << "\n" << USO;
+            return false;
+        }
     }
-    void println(float value, int precision) { 
-        cout << fixed << setprecision(precision) << value << endl;
-        cout.unsetf(ios::fixed);
+    // Con reloj virtual un resumen cada 10 s simulados seria ilegible
+    if (config.relojVirtual) config.intervaloResumenMs = 3600000;
+    if (config.pipeline && !flota) {
+        flota = true;
+        config.estaciones = 1;
     }
-};
-
-SerialClass Serial;
-
-// ======================
-// ESTRUCTURAS DE DATOS
-// ======================
-struct SensorData {
-    float temperatura;
-    float humedad;
-    float presion;
-    unsigned long timestamp;
-};
-
-struct FilteredData {
-    float temperatura;
-    float humedad;
-    float presion;
-};
+    flota = flota && config.estaciones > 0;
+    return true;
+}
 
-// ======================
-// FUNCIÓN DE CALLBACK PARA CURL
-// ======================
-size_t WriteCallback(void* contents, size_t size, size_t nmemb, string* response) {
-    size_t totalSize = size * nmemb;
-    response->append((char*)contents, totalSize);
-    return totalSize;
+// Los modos de analisis se eligen por su opcion, en cualquier posicion, y
+// solo aceptan las suyas
+static bool pideModo(int argc, char* argv[], const char* opcion) {
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == opcion) return true;
+    }
+    return false;
 }
 
-// ======================
-// CLASE HttpClientBackend CORREGIDA
-// ======================
-class HttpClientBackend {
-private:
-    CURL* curl;
-    string responseBuffer;
-    
-public:
-    void begin() {
-        curl_global_init(CURL_GLOBAL_DEFAULT);
-        curl = curl_easy_init();
-        if (curl) {
-            Serial.println("HttpClientBackend inicializado (conexion real)");
+// --reproducir TRAZA [--linea-tiempo ARCHIVO]
+static bool leerOpcionesReproduccion(int argc, char* argv[], string& rutaTraza, string& rutaLineaTiempo) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hayValor = i + 1 < argc;
+        if (arg == "--reproducir" && hayValor) {
+            rutaTraza = argv[++i];
+        } else if (arg == "--linea-tiempo" && hayValor) {
+            rutaLineaTiempo = argv[++i];
         } else {
-            Serial.println("ERROR: No se pudo inicializar CURL");
-        }
-    }
-    
-    ~HttpClientBackend() {
-        if (curl) {
-            curl_easy_cleanup(curl);
+            cerr << "Opcion de --reproducir desconocida o sin valor: " << arg << "\n" << USO;
+            return false;
         }
-        curl_global_cleanup();
     }
+    return true;
+}
 
-    bool sendData(float temperatura, float humedad, float presion, int alerta) {
-        if (!curl) {
-            Serial.println("ERROR: CURL no inicializado");
-            return false;
-        }
-        
-        // REDONDEAR VALORES A 2 DECIMALES
-        float temp_rounded = roundToTwoDecimals(temperatura);
-        float hum_rounded = roundToTwoDecimals(humedad);
-        float pres_rounded = roundToTwoDecimals(presion);
-        
-        // Crear JSON con valores redondeados y timestamp en MILISEGUNDOS
-        Json::Value jsonData;
-        jsonData["sensor_id"] = "ARDUINO_TROPICAL_01";
-        jsonData["timestamp"] = static_cast<Json::Int64>(getUnixTimestampMillis()); // MILISEGUNDOS
-        jsonData["temperatura"] = temp_rounded;
-        jsonData["humedad"] = hum_rounded;
-        jsonData["presion"] = pres_rounded;
-        jsonData["alerta"] = alerta;
-        jsonData["modo"] = "simulacion_nativo";
-        
-        // Convertir JSON a string con indentación
-        Json::StreamWriterBuilder writer;
-        writer["indentation"] = "  ";
-        string jsonString = Json::writeString(writer, jsonData);
-        
-        // Mostrar información en consola - CORREGIDO
-        Serial.println("ENVIANDO A API REAL:");
-        Serial.println("URL: " + API_URL);
-        Serial.println("TIMESTAMP (ms): " + to_string(getUnixTimestampMillis()));
-        
-        // Mostrar datos redondeados usando el nuevo método
-        Serial.print("DATOS REDONDEADOS: T=");
-        Serial.print(temp_rounded, 2);  // Ahora funciona con el nuevo método
-        Serial.print("°C, H=");
-        Serial.print(hum_rounded, 2);   // Ahora funciona con el nuevo método
-        Serial.print("%, P=");
-        Serial.print(pres_rounded, 2);  // Ahora funciona con el nuevo método
-        Serial.println(" hPa");
-        
-        Serial.println("JSON: " + jsonString);
-        
-        // Configurar la solicitud HTTP
-        struct curl_slist* headers = NULL;
-        headers = curl_slist_append(headers, "Content-Type: application/json");
-        headers = curl_slist_append(headers, ("X-API-Key: " + API_KEY).c_str());
-        
-        curl_easy_setopt(curl, CURLOPT_URL, API_URL.c_str());
-        curl_easy_setopt(curl, CURLOPT_POST, 1L);
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, jsonString.c_str());
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, jsonString.length());
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBuffer);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
-        
-        responseBuffer.clear();
-        
-        // Realizar la solicitud
-        CURLcode res = curl_easy_perform(curl);
-        
-        curl_slist_free_all(headers);
-        
-        if (res != CURLE_OK) {
-            Serial.println("ERROR en envio HTTP: " + string(curl_easy_strerror(res)));
+// --comparar-formatos [N] y --precision-punto-fijo [N]: la opcion y un
+// numero de lecturas opcional (0 = el valor por defecto del modo)
+static bool leerOpcionesMuestras(int argc, char* argv[], const char* opcion, size_t& n) {
+    n = 0;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg != opcion) {
+            cerr << "Opcion de " << opcion << " desconocida: " << arg << "\n" << USO;
             return false;
         }
-        
-        // Obtener código de respuesta HTTP
-        long http_code = 0;
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
-        
-        Serial.println("Respuesta HTTP: " + to_string(http_code));
-        
-        // Formatear respuesta JSON
-        if (!responseBuffer.empty()) {
-            try {
-                Json::Value jsonResponse;
-                Json::CharReaderBuilder readerBuilder;
-                string errors;
-                stringstream responseStream(responseBuffer);
-                
-                if (Json::parseFromStream(readerBuilder, responseStream, &jsonResponse, &errors)) {
-                    Json::StreamWriterBuilder responseWriter;
-                    responseWriter["indentation"] = "  ";
-                    string formattedResponse = Json::writeString(responseWriter, jsonResponse);
-                    Serial.println("Body respuesta (formateado):");
-                    Serial.println(formattedResponse);
-                } else {
-                    Serial.println("Body respuesta: " + responseBuffer);
-                }
-            } catch (...) {
-                Serial.println("Body respuesta: " + responseBuffer);
+        if (i + 1 < argc && argv[i + 1][0] != '-') {
+            char* fin;
+            n = strtoul(argv[++i], &fin, 10);
+            if (fin == argv[i] || *fin != '\0') {
+                cerr << "Valor no valido para " << arg << ": " << argv[i] << "\n" << USO;
+                return false;
             }
         }
-        
-        if (http_code >= 200 && http_code < 300) {
-            Serial.println("Datos enviados correctamente al backend");
-            return true;
-        } else {
-            Serial.println("Error en respuesta del servidor");
-            return false;
-        }
     }
-};
+    return true;
+}
 
 // ======================
-// CLASE SensorController
+// PROGRAMA PRINCIPAL
 // ======================
-class SensorController {
-public:
-    void begin() {
-        Serial.println("SensorController inicializado (simulacion)");
+int main(int argc, char* argv[]) {
+    if (pideModo(argc, argv, "--reproducir")) {
+        string rutaTraza, rutaLineaTiempo;
+        if (!leerOpcionesReproduccion(argc, argv, rutaTraza, rutaLineaTiempo)) return 2;
+        return reproducirTraza(rutaTraza, rutaLineaTiempo) ? 0 : 1;
     }
 
-    SensorData readSensors() {
-        SensorData data;
-        data.timestamp = millis();
-        
-        float baseHumedad = 40 + (rand() % 6000) / 100.0;
-        
-        if (baseHumedad > 80) {
-            data.presion = 1000.0 + (rand() % 1500) / 100.0;
-            data.temperatura = 18.0 + (rand() % 1500) / 100.0;
-        } else if (baseHumedad > 60) {
-            data.presion = 1010.0 + (rand() % 1500) / 100.0;
-            data.temperatura = 22.0 + (rand() % 1800) / 100.0;
-        } else {
-            data.presion = 1015.0 + (rand() % 1500) / 100.0;
-            data.temperatura = 25.0 + (rand() % 2000) / 100.0;
+    if (pideModo(argc, argv, "--barrido")) {
+        ConfigBarrido configBarrido;
+        if (!leerOpcionesBarrido(argc, argv, configBarrido)) {
+            cerr << USO;
+            return 2;
         }
-        
-        data.humedad = max(30.0f, min(100.0f, baseHumedad));
-        
-        Serial.print("SIMULACION - T:");
-        Serial.print(data.temperatura);
-        Serial.print("C H:");
-        Serial.print(data.humedad);
-        Serial.print("% P:");
-        Serial.print(data.presion);
-        Serial.println("hPa");
-        
-        return data;
+        return barrerUmbrales(configBarrido) ? 0 : 1;
     }
-};
 
-// ======================
-// CLASE DataFilter
-// ======================
-class DataFilter {
-private:
-    vector<float> historialTemperatura;
-    vector<float> historialHumedad;
-    vector<float> historialPresion;
-    const int MAX_HISTORIAL = 20;
-
-public:
-    void addData(float temp, float hum, float pres) {
-        historialTemperatura.push_back(temp);
-        historialHumedad.push_back(hum);
-        historialPresion.push_back(pres);
-        
-        if (historialTemperatura.size() > MAX_HISTORIAL) {
-            historialTemperatura.erase(historialTemperatura.begin());
-            historialHumedad.erase(historialHumedad.begin());
-            historialPresion.erase(historialPresion.begin());
-        }
+    size_t muestras;
+    if (pideModo(argc, argv, "--comparar-formatos")) {
+        if (!leerOpcionesMuestras(argc, argv, "--comparar-formatos", muestras)) return 2;
+        compararFormatos(muestras);
+        return 0;
     }
-
-    FilteredData filter() {
-        FilteredData result = {0, 0, 0};
-        
-        if (historialTemperatura.empty()) {
-            return result;
-        }
-
-        float sumaTemp = 0, sumaHum = 0, sumaPres = 0;
-        for (size_t i = 0; i < historialTemperatura.size(); i++) {
-            sumaTemp += historialTemperatura[i];
-            sumaHum += historialHumedad[i];
-            sumaPres += historialPresion[i];
-        }
-
-        result.temperatura = sumaTemp / historialTemperatura.size();
-        result.humedad = sumaHum / historialHumedad.size();
-        result.presion = sumaPres / historialPresion.size();
-
-        Serial.print("FILTRADO - T:");
-        Serial.print(result.temperatura);
-        Serial.print("C H:");
-        Serial.print(result.humedad);
-        Serial.print("% P:");
-        Serial.print(result.presion);
-        Serial.println("hPa");
-
-        return result;
+    if (pideModo(argc, argv, "--precision-punto-fijo")) {
+        if (!leerOpcionesMuestras(argc, argv, "--precision-punto-fijo", muestras)) return 2;
+        return compararPuntoFijo(muestras) ? 0 : 1;
     }
 
-    float calculateHumidityTrend() {
-        if (historialHumedad.size() < 2) return 0;
-        
-        float sumaX = 0, sumaY = 0, sumaXY = 0, sumaX2 = 0;
-        int n = historialHumedad.size();
-        
-        for (int i = 0; i < n; i++) {
-            sumaX += i;
-            sumaY += historialHumedad[i];
-            sumaXY += i * historialHumedad[i];
-            sumaX2 += i * i;
+    ConfigFlota configFlota;
+    configFlota.semilla = time(NULL);
+    bool modoFlota;
+    if (!leerOpciones(argc, argv, configFlota, modoFlota)) return 2;
+    if (configFlota.relojVirtual) activarRelojVirtual();
+
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--carga") {
+            Serial.silenciar(true);
+            ConfigCarga configCarga(configFlota);
+            leerOpcionesCarga(argc, argv, configCarga);
+            GeneradorCarga generador(configCarga);
+            generador.ejecutar();
+            return 0;
         }
-        
-        float pendiente = (n * sumaXY - sumaX * sumaY) / (n * sumaX2 - sumaX * sumaX);
-        
-        Serial.print("   Tendencia humedad: ");
-        Serial.println(pendiente);
-        return pendiente;
     }
 
-    float calculatePressureTrend() {
-        if (historialPresion.size() < 2) return 0;
-        
-        float sumaX = 0, sumaY = 0, sumaXY = 0, sumaX2 = 0;
-        int n = historialPresion.size();
-        
-        for (int i = 0; i < n; i++) {
-            sumaX += i;
-            sumaY += historialPresion[i];
-            sumaXY += i * historialPresion[i];
-            sumaX2 += i * i;
-        }
-        
-        float pendiente = (n * sumaXY - sumaX * sumaY) / (n * sumaX2 - sumaX * sumaX);
-        
-        Serial.print("   Tendencia presion: ");
-        Serial.println(pendiente);
-        return pendiente;
+    if (modoFlota && configFlota.pipeline) {
+        Serial.silenciar(true);
+        SimuladorPipeline pipeline(configFlota);
+        pipeline.ejecutar();
+        return 0;
     }
-};
-
-// ======================
-// CLASE PredictionEngine
-// ======================
-class PredictionEngine {
-public:
-    int predict(float temperatura, float humedad, float presion, float tendenciaHumedad, float tendenciaPresion) {
-        int nivelAlerta = 0;
-        int puntosRiesgo = 0;
-
-        if (humedad > 85) puntosRiesgo += 3;
-        else if (humedad > 75) puntosRiesgo += 2;
-        else if (humedad > 65) puntosRiesgo += 1;
-
-        if (presion < 1005) puntosRiesgo += 3;
-        else if (presion < 1010) puntosRiesgo += 2;
-        else if (presion < 1015) puntosRiesgo += 1;
-
-        if (tendenciaHumedad > 0.4) puntosRiesgo += 2;
-        else if (tendenciaHumedad > 0.2) puntosRiesgo += 1;
-
-        if (tendenciaPresion < -0.3) puntosRiesgo += 3;
-        else if (tendenciaPresion < -0.1) puntosRiesgo += 2;
-
-        if (temperatura < 25) puntosRiesgo += 1;
-
-        if (puntosRiesgo >= 8 || (humedad > 90 && presion < 1010)) {
-            nivelAlerta = 2;
-            Serial.println("PREDICCION: ALERTA ROJA - Lluvia inminente");
-        }
-        else if (puntosRiesgo >= 5) {
-            nivelAlerta = 1;
-            Serial.println("PREDICCION: ALERTA AMARILLA - Posible lluvia");
-        }
-        else {
-            nivelAlerta = 0;
-            Serial.println("PREDICCION: NORMAL - Condiciones estables");
-        }
-
-        Serial.print("   Puntos de riesgo: ");
-        Serial.println(puntosRiesgo);
-
-        return nivelAlerta;
+    if (modoFlota) {
+        Serial.silenciar(true);
+        SimuladorFlota flota(configFlota);
+        flota.ejecutar();
+        return 0;
     }
-};
 
-// ======================
-// PROGRAMA PRINCIPAL
-// ======================
-int main() {
-    srand(time(NULL));
-    
-    // Instancias
-    SensorController sensorController;
-    DataFilter dataFilter;
-    PredictionEngine predictionEngine;
+    // Instancias. conexiones vive mas que el backend y el transporte
+    ConexionesHttp conexiones(configFlota.conexiones);
+    Estacion estacion("ARDUINO_TROPICAL_01", configFlota.semilla);
+    estacion.configurarReporte(configFlota.reportePorBanda, configFlota.bandas);
+    estacion.configurarFiltro(configFlota.filtro, configFlota.motor);
     HttpClientBackend httpBackend;
-    
-    FilteredData datosFiltrados;
-    unsigned long ultimaLectura = 0;
-    unsigned long ultimoFiltrado = 0;
-    unsigned long ultimoEnvio = 0;
-
-    // Funciones locales
-    auto leerSensores = [&]() {
-        auto datos = sensorController.readSensors();
-        if (datos.temperatura > 0 && datos.humedad > 0) {
-            dataFilter.addData(datos.temperatura, datos.humedad, datos.presion);
-        }
-    };
-
-    auto filtrarDatos = [&]() {
-        datosFiltrados = dataFilter.filter();
-        if (datosFiltrados.humedad > 0) {
-            float tendenciaHumedad = dataFilter.calculateHumidityTrend();
-            float tendenciaPresion = dataFilter.calculatePressureTrend();
-            predictionEngine.predict(datosFiltrados.temperatura, datosFiltrados.humedad, 
-                                   datosFiltrados.presion, tendenciaHumedad, tendenciaPresion);
-        }
+    httpBackend.usarFormatoBinario(configFlota.formatoBinario);
+
+    // Cola persistente opcional: lo que falla se guarda y se reenvia
+    ColaPersistente cola;
+    unique_ptr<ReenvioPendientes> reenvio;
+    if (!configFlota.rutaCola.empty() && cola.abrir(configFlota.rutaCola, configFlota.capacidadCola)) {
+        reenvio.reset(new ReenvioPendientes(cola));
+        LOG_INFO("Cola persistente: %s (%zu lecturas pendientes)", configFlota.rutaCola.c_str(), cola.size());
+    }
+    estacion.alTerminarEnvio = [&reenvio](const LecturaLote& lectura, bool exito) {
+        if (reenvio) reenvio->registrarResultado(lectura, exito);
     };
 
-    auto enviarAlBackend = [&]() {
-        if (datosFiltrados.humedad > 0) {
-            float tendenciaHumedad = dataFilter.calculateHumidityTrend();
-            float tendenciaPresion = dataFilter.calculatePressureTrend();
-            int alerta = predictionEngine.predict(datosFiltrados.temperatura, datosFiltrados.humedad, 
-                                                datosFiltrados.presion, tendenciaHumedad, tendenciaPresion);
-            
-            // Redondear los datos ANTES de enviar
-            float temp_redondeada = roundToTwoDecimals(datosFiltrados.temperatura);
-            float hum_redondeada = roundToTwoDecimals(datosFiltrados.humedad);
-            float pres_redondeada = roundToTwoDecimals(datosFiltrados.presion);
-            
-            // Ahora envía a la API real
-            bool exito = httpBackend.sendData(temp_redondeada, hum_redondeada, pres_redondeada, alerta);
-            
-            if (exito) {
-                Serial.println("Envio exitoso a la API");
-            } else {
-                Serial.println(" Fallo en el envio a la API");
-            }
-            
-            Serial.println("------------------------------------");
-        }
-    };
+    LoteEnvios loteEnvios(httpBackend, configFlota.lote, [&reenvio](const LecturaLote& lectura, bool exito) {
+        if (exito) LOG_DEPURACION("Lectura enviada en lote: %s @%llu", lectura.sensorId.c_str(), lectura.timestamp);
+        else LOG_AVISO("Lectura fallida en lote: %s @%llu", lectura.sensorId.c_str(), lectura.timestamp);
+        if (reenvio) reenvio->registrarResultado(lectura, exito);
+    });
+    LoteEnvios* lote = configFlota.usarLote ? &loteEnvios : nullptr;
+    unique_ptr<TransporteAsync> transporte;
+    if (configFlota.maxEnVuelo > 0) {
+        transporte.reset(new TransporteAsync(configFlota.maxEnVuelo, 1024, &conexiones));
+        httpBackend.usarTransporte(transporte.get());
+    }
 
     // SETUP
     Serial.begin(9600);
     
-    Serial.println("====================================");
-    Serial.println("MODO SIMULACION CON API REAL");
-    Serial.println("====================================");
-    Serial.println("API destino: " + API_URL);
-    Serial.println("Precisión: 2 decimales");
-    Serial.println("Timestamp: UNIX en milisegundos");
-    Serial.println("====================================");
+    LOG_INFO("====================================");
+    LOG_INFO("MODO SIMULACION CON API REAL");
+    LOG_INFO("====================================");
+    LOG_INFO("API destino: %s", API_URL.c_str());
+    LOG_INFO("Precisión: 2 decimales");
+    LOG_INFO("Timestamp: UNIX en milisegundos");
+    LOG_INFO("====================================");
 
-    sensorController.begin();
-    httpBackend.begin();
+    estacion.begin();
+    httpBackend.begin(&conexiones);
 
     // LOOP
-    while (true) {
-        unsigned long tiempoActual = millis();
-        
-        if (tiempoActual - ultimaLectura >= INTERVALO_LECTURA) {
-            ultimaLectura = tiempoActual;
-            leerSensores();
+    HttpClientBackend* backend = configFlota.enviar ? &httpBackend : nullptr;
+    if (!backend) lote = nullptr;
+    unsigned long lecturas = 0, descartadas = 0, reportadas = 0, suprimidas = 0, atipicas = 0, alertas[3] = {0, 0, 0};
+    unsigned long ultimasMetricas = 0;
+    auto inicioReal = chrono::steady_clock::now();
+
+    while (configFlota.duracionMs == 0 || millis() < configFlota.duracionMs) {
+        unsigned long inicioTick = millis();
+        ResultadoTick r = estacion.tick(inicioTick, backend, lote);
+        if (r.leyo) lecturas++;
+        if (r.descartada) descartadas++;
+        if (r.reportada) reportadas++;
+        if (r.suprimida) suprimidas++;
+        if (r.atipica) atipicas++;
+        if (r.alerta >= 0 && r.alerta <= 2) alertas[r.alerta]++;
+        if (lote) lote->revisar();
+        if (reenvio && backend) reenvio->revisar(httpBackend);
+        if (!configFlota.rutaMetricas.empty() && inicioTick - ultimasMetricas >= configFlota.intervaloMetricasMs) {
+            ultimasMetricas = inicioTick;
+            metricas.escribir(configFlota.rutaMetricas, inicioTick);
         }
-        
-        if (tiempoActual - ultimoFiltrado >= INTERVALO_FILTRADO) {
-            ultimoFiltrado = tiempoActual;
-            filtrarDatos();
-        }
-        
-        if (tiempoActual - ultimoEnvio >= INTERVALO_ENVIO) {
-            ultimoEnvio = tiempoActual;
-            enviarAlBackend();
+
+        // Se duerme hasta el siguiente vencimiento de la estacion, del lote
+        // abierto o del reintento de la cola persistente
+        unsigned long siguiente = estacion.proximoEvento(millis());
+        unsigned long limite;
+        if (lote && lote->vencimiento(limite)) siguiente = min(siguiente, limite);
+        if (reenvio && backend && reenvio->vencimiento(limite)) siguiente = min(siguiente, limite);
+        siguiente = max(siguiente, inicioTick + 1);
+        if (configFlota.duracionMs > 0) siguiente = min(siguiente, configFlota.duracionMs);
+
+        if (configFlota.relojVirtual) {
+            // La red no consume tiempo simulado: se completa lo que este en
+            // vuelo y se salta directamente al vencimiento
+            if (transporte) {
+                while (!transporte->ocioso()) transporte->procesar(100);
+            }
+            avanzarRelojHasta(siguiente);
+        } else if (transporte) {
+            // Con transporte asincrono la espera atiende la red; un backend
+            // lento ya no retrasa la siguiente lectura
+            transporte->procesarHasta(siguiente);
+        } else {
+            unsigned long ahora = millis();
+            if ((long)(siguiente - ahora) > 0) delay(siguiente - ahora);
         }
-        
-        delay(1000);
     }
-    
+
+    // Solo se llega aqui con --duracion
+    if (lote) lote->enviar();
+    if (transporte) {
+        while (!transporte->ocioso()) transporte->procesar(100);
+    }
+    if (!configFlota.rutaMetricas.empty()) metricas.escribir(configFlota.rutaMetricas, millis());
+    double real = chrono::duration<double>(chrono::steady_clock::now() - inicioReal).count();
+    vaciarRegistro();
+    cout << "RESUMEN t=" << millis() / 1000 << "s lecturas=" << lecturas
+         << " descartadas=" << descartadas
+         << " reportadas=" << reportadas << " suprimidas=" << suprimidas << " atipicas=" << atipicas
+         << " alertas[N/A/R]=" << alertas[0] << "/" << alertas[1] << "/" << alertas[2]
+         << " (" << real << "s reales)" << endl;
+
     return 0;
-}
\ No newline at end of file
+}
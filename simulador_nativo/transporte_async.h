@@ -0,0 +1,260 @@
+#ifndef TRANSPORTE_ASYNC_H
+#define TRANSPORTE_ASYNC_H
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <curl/curl.h>
+#include "arduino_nativo.h"
+#include "config_nativo.h"
+#include "conexiones_http.h"
+#include "metricas_nativo.h"
+
+using namespace std;
+
+// ======================
+// TRANSPORTE HTTP ASINCRONO (curl_multi)
+// ======================
+// Los POST se lanzan sobre un handle multi y avanzan cada vez que el bucle
+// principal llama a procesar(); nunca se bloquea esperando a la red. Hay
+// un maximo de solicitudes en vuelo: las que no caben esperan en una cola
+// acotada y, si esta tambien se llena, fallan de inmediato (backpressure).
+// Cada solicitud termina siempre por su callback, con exito o con error.
+// Las conexiones quedan abiertas en la cache del multi entre solicitudes;
+// conexiones_http.h fija el tope por host y el uso de HTTP/2. Las
+// solicitudes terminadas se reciclan con sus buffers: en regimen, encolar
+// un POST no pide memoria salvo la del callback.
+typedef function<void(bool transporteOk, long httpCode, const string& respuesta)> FinSolicitud;
+
+// Etapa HTTP de las metricas: el tiempo total que mide curl (conexion,
+// envio y respuesta), no el que la solicitud pasa en la cola
+inline void registrarTiempoHttp(CURL* easy) {
+    curl_off_t totalUs = 0;
+    if (curl_easy_getinfo(easy, CURLINFO_TOTAL_TIME_T, &totalUs) == CURLE_OK) {
+        metricas.registrar(ETAPA_HTTP, (uint32_t)totalUs);
+    }
+}
+
+class TransporteAsync {
+private:
+    struct Solicitud {
+        CURL* easy = nullptr;
+        string cuerpo;
+        string respuesta;
+        FinSolicitud alTerminar;
+        bool binario = false;
+    };
+
+    CURLM* multi = nullptr;
+    const ConexionesHttp* conexiones;
+    curl_slist* headers = nullptr;
+    curl_slist* headersBinario = nullptr;
+    size_t maxEnVuelo;
+    size_t maxEnEspera;
+
+    deque<unique_ptr<Solicitud>> enEspera;
+    vector<unique_ptr<Solicitud>> enVuelo;
+    vector<unique_ptr<Solicitud>> solicitudesLibres;
+    vector<CURL*> handlesLibres;    // se reutilizan para no crear uno por POST
+
+    unsigned long long completadas = 0;
+    unsigned long long rechazadas = 0;
+
+    static size_t escribirRespuesta(void* datos, size_t size, size_t nmemb, void* destino) {
+        size_t total = size * nmemb;
+        static_cast<string*>(destino)->append(static_cast<char*>(datos), total);
+        return total;
+    }
+
+public:
+    explicit TransporteAsync(size_t maxSolicitudesEnVuelo = 16, size_t maxSolicitudesEnEspera = 1024,
+                             const ConexionesHttp* conexionesHttp = nullptr)
+        : conexiones(conexionesHttp),
+          maxEnVuelo(maxSolicitudesEnVuelo > 0 ? maxSolicitudesEnVuelo : 1),
+          maxEnEspera(maxSolicitudesEnEspera) {
+        static once_flag curlIniciado;
+        call_once(curlIniciado, [] { curl_global_init(CURL_GLOBAL_DEFAULT); });
+
+        multi = curl_multi_init();
+        // Por defecto la cache guarda 4 conexiones por handle anadido al
+        // multi y encoge al retirarlos, cerrando conexiones que el
+        // siguiente lote de solicitudes volveria a abrir
+        curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, (long)maxEnVuelo);
+        if (conexiones) conexiones->configurarMulti(multi);
+        headers = curl_slist_append(headers, "Content-Type: application/json");
+        headers = curl_slist_append(headers, ("X-API-Key: " + API_KEY).c_str());
+        headersBinario = curl_slist_append(headersBinario, "Content-Type: application/x-rainsense");
+        headersBinario = curl_slist_append(headersBinario, ("X-API-Key: " + API_KEY).c_str());
+    }
+
+    ~TransporteAsync() {
+        for (auto& s : enVuelo) {
+            curl_multi_remove_handle(multi, s->easy);
+            curl_easy_cleanup(s->easy);
+        }
+        for (CURL* easy : handlesLibres) curl_easy_cleanup(easy);
+        curl_multi_cleanup(multi);
+        curl_slist_free_all(headers);
+        curl_slist_free_all(headersBinario);
+    }
+
+    TransporteAsync(const TransporteAsync&) = delete;
+    TransporteAsync& operator=(const TransporteAsync&) = delete;
+
+    size_t solicitudesEnVuelo() const { return enVuelo.size(); }
+    size_t solicitudesEnEspera() const { return enEspera.size(); }
+    bool ocioso() const { return enVuelo.empty() && enEspera.empty(); }
+    unsigned long long totalCompletadas() const { return completadas; }
+    unsigned long long totalRechazadas() const { return rechazadas; }
+
+    // Encola un POST a API_URL; alTerminar se llama desde procesar(). El
+    // cuerpo se intercambia con el buffer de una solicitud reciclada: a la
+    // vuelta queda vacio, con capacidad para componer el siguiente
+    void enviar(string& cuerpo, FinSolicitud alTerminar, bool binario = false) {
+        if (enVuelo.size() >= maxEnVuelo && enEspera.size() >= maxEnEspera) {
+            rechazadas++;
+            alTerminar(false, 0, "cola de envio llena");
+            return;
+        }
+
+        unique_ptr<Solicitud> s = obtenerSolicitud();
+        s->cuerpo.swap(cuerpo);
+        cuerpo.clear();
+        s->alTerminar = move(alTerminar);
+        s->binario = binario;
+        enEspera.push_back(move(s));
+        lanzarPendientes();
+    }
+
+    // Avanza las transferencias sin bloquear mas de esperaMs y entrega las
+    // respuestas terminadas a sus callbacks
+    void procesar(int esperaMs = 0) {
+        int activos = 0;
+        curl_multi_perform(multi, &activos);
+        recogerTerminadas();
+
+        if (esperaMs > 0 && !enVuelo.empty()) {
+            curl_multi_poll(multi, nullptr, 0, esperaMs, nullptr);
+            curl_multi_perform(multi, &activos);
+            recogerTerminadas();
+        }
+        lanzarPendientes();
+    }
+
+    // Procesa la red hasta el instante limite (en millis()). Sirve de
+    // sustituto de delay(): la espera se aprovecha para las transferencias
+    void procesarHasta(unsigned long limite) {
+        while (true) {
+            unsigned long ahora = millis();
+            if ((long)(limite - ahora) <= 0) break;
+            unsigned long restante = limite - ahora;
+            if (enVuelo.empty()) {
+                delay(restante);
+                break;
+            }
+            procesar((int)restante);
+        }
+        procesar(0);
+    }
+
+private:
+    unique_ptr<Solicitud> obtenerSolicitud() {
+        if (solicitudesLibres.empty()) return unique_ptr<Solicitud>(new Solicitud());
+        unique_ptr<Solicitud> s = move(solicitudesLibres.back());
+        solicitudesLibres.pop_back();
+        return s;
+    }
+
+    void reciclar(unique_ptr<Solicitud> s) {
+        s->easy = nullptr;
+        s->respuesta.clear();
+        s->alTerminar = nullptr;
+        solicitudesLibres.push_back(move(s));
+    }
+
+    CURL* obtenerHandle() {
+        if (!handlesLibres.empty()) {
+            CURL* easy = handlesLibres.back();
+            handlesLibres.pop_back();
+            return easy;
+        }
+        return curl_easy_init();
+    }
+
+    void lanzarPendientes() {
+        while (enVuelo.size() < maxEnVuelo && !enEspera.empty()) {
+            unique_ptr<Solicitud> s = move(enEspera.front());
+            enEspera.pop_front();
+
+            s->easy = obtenerHandle();
+            if (!s->easy) {
+                s->alTerminar(false, 0, "no se pudo crear el handle CURL");
+                reciclar(move(s));
+                continue;
+            }
+
+            curl_easy_setopt(s->easy, CURLOPT_URL, API_URL.c_str());
+            curl_easy_setopt(s->easy, CURLOPT_POST, 1L);
+            curl_easy_setopt(s->easy, CURLOPT_POSTFIELDS, s->cuerpo.c_str());
+            curl_easy_setopt(s->easy, CURLOPT_POSTFIELDSIZE, (long)s->cuerpo.size());
+            curl_easy_setopt(s->easy, CURLOPT_HTTPHEADER, s->binario ? headersBinario : headers);
+            curl_easy_setopt(s->easy, CURLOPT_WRITEFUNCTION, escribirRespuesta);
+            curl_easy_setopt(s->easy, CURLOPT_WRITEDATA, &s->respuesta);
+            curl_easy_setopt(s->easy, CURLOPT_TIMEOUT, 10L);
+            curl_easy_setopt(s->easy, CURLOPT_NOSIGNAL, 1L);
+            curl_easy_setopt(s->easy, CURLOPT_PRIVATE, s.get());
+            if (conexiones) conexiones->configurar(s->easy);
+
+            curl_multi_add_handle(multi, s->easy);
+            enVuelo.push_back(move(s));
+        }
+    }
+
+    void recogerTerminadas() {
+        CURLMsg* msg;
+        int restantes = 0;
+        while ((msg = curl_multi_info_read(multi, &restantes))) {
+            if (msg->msg != CURLMSG_DONE) continue;
+
+            CURL* easy = msg->easy_handle;
+            CURLcode res = msg->data.result;
+            Solicitud* s = nullptr;
+            curl_easy_getinfo(easy, CURLINFO_PRIVATE, (char**)&s);
+
+            registrarTiempoHttp(easy);
+            contarConexiones(easy);
+            long httpCode = 0;
+            if (res == CURLE_OK) {
+                curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &httpCode);
+            }
+            curl_multi_remove_handle(multi, easy);
+
+            // Sacar la solicitud de la lista antes del callback: este puede
+            // encolar nuevos envios
+            unique_ptr<Solicitud> terminada;
+            for (size_t i = 0; i < enVuelo.size(); i++) {
+                if (enVuelo[i].get() == s) {
+                    terminada = move(enVuelo[i]);
+                    enVuelo[i] = move(enVuelo.back());
+                    enVuelo.pop_back();
+                    break;
+                }
+            }
+
+            curl_easy_reset(easy);
+            handlesLibres.push_back(easy);
+            completadas++;
+
+            if (terminada) {
+                terminada->alTerminar(res == CURLE_OK, httpCode,
+                                      res == CURLE_OK ? terminada->respuesta : string(curl_easy_strerror(res)));
+                reciclar(move(terminada));
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,247 @@
+#ifndef AGREGADOS_MULTIRESOLUCION_H
+#define AGREGADOS_MULTIRESOLUCION_H
+
+#include <stdint.h>
+#include <math.h>
+#include "config.h"
+#include "ventana_estadistica.h"
+
+// ======================
+// AGREGADOS MULTIRESOLUCION
+// ======================
+// Minimo, maximo, media, desviacion tipica y pendiente de cada variable a
+// tres escalas, sin guardar el historial crudo:
+// - 1 min: ventana deslizante de las ultimas MUESTRAS_POR_MINUTO lecturas
+// - 10 min: las ultimas 10 cubetas de un minuto cerradas
+// - 1 h: las ultimas 6 cubetas de diez minutos cerradas
+// Cada cubeta resume sus muestras (n, media y M2 de Welford, minimo y
+// maximo) y al cerrarse pasa al nivel siguiente, asi que la memoria es
+// fija (~700 bytes por variable) y agregar una lectura cuesta O(1)
+// amortizado. Los extremos de cada nivel salen de colas monotonas; media
+// y desviacion combinan sus cubetas (Chan) al consultar, y la pendiente
+// es la recta de minimos cuadrados sobre las medias de las cubetas. Las
+// pendientes se dan siempre por minuto.
+// Sin STL ni Arduino: la misma clase en el AVR y en el simulador.
+const uint8_t MUESTRAS_POR_MINUTO = (uint8_t)(60000UL / INTERVALO_LECTURA);
+const uint8_t MINUTOS_POR_DECENA = 10;
+const uint8_t DECENAS_POR_HORA = 6;
+
+enum VariableMedida : uint8_t {
+  VARIABLE_TEMPERATURA,
+  VARIABLE_HUMEDAD,
+  VARIABLE_PRESION,
+  NUM_VARIABLES
+};
+
+enum NivelResolucion : uint8_t {
+  RESOLUCION_1MIN,
+  RESOLUCION_10MIN,
+  RESOLUCION_1H,
+  NUM_RESOLUCIONES
+};
+
+struct ResumenVentana {
+  float minimo;
+  float maximo;
+  float media;
+  float desviacion;
+  float pendiente;      // unidades por minuto
+  uint16_t muestras;    // 0: el nivel aun no tiene datos
+};
+
+// Muestras resumidas por Welford; dos cubetas se combinan sin perder
+// precision (formula de Chan), a diferencia de restar sumas de cuadrados
+struct CubetaAgregada {
+  uint16_t n;
+  float media;
+  float m2;
+  float minimo;
+  float maximo;
+
+  void reiniciar() {
+    n = 0;
+    media = 0;
+    m2 = 0;
+  }
+
+  void agregar(float valor) {
+    if (n == 0 || valor < minimo) minimo = valor;
+    if (n == 0 || valor > maximo) maximo = valor;
+    n++;
+    float delta = valor - media;
+    media += delta / n;
+    m2 += delta * (valor - media);
+  }
+
+  void combinar(const CubetaAgregada& otra) {
+    if (otra.n == 0) return;
+    if (n == 0) {
+      *this = otra;
+      return;
+    }
+    uint16_t total = n + otra.n;
+    float delta = otra.media - media;
+    media += delta * otra.n / total;
+    m2 += otra.m2 + delta * delta * ((float)n * otra.n / total);
+    if (otra.minimo < minimo) minimo = otra.minimo;
+    if (otra.maximo > maximo) maximo = otra.maximo;
+    n = total;
+  }
+
+  float desviacion() const {
+    if (n < 2) return 0;
+    float v = m2 / (n - 1);
+    return v > 0 ? sqrtf(v) : 0;
+  }
+};
+
+// Extremo (minimo o maximo) de una ventana deslizante de K elementos.
+// Solo guarda los candidatos: los que llegan despues y son mejores
+// descartan a los anteriores, asi que el frente siempre es el extremo.
+// secuencia numera los elementos; tolera la vuelta del contador (K < 256)
+template <uint8_t K, bool MAXIMOS>
+class ColaMonotona {
+private:
+  float valores[K];
+  uint8_t secuencias[K];
+  uint8_t inicio = 0;
+  uint8_t cantidad = 0;
+
+  // Sin modulo: en el AVR la division de 8 bits es una llamada
+  uint8_t posicion(uint8_t i) const {
+    uint8_t p = inicio + i;
+    return p >= K ? p - K : p;
+  }
+
+public:
+  // El elemento secuencia entra y sale el secuencia - K
+  void agregar(uint8_t secuencia, float valor) {
+    while (cantidad > 0 && (uint8_t)(secuencia - secuencias[inicio]) >= K) {
+      inicio = posicion(1);
+      cantidad--;
+    }
+    while (cantidad > 0) {
+      float ultimo = valores[posicion(cantidad - 1)];
+      if (MAXIMOS ? ultimo > valor : ultimo < valor) break;
+      cantidad--;
+    }
+    uint8_t p = posicion(cantidad);
+    valores[p] = valor;
+    secuencias[p] = secuencia;
+    cantidad++;
+  }
+
+  bool vacia() const { return cantidad == 0; }
+  float frente() const { return valores[inicio]; }
+};
+
+// Ventana de las ultimas K cubetas cerradas de un mismo tamano
+template <uint8_t K>
+class NivelAgregado {
+private:
+  CubetaAgregada cubetas[K];
+  uint8_t inicio = 0;
+  uint8_t cantidad = 0;
+  uint8_t secuencia = 0;
+  ColaMonotona<K, false> minimos;
+  ColaMonotona<K, true> maximos;
+
+public:
+  void agregar(const CubetaAgregada& cubeta) {
+    if (cantidad == K) {
+      cubetas[inicio] = cubeta;
+      if (++inicio == K) inicio = 0;
+    } else {
+      cubetas[cantidad] = cubeta;   // inicio sigue en 0 hasta llenarse
+      cantidad++;
+    }
+    minimos.agregar(secuencia, cubeta.minimo);
+    maximos.agregar(secuencia, cubeta.maximo);
+    secuencia++;
+  }
+
+  ResumenVentana resumen(float minutosPorCubeta) const {
+    ResumenVentana r = {0, 0, 0, 0, 0, 0};
+    if (cantidad == 0) return r;
+
+    // Media y desviacion de todas las muestras; pendiente sobre las
+    // medias de las cubetas, en orden cronologico (x = 0 la mas antigua)
+    CubetaAgregada total;
+    total.reiniciar();
+    float sumaY = 0, sumaXY = 0;
+    for (uint8_t i = 0; i < cantidad; i++) {
+      const CubetaAgregada& c = cubetas[(inicio + i) % K];
+      total.combinar(c);
+      sumaY += c.media;
+      sumaXY += i * c.media;
+    }
+    if (cantidad >= 2) {
+      float n = cantidad;
+      float sumaX = n * (n - 1) / 2;
+      float sumaX2 = (n - 1) * n * (2 * n - 1) / 6;
+      r.pendiente = (n * sumaXY - sumaX * sumaY) / (n * sumaX2 - sumaX * sumaX) / minutosPorCubeta;
+    }
+    r.minimo = minimos.frente();
+    r.maximo = maximos.frente();
+    r.media = total.media;
+    r.desviacion = total.desviacion();
+    r.muestras = total.n;
+    return r;
+  }
+};
+
+// Los tres niveles de una variable
+class AgregadosMultiresolucion {
+private:
+  VentanaEstadistica<float, float, MUESTRAS_POR_MINUTO> ultimoMinuto;
+  ColaMonotona<MUESTRAS_POR_MINUTO, false> minimosMinuto;
+  ColaMonotona<MUESTRAS_POR_MINUTO, true> maximosMinuto;
+  uint8_t secuencia = 0;
+
+  CubetaAgregada minutoAbierto;
+  CubetaAgregada decenaAbierta;
+  uint8_t minutosEnDecena = 0;
+  NivelAgregado<MINUTOS_POR_DECENA> decenas;    // cubetas de 1 minuto
+  NivelAgregado<DECENAS_POR_HORA> hora;         // cubetas de 10 minutos
+
+public:
+  AgregadosMultiresolucion() {
+    minutoAbierto.reiniciar();
+    decenaAbierta.reiniciar();
+  }
+
+  void agregar(float valor) {
+    ultimoMinuto.add(valor);
+    minimosMinuto.agregar(secuencia, valor);
+    maximosMinuto.agregar(secuencia, valor);
+    secuencia++;
+
+    minutoAbierto.agregar(valor);
+    if (minutoAbierto.n < MUESTRAS_POR_MINUTO) return;
+    decenas.agregar(minutoAbierto);
+    decenaAbierta.combinar(minutoAbierto);
+    minutoAbierto.reiniciar();
+
+    if (++minutosEnDecena < MINUTOS_POR_DECENA) return;
+    hora.agregar(decenaAbierta);
+    decenaAbierta.reiniciar();
+    minutosEnDecena = 0;
+  }
+
+  ResumenVentana resumen(NivelResolucion nivel) const {
+    if (nivel == RESOLUCION_10MIN) return decenas.resumen(1);
+    if (nivel == RESOLUCION_1H) return hora.resumen(MINUTOS_POR_DECENA);
+
+    ResumenVentana r = {0, 0, 0, 0, 0, 0};
+    if (ultimoMinuto.size() == 0) return r;
+    r.minimo = minimosMinuto.frente();
+    r.maximo = maximosMinuto.frente();
+    r.media = ultimoMinuto.media();
+    r.desviacion = sqrtf(ultimoMinuto.varianza());
+    r.pendiente = ultimoMinuto.pendiente() * MUESTRAS_POR_MINUTO;
+    r.muestras = (uint16_t)ultimoMinuto.size();
+    return r;
+  }
+};
+
+#endif
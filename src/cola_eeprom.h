@@ -0,0 +1,138 @@
+#ifndef COLA_EEPROM_H
+#define COLA_EEPROM_H
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include "config.h"
+#include "http_client.h"
+
+// ======================
+// COLA PERSISTENTE EN EEPROM
+// ======================
+// Buffer circular de lecturas que no se pudieron enviar. Sobrevive a un
+// reinicio y se vacia en bloques de LOTE_MAX_LECTURAS cuando el backend
+// vuelve. Si se llena se sobrescribe la lectura mas antigua.
+//
+// Disposicion: cabecera en COLA_EEPROM_INICIO y a continuacion los
+// registros empaquetados. La cabecera solo se reescribe al agregar o
+// confirmar, y EEPROM.put() no toca los bytes que no cambian.
+struct CabeceraColaEeprom {
+  uint16_t magia;
+  uint8_t inicio;
+  uint8_t cantidad;
+  uint16_t descartados;
+};
+
+struct RegistroColaEeprom {
+  unsigned long timestamp;
+  float temperatura;
+  float humedad;
+  float presion;
+  int8_t alerta;
+};
+
+class ColaEeprom {
+private:
+  static const uint16_t MAGIA = 0x5243;  // "RC"
+  static const uint8_t CAPACIDAD =
+    (COLA_EEPROM_BYTES - sizeof(CabeceraColaEeprom)) / sizeof(RegistroColaEeprom);
+
+  CabeceraColaEeprom cabecera;
+  unsigned long ultimoIntento = 0;
+
+  static int direccion(uint8_t posicion) {
+    return COLA_EEPROM_INICIO + sizeof(CabeceraColaEeprom) + posicion * sizeof(RegistroColaEeprom);
+  }
+
+  void guardarCabecera() {
+    EEPROM.put(COLA_EEPROM_INICIO, cabecera);
+  }
+
+public:
+  void begin() {
+    EEPROM.get(COLA_EEPROM_INICIO, cabecera);
+    if (cabecera.magia != MAGIA || cabecera.inicio >= CAPACIDAD || cabecera.cantidad > CAPACIDAD) {
+      cabecera.magia = MAGIA;
+      cabecera.inicio = 0;
+      cabecera.cantidad = 0;
+      cabecera.descartados = 0;
+      guardarCabecera();
+    }
+    if (cabecera.cantidad > 0) {
+      LOG_INFO("Cola EEPROM: %u lecturas pendientes", (unsigned int)cabecera.cantidad);
+    }
+  }
+
+  uint8_t size() const { return cabecera.cantidad; }
+  bool vacia() const { return cabecera.cantidad == 0; }
+
+  void agregar(const LecturaLote& lectura) {
+    if (cabecera.cantidad == CAPACIDAD) {
+      cabecera.inicio = (cabecera.inicio + 1) % CAPACIDAD;
+      cabecera.cantidad--;
+      cabecera.descartados++;
+    }
+
+    RegistroColaEeprom r = {lectura.timestamp, lectura.temperatura, lectura.humedad,
+                            lectura.presion, (int8_t)lectura.alerta};
+    EEPROM.put(direccion((cabecera.inicio + cabecera.cantidad) % CAPACIDAD), r);
+    cabecera.cantidad++;
+    guardarCabecera();
+  }
+
+  // Copia hasta max lecturas desde la mas antigua, sin retirarlas
+  uint8_t leer(LecturaLote* destino, uint8_t max) const {
+    uint8_t n = min(max, cabecera.cantidad);
+    for (uint8_t i = 0; i < n; i++) {
+      RegistroColaEeprom r;
+      EEPROM.get(direccion((cabecera.inicio + i) % CAPACIDAD), r);
+      destino[i].timestamp = r.timestamp;
+      destino[i].temperatura = r.temperatura;
+      destino[i].humedad = r.humedad;
+      destino[i].presion = r.presion;
+      destino[i].alerta = r.alerta;
+    }
+    return n;
+  }
+
+  void confirmar(uint8_t n) {
+    if (n > cabecera.cantidad) n = cabecera.cantidad;
+    cabecera.inicio = (cabecera.inicio + n) % CAPACIDAD;
+    cabecera.cantidad -= n;
+    guardarCabecera();
+  }
+
+  // Tarea del planificador cada INTERVALO_REVISION. Con el backend caido
+  // prueba un bloque cada INTERVALO_REINTENTO; mientras los acepte sigue
+  // enviando bloques hasta vaciar la cola o agotar PRESUPUESTO_REENVIO
+  void revisar(HttpClientBackend& backend) {
+    if (vacia() || millis() - ultimoIntento < INTERVALO_REINTENTO) return;
+    unsigned long inicio = millis();
+    ultimoIntento = inicio;
+
+    while (!vacia()) {
+      LecturaLote bloque[LOTE_MAX_LECTURAS];
+      uint8_t n = leer(bloque, LOTE_MAX_LECTURAS);
+
+      LOG_INFO("REENVIANDO desde EEPROM: %u", (unsigned int)n);
+
+      // Si no cupo todo en un envio, el resto sigue en la cola
+      uint8_t enviadas = backend.enviarLecturas(bloque, n);
+      if (enviadas == 0) return;
+      confirmar(enviadas);
+
+      if (millis() - inicio >= PRESUPUESTO_REENVIO) {
+        // El backend responde: la proxima revision continua
+        backendDisponible();
+        return;
+      }
+    }
+  }
+
+  // Tras un envio correcto conviene vaciar la cola sin esperar
+  void backendDisponible() {
+    ultimoIntento = millis() - INTERVALO_REINTENTO;
+  }
+};
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include <stdint.h>
+
 // ======================
 // CONFIGURACIÓN MODO
 // ======================
@@ -21,6 +23,148 @@
 const unsigned long INTERVALO_LECTURA = 5000;    // 5 segundos
 const unsigned long INTERVALO_FILTRADO = 30000;  // 30 segundos
 const unsigned long INTERVALO_ENVIO = 60000;     // 1 minuto
+// Revision del lote por latencia y de la cola EEPROM. Con esta holgura
+// se ejecutan al despertar para una lectura, sin despertares propios
+const unsigned long INTERVALO_REVISION = 10000;  // 10 segundos
+const unsigned long HOLGURA_REVISION = 5000;
+
+// ======================
+// CONFIGURACIÓN FILTRO
+// ======================
+const int TAM_VENTANA_FILTRO = 20;  // muestras en la media movil
+
+// true: filtro, tendencias y puntuacion con enteros escalados
+// (punto_fijo.h) en lugar de float. Pensado para el Uno, que no tiene FPU.
+#define USAR_PUNTO_FIJO false
+
+// Etapa robusta antes de la media movil (filtro_robusto.h):
+// - FILTRO_MEDIA: la muestra entra tal cual (una lectura erronea del DHT22
+//   desplaza la media y la tendencia durante toda la ventana)
+// - FILTRO_MEDIANA: entra la mediana de las ultimas TAM_VENTANA_ROBUSTA
+// - FILTRO_HAMPEL: entra la muestra, salvo que se aleje de esa mediana mas
+//   de HAMPEL_UMBRAL_SIGMAS desviaciones robustas; entonces entra la mediana
+#define FILTRO_MEDIA 0
+#define FILTRO_MEDIANA 1
+#define FILTRO_HAMPEL 2
+#define FILTRO_ROBUSTO FILTRO_MEDIA
+const uint8_t TAM_VENTANA_ROBUSTA = 9;           // 45 s: hasta 4 lecturas malas seguidas
+constexpr float HAMPEL_UMBRAL_SIGMAS = 3.0;
+// Distancia a la mediana que nunca se rechaza, aunque la ventana sea casi
+// constante (MAD ~ 0)
+const float HAMPEL_MINIMO_TEMPERATURA = 0.5;     // grados C
+const float HAMPEL_MINIMO_HUMEDAD = 2.0;         // %
+const float HAMPEL_MINIMO_PRESION = 0.5;         // hPa
+
+// Motor que da el valor filtrado y las tendencias a la prediccion:
+// - MOTOR_VENTANA: media y regresion de las ultimas TAM_VENTANA_FILTRO
+// - MOTOR_KALMAN: nivel y tasa de un filtro de Kalman por variable
+//   (filtro_kalman.h), 5 floats cada uno en lugar de la ventana
+#define MOTOR_VENTANA 0
+#define MOTOR_KALMAN 1
+#define MOTOR_FILTRO MOTOR_VENTANA
+// Ruido del sensor y aceleracion esperada por muestra (desviaciones). El
+// cociente 0.02 da una ganancia de ~0.18: alcanza el 90% de un escalon
+// en ~6 muestras, frente a 18 de la ventana de 20
+const float KALMAN_MEDIDA_TEMPERATURA = 0.2;       // grados C
+const float KALMAN_ACELERACION_TEMPERATURA = 0.004;
+const float KALMAN_MEDIDA_HUMEDAD = 0.5;           // %
+const float KALMAN_ACELERACION_HUMEDAD = 0.01;
+const float KALMAN_MEDIDA_PRESION = 0.05;          // hPa
+const float KALMAN_ACELERACION_PRESION = 0.001;
+
+// true: DataFilter mantiene ademas resumenes a 1 min, 10 min y 1 h de
+// cada variable (agregados_multiresolucion.h). Ocupan ~2 KB de RAM, toda
+// la del Uno: ahi quedan desactivados
+#if defined(__AVR_ATmega328P__)
+  #define AGREGADOS_MULTIRESOLUCION false
+#else
+  #define AGREGADOS_MULTIRESOLUCION true
+#endif
+
+// ======================
+// CONFIGURACIÓN LOTES DE ENVIO
+// ======================
+// Las lecturas se agrupan y se suben como un unico array JSON cuando se
+// alcanza cualquiera de los tres limites. LOTE_MAX_LECTURAS = 1 (por
+// defecto) es el envio individual de siempre: un objeto JSON por POST,
+// sin array ni espera. Con mas de 1 el backend debe aceptar arrays.
+const uint8_t LOTE_MAX_LECTURAS = 1;
+const unsigned int LOTE_MAX_BYTES = 512;         // cuerpo JSON
+const unsigned long LOTE_MAX_LATENCIA = 300000;  // 5 minutos
+
+// ======================
+// CONFIGURACIÓN POLITICA DE REPORTE
+// ======================
+// true: cada INTERVALO_ENVIO solo se sube la lectura si alguna variable
+// salio de su banda respecto a la ultima reportada, si cambio la alerta
+// o si vencio el latido (politica_reporte.h). false: se sube siempre,
+// y el backend recibe la serie completa como hasta ahora.
+#define REPORTE_POR_BANDA false
+const float BANDA_TEMPERATURA = 0.2;             // grados C
+const float BANDA_HUMEDAD = 0.5;                 // %
+const float BANDA_PRESION = 0.3;                 // hPa
+const unsigned long INTERVALO_LATIDO = 900000;   // 15 minutos
+
+// ======================
+// CONFIGURACIÓN FORMATO DE ENVIO
+// ======================
+// FORMATO_BINARIO usa las tramas compactas de formato_binario.h
+// (Content-Type: application/x-rainsense) en lugar de JSON.
+#define FORMATO_JSON 0
+#define FORMATO_BINARIO 1
+#define FORMATO_ENVIO FORMATO_JSON
+
+// ======================
+// CONFIGURACIÓN CONEXION HTTP
+// ======================
+// true: el socket con el backend sigue abierto entre envios (Connection:
+// keep-alive) y el siguiente POST lo reutiliza, sin handshake TCP ni
+// cierre por lote. El W5100 solo tiene 4 sockets: la estacion ocupa uno.
+// Si el backend cierra la conexion, el siguiente envio vuelve a conectar.
+#define HTTP_KEEP_ALIVE true
+// Espera maxima por el cuerpo de una respuesta; pasada, se cierra el
+// socket para no reutilizar una conexion a medio leer
+const unsigned long HTTP_TIMEOUT_RESPUESTA = 5000;
+
+// ======================
+// CONFIGURACIÓN METRICAS
+// ======================
+// true: cada lote JSON lleva un objeto "metricas" con la latencia por
+// etapa y los contadores de lecturas perdidas (metricas.h). Ocupa hasta
+// 276 bytes del cuerpo (BYTES_METRICAS_JSON en http_client.h)
+#define ENVIAR_METRICAS false
+// true: la misma lectura lleva "agregados_1h" con el resumen de la ultima
+// hora (requiere AGREGADOS_MULTIRESOLUCION y hasta 252 bytes de cuerpo)
+#define ENVIAR_AGREGADOS false
+
+// ======================
+// CONFIGURACIÓN COLA PERSISTENTE (EEPROM)
+// ======================
+// Las lecturas que no se pudieron enviar se guardan en la EEPROM y se
+// reenvian cuando el backend vuelve a responder.
+const int COLA_EEPROM_INICIO = 0;
+const int COLA_EEPROM_BYTES = 1024;              // EEPROM completa del Uno
+const unsigned long INTERVALO_REINTENTO = 120000; // 2 minutos
+// Tiempo maximo que una revision sigue enviando bloques mientras el
+// backend los acepte. Cada POST bloquea el loop(); lo que no quepa sigue
+// en la revision siguiente (INTERVALO_REVISION), sin esperar el reintento
+const unsigned long PRESUPUESTO_REENVIO = 2000;   // 2 segundos
+
+// ======================
+// CONFIGURACIÓN REGISTRO (LOG)
+// ======================
+// Los mensajes por encima de NIVEL_REGISTRO no se compilan (registro.h).
+// A 9600 baudios cada linea bloquea el loop ~1 ms por caracter: el
+// detalle de cada lectura, filtrado y envio queda en DEPURACION.
+// Se puede subir sin tocar el archivo con -DNIVEL_REGISTRO=4.
+#define REGISTRO_NADA 0
+#define REGISTRO_ERROR 1
+#define REGISTRO_AVISO 2
+#define REGISTRO_INFO 3
+#define REGISTRO_DEPURACION 4
+#ifndef NIVEL_REGISTRO
+  #define NIVEL_REGISTRO REGISTRO_INFO
+#endif
 
 // ======================
 // CONFIGURACIÓN BACKEND (CAMBIADO A extern)
@@ -32,18 +176,28 @@ extern const int BACKEND_PORT;
 // ======================
 // UMBRALES PREDICCIÓN MEJORADOS
 // ======================
-const float HUMEDAD_ALERTA = 85.0;
-const float HUMEDAD_ADVERTENCIA = 75.0;
-const float TENDENCIA_ALERTA = 0.3;
-const float TENDENCIA_ADVERTENCIA = 0.1;
+constexpr float HUMEDAD_ALERTA = 85.0;
+constexpr float HUMEDAD_ADVERTENCIA = 75.0;
+constexpr float TENDENCIA_ALERTA = 0.3;
+constexpr float TENDENCIA_ADVERTENCIA = 0.1;
 
 // NUEVAS CONSTANTES PARA EL SISTEMA MULTIVARIABLE
-const float HUMEDAD_ALERTA_ROJA = 85.0;
-const float HUMEDAD_ALERTA_AMARILLA = 75.0;
-const float PRESION_BAJA_ALERTA = 1005.0;
-const float PRESION_BAJA_ADVERTENCIA = 1010.0;
-const float TENDENCIA_HUMEDAD_ALERTA = 0.4;
-const float TENDENCIA_HUMEDAD_ADVERTENCIA = 0.2;
-const float TENDENCIA_PRESION_ALERTA = -0.3;
+constexpr float HUMEDAD_ALERTA_ROJA = 85.0;
+constexpr float HUMEDAD_ALERTA_AMARILLA = 75.0;
+constexpr float PRESION_BAJA_ALERTA = 1005.0;
+constexpr float PRESION_BAJA_ADVERTENCIA = 1010.0;
+constexpr float TENDENCIA_HUMEDAD_ALERTA = 0.4;
+constexpr float TENDENCIA_HUMEDAD_ADVERTENCIA = 0.2;
+constexpr float TENDENCIA_PRESION_ALERTA = -0.3;
+constexpr float TENDENCIA_PRESION_ADVERTENCIA = -0.1;
+constexpr float HUMEDAD_MODERADA = 65.0;
+constexpr float PRESION_MODERADA = 1015.0;
+constexpr float TEMPERATURA_FRESCA = 25.0;
+
+// Humedad extrema con presion baja es alerta roja sin importar los puntos
+constexpr float HUMEDAD_EXTREMA = 90.0;
+constexpr float PRESION_EXTREMA = 1010.0;
+constexpr int PUNTOS_ALERTA_ROJA = 8;
+constexpr int PUNTOS_ALERTA_AMARILLA = 5;
 
 #endif
\ No newline at end of file
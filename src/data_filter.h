@@ -3,6 +3,14 @@
 
 #include <Arduino.h>
 #include "config.h"
+#include "registro.h"
+#include "ventana_estadistica.h"
+#include "punto_fijo.h"
+#include "filtro_robusto.h"
+#include "filtro_kalman.h"
+#if AGREGADOS_MULTIRESOLUCION
+  #include "agregados_multiresolucion.h"
+#endif
 
 struct FilteredData {
   float temperatura;
@@ -12,75 +20,219 @@ struct FilteredData {
 
 class DataFilter {
 private:
-  float historialTemperatura[20];
-  float historialHumedad[20];
-  float historialPresion[20];
-  int indice = 0;
-  int contador = 0;
+#if MOTOR_FILTRO == MOTOR_KALMAN
+  // Nivel y tasa por variable, sin ventana. En float tambien con
+  // USAR_PUNTO_FIJO: filterFijo() y las tendencias fijas convierten
+  FiltroKalman kalmanTemperatura{KALMAN_MEDIDA_TEMPERATURA, KALMAN_ACELERACION_TEMPERATURA};
+  FiltroKalman kalmanHumedad{KALMAN_MEDIDA_HUMEDAD, KALMAN_ACELERACION_HUMEDAD};
+  FiltroKalman kalmanPresion{KALMAN_MEDIDA_PRESION, KALMAN_ACELERACION_PRESION};
+#elif USAR_PUNTO_FIJO
+  // Enteros escalados (punto_fijo.h): sin soft-float en el filtrado
+  VentanaPuntoFijo<TAM_VENTANA_FILTRO> historialTemperatura;
+  VentanaPuntoFijo<TAM_VENTANA_FILTRO> historialHumedad;
+  VentanaPuntoFijo<TAM_VENTANA_FILTRO> historialPresion;
+#else
+  // Ventanas con sumas y regresion incrementales: filter() y las
+  // tendencias cuestan O(1) sin importar el tamano de la ventana
+  VentanaEstadistica<float, float, TAM_VENTANA_FILTRO> historialTemperatura;
+  VentanaEstadistica<float, float, TAM_VENTANA_FILTRO> historialHumedad;
+  VentanaEstadistica<float, float, TAM_VENTANA_FILTRO> historialPresion;
+#endif
+#if USAR_PUNTO_FIJO
+  typedef int16_t ValorRobusto;
+  typedef int32_t AcumRobusto;
+#else
+  typedef float ValorRobusto;
+  typedef float AcumRobusto;
+#endif
+#if FILTRO_ROBUSTO == FILTRO_MEDIANA
+  typedef MedianaDeslizante<ValorRobusto, AcumRobusto, TAM_VENTANA_ROBUSTA> EtapaRobusta;
+#elif FILTRO_ROBUSTO == FILTRO_HAMPEL
+  typedef FiltroHampel<ValorRobusto, AcumRobusto, TAM_VENTANA_ROBUSTA> EtapaRobusta;
+#endif
+#if FILTRO_ROBUSTO != FILTRO_MEDIA
+  // Antes del motor: la media, la regresion o el Kalman no ven las atipicas
+  EtapaRobusta robustoTemperatura;
+  EtapaRobusta robustoHumedad;
+  EtapaRobusta robustoPresion;
+#endif
+#if AGREGADOS_MULTIRESOLUCION
+  // Contexto de mas largo plazo que la ventana del filtro, sin guardar
+  // las muestras
+  AgregadosMultiresolucion agregados[NUM_VARIABLES];
+#endif
+
+#if FILTRO_ROBUSTO == FILTRO_MEDIANA
+  static ValorRobusto robusto(EtapaRobusta& etapa, ValorRobusto valor, bool&) {
+    etapa.agregar(valor);
+    return etapa.mediana();
+  }
+#elif FILTRO_ROBUSTO == FILTRO_HAMPEL
+  static ValorRobusto robusto(EtapaRobusta& etapa, ValorRobusto valor, bool& atipica) {
+    if (etapa.limpiar(valor)) atipica = true;
+    return valor;
+  }
+#endif
 
 public:
-  void addData(float temp, float hum, float pres) {
-    historialTemperatura[indice] = temp;
-    historialHumedad[indice] = hum;
-    historialPresion[indice] = pres;
-    indice = (indice + 1) % 20;
-    if (contador < 20) contador++;
+#if FILTRO_ROBUSTO == FILTRO_HAMPEL
+  // Los umbrales minimos, en las mismas unidades que la ventana
+  #if USAR_PUNTO_FIJO
+    DataFilter()
+        : robustoTemperatura(aFijo(HAMPEL_MINIMO_TEMPERATURA)),
+          robustoHumedad(aFijo(HAMPEL_MINIMO_HUMEDAD)),
+          robustoPresion(aFijo(HAMPEL_MINIMO_PRESION)) {}
+  #else
+    DataFilter()
+        : robustoTemperatura(HAMPEL_MINIMO_TEMPERATURA),
+          robustoHumedad(HAMPEL_MINIMO_HUMEDAD),
+          robustoPresion(HAMPEL_MINIMO_PRESION) {}
+  #endif
+#endif
+
+  // Devuelve true si alguna variable de la muestra era atipica y entro
+  // en su lugar la mediana (solo con FILTRO_HAMPEL)
+  bool addData(float temp, float hum, float pres) {
+    bool atipica = false;
+#if USAR_PUNTO_FIJO
+    ValorRobusto t = aFijo(temp);
+    ValorRobusto h = aFijo(hum);
+    ValorRobusto p = aFijo(pres, PRESION_BASE_FIJO);
+#else
+    ValorRobusto t = temp;
+    ValorRobusto h = hum;
+    ValorRobusto p = pres;
+#endif
+#if FILTRO_ROBUSTO != FILTRO_MEDIA
+    t = robusto(robustoTemperatura, t, atipica);
+    h = robusto(robustoHumedad, h, atipica);
+    p = robusto(robustoPresion, p, atipica);
+#endif
+#if MOTOR_FILTRO == MOTOR_KALMAN
+  #if USAR_PUNTO_FIJO
+    kalmanTemperatura.agregar(desdeFijo(t));
+    kalmanHumedad.agregar(desdeFijo(h));
+    kalmanPresion.agregar(desdeFijo(p, PRESION_BASE_FIJO));
+  #else
+    kalmanTemperatura.agregar(t);
+    kalmanHumedad.agregar(h);
+    kalmanPresion.agregar(p);
+  #endif
+#else
+    historialTemperatura.add(t);
+    historialHumedad.add(h);
+    historialPresion.add(p);
+#endif
+#if AGREGADOS_MULTIRESOLUCION
+    // Ya sin atipicas: un pico falso tampoco debe quedar como maximo
+    #if USAR_PUNTO_FIJO
+      agregados[VARIABLE_TEMPERATURA].agregar(desdeFijo(t));
+      agregados[VARIABLE_HUMEDAD].agregar(desdeFijo(h));
+      agregados[VARIABLE_PRESION].agregar(desdeFijo(p, PRESION_BASE_FIJO));
+    #else
+      agregados[VARIABLE_TEMPERATURA].agregar(t);
+      agregados[VARIABLE_HUMEDAD].agregar(h);
+      agregados[VARIABLE_PRESION].agregar(p);
+    #endif
+#endif
+    return atipica;
+  }
+
+#if AGREGADOS_MULTIRESOLUCION
+  ResumenVentana resumen(VariableMedida variable, NivelResolucion nivel) const {
+    return agregados[variable].resumen(nivel);
+  }
+#endif
+
+  bool hayDatos() const {
+#if MOTOR_FILTRO == MOTOR_KALMAN
+    return kalmanTemperatura.iniciadoConDatos();
+#else
+    return historialTemperatura.size() > 0;
+#endif
   }
 
   FilteredData filter() {
     FilteredData result = {0, 0, 0};
-    float sumaTemp = 0, sumaHum = 0, sumaPres = 0;
-    int count = min(contador, 20);
 
-    if (count == 0) return result;
+    if (!hayDatos()) return result;
+
+#if USAR_PUNTO_FIJO
+    DatosFijos medias = filterFijo();
+    result.temperatura = desdeFijo(medias.temperatura);
+    result.humedad = desdeFijo(medias.humedad);
+    result.presion = desdeFijo(medias.presion, PRESION_BASE_FIJO);
+#elif MOTOR_FILTRO == MOTOR_KALMAN
+    result.temperatura = kalmanTemperatura.nivel();
+    result.humedad = kalmanHumedad.nivel();
+    result.presion = kalmanPresion.nivel();
+#else
+    result.temperatura = historialTemperatura.media();
+    result.humedad = historialHumedad.media();
+    result.presion = historialPresion.media();
+#endif
+
+    LOG_DEPURACION("FILTRADO - T:%.1fC H:%.1f%% P:%.1fhPa", result.temperatura, result.humedad, result.presion);
 
-    for (int i = 0; i < count; i++) {
-      sumaTemp += historialTemperatura[i];
-      sumaHum += historialHumedad[i];
-      sumaPres += historialPresion[i];
+    return result;
+  }
+
+#if USAR_PUNTO_FIJO
+  #if MOTOR_FILTRO == MOTOR_KALMAN
+    DatosFijos filterFijo() const {
+      DatosFijos niveles = {aFijo(kalmanTemperatura.nivel()), aFijo(kalmanHumedad.nivel()),
+                            aFijo(kalmanPresion.nivel(), PRESION_BASE_FIJO)};
+      return niveles;
     }
 
-    result.temperatura = sumaTemp / count;
-    result.humedad = sumaHum / count;
-    result.presion = sumaPres / count;
+    int32_t tendenciaHumedadFija() const {
+      return tendenciaAFijo(kalmanHumedad.tasa());
+    }
 
-    Serial.print("FILTRADO - T:");
-    Serial.print(result.temperatura, 1);
-    Serial.print("C H:");
-    Serial.print(result.humedad, 1);
-    Serial.print("% P:");
-    Serial.print(result.presion, 1);
-    Serial.println("hPa");
+    int32_t tendenciaPresionFija() const {
+      return tendenciaAFijo(kalmanPresion.tasa());
+    }
+  #else
+    DatosFijos filterFijo() const {
+      DatosFijos medias = {historialTemperatura.media(), historialHumedad.media(), historialPresion.media()};
+      return medias;
+    }
 
-    return result;
-  }
+    int32_t tendenciaHumedadFija() const {
+      return historialHumedad.pendienteMilesimas();
+    }
+
+    int32_t tendenciaPresionFija() const {
+      return historialPresion.pendienteMilesimas();
+    }
+  #endif
 
   float calculateHumidityTrend() {
-    return calculateTrend(historialHumedad, contador);
+    return tendenciaDesdeFijo(tendenciaHumedadFija());
   }
 
   float calculatePressureTrend() {
-    return calculateTrend(historialPresion, contador);
+    return tendenciaDesdeFijo(tendenciaPresionFija());
+  }
+#elif MOTOR_FILTRO == MOTOR_KALMAN
+  // Tasa del Kalman en lugar de la pendiente de la ventana: mismas
+  // unidades (por muestra) y mismos umbrales
+  float calculateHumidityTrend() {
+    return kalmanHumedad.tasa();
   }
 
-private:
-  float calculateTrend(float* historial, int totalDatos) {
-    if (totalDatos < 2) return 0;
-    
-    float sumaX = 0, sumaY = 0, sumaXY = 0, sumaX2 = 0;
-    int puntos = min(totalDatos, 20);
-
-    for (int i = 0; i < puntos; i++) {
-      float x = i;
-      float y = historial[i];
-      sumaX += x;
-      sumaY += y;
-      sumaXY += x * y;
-      sumaX2 += x * x;
-    }
+  float calculatePressureTrend() {
+    return kalmanPresion.tasa();
+  }
+#else
+  float calculateHumidityTrend() {
+    return historialHumedad.pendiente();
+  }
 
-    return (puntos * sumaXY - sumaX * sumaY) / (puntos * sumaX2 - sumaX * sumaX);
+  float calculatePressureTrend() {
+    return historialPresion.pendiente();
   }
+#endif
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,230 @@
+#ifndef ESCRITOR_JSON_H
+#define ESCRITOR_JSON_H
+
+#include <stdint.h>
+#include <stddef.h>
+#if defined(ARDUINO)
+  #include <Arduino.h>
+#endif
+
+// ======================
+// ESCRITOR JSON SIN HEAP
+// ======================
+// Escribe JSON compacto directamente en un buffer fijo, sin documento
+// intermedio ni String: un JsonDocument y su String por envio fragmentan
+// los 2 KB de RAM del Uno, y en la flota cada lectura costaba unas 26
+// asignaciones. Las comas entre elementos las pone el escritor.
+// - Los reales se escriben con decimales fijos y sin ceros sobrantes
+//   (23.5, no 23.50); NaN, infinito y lo que no cabe en 32 bits, como null
+// - Lo que no cabe no se escribe y queda desbordado(); marca()/volverA()
+//   deshacen lo escrito desde un punto (una lectura que no entra en el
+//   lote, por ejemplo)
+// - Con buffer nulo solo se cuenta el largo, para medir sin escribir
+// Mismo codigo en el AVR y en nativo: sin STL. En el Arduino las claves
+// pueden ir en flash con F().
+class EscritorJson {
+public:
+  struct Marca {
+    size_t largo;
+    uint8_t nivel;
+    uint8_t conElementos;
+    bool trasClave;
+  };
+
+private:
+  char* buffer;
+  size_t capacidad;
+  size_t largo = 0;
+  bool lleno = false;
+  uint8_t nivel = 0;          // objetos y arrays abiertos (hasta 8)
+  uint8_t conElementos = 0;   // un bit por nivel: ya tiene algun elemento
+  bool trasClave = false;     // el siguiente valor va tras "clave":
+
+  void poner(char c) {
+    if (!buffer) {
+      largo++;
+    } else if (!lleno && largo + 1 < capacidad) {
+      buffer[largo++] = c;
+    } else {
+      lleno = true;
+    }
+  }
+
+  void ponerTexto(const char* s) {
+    while (*s) poner(*s++);
+  }
+
+  void separar() {
+    if (trasClave) {
+      trasClave = false;
+      return;
+    }
+    if (nivel == 0) return;
+    uint8_t bit = 1 << ((nivel - 1) & 7);
+    if (conElementos & bit) poner(',');
+    conElementos |= bit;
+  }
+
+  void abrir(char c) {
+    separar();
+    poner(c);
+    nivel++;
+    conElementos &= ~(uint8_t)(1 << ((nivel - 1) & 7));
+  }
+
+  void cerrar(char c) {
+    if (nivel > 0) nivel--;
+    poner(c);
+  }
+
+  void ponerCaracterTexto(char c) {
+    static const char HEX_DIGITOS[] = "0123456789abcdef";
+    if (c == '"' || c == '\\') {
+      poner('\\');
+      poner(c);
+    } else if ((uint8_t)c < 0x20) {
+      ponerTexto("\\u00");
+      poner(HEX_DIGITOS[(uint8_t)c >> 4]);
+      poner(HEX_DIGITOS[c & 0x0F]);
+    } else {
+      poner(c);
+    }
+  }
+
+  void escribirTexto(const char* s) {
+    poner('"');
+    while (*s) ponerCaracterTexto(*s++);
+    poner('"');
+  }
+
+  #if defined(ARDUINO)
+    void escribirTexto(const __FlashStringHelper* f) {
+      const char* s = reinterpret_cast<const char*>(f);
+      poner('"');
+      for (char c = pgm_read_byte(s); c != '\0'; c = pgm_read_byte(++s)) ponerCaracterTexto(c);
+      poner('"');
+    }
+  #endif
+
+  template <class T> void escribirSinSigno(T v) {
+    char digitos[20];
+    uint8_t n = 0;
+    do {
+      digitos[n++] = (char)('0' + v % 10);
+      v /= 10;
+    } while (v > 0);
+    while (n > 0) poner(digitos[--n]);
+  }
+
+public:
+  EscritorJson(char* destino, size_t capacidadDestino) : buffer(destino), capacidad(capacidadDestino) {}
+
+  void abrirObjeto() { abrir('{'); }
+  void cerrarObjeto() { cerrar('}'); }
+  void abrirArray() { abrir('['); }
+  void cerrarArray() { cerrar(']'); }
+
+  void clave(const char* nombre) {
+    separar();
+    escribirTexto(nombre);
+    poner(':');
+    trasClave = true;
+  }
+
+  void texto(const char* valor) {
+    separar();
+    escribirTexto(valor);
+  }
+
+  #if defined(ARDUINO)
+    void clave(const __FlashStringHelper* nombre) {
+      separar();
+      escribirTexto(nombre);
+      poner(':');
+      trasClave = true;
+    }
+
+    void texto(const __FlashStringHelper* valor) {
+      separar();
+      escribirTexto(valor);
+    }
+  #endif
+
+  void entero(long valor) {
+    separar();
+    if (valor < 0) {
+      poner('-');
+      escribirSinSigno((unsigned long)(-(valor + 1)) + 1);
+    } else {
+      escribirSinSigno((unsigned long)valor);
+    }
+  }
+
+  template <class T> void sinSigno(T valor) {
+    separar();
+    escribirSinSigno(valor);
+  }
+
+  void real(double valor, uint8_t decimales = 2) {
+    separar();
+    if (decimales > 6) decimales = 6;
+    uint32_t escala = 1;
+    for (uint8_t i = 0; i < decimales; i++) escala *= 10;
+
+    bool negativo = valor < 0;
+    double escalado = (negativo ? -valor : valor) * escala + 0.5;
+    if (!(escalado < 4294967295.0)) {
+      ponerTexto("null");
+      return;
+    }
+    uint32_t fijo = (uint32_t)escalado;
+    uint32_t fraccion = fijo % escala;
+    if (negativo && fijo > 0) poner('-');
+    escribirSinSigno(fijo / escala);
+
+    uint8_t cifras = decimales;
+    while (cifras > 0 && fraccion % 10 == 0) {
+      fraccion /= 10;
+      cifras--;
+    }
+    if (cifras == 0) return;
+    char digitos[6];
+    for (uint8_t i = cifras; i-- > 0;) {
+      digitos[i] = (char)('0' + fraccion % 10);
+      fraccion /= 10;
+    }
+    poner('.');
+    for (uint8_t i = 0; i < cifras; i++) poner(digitos[i]);
+  }
+
+  void booleano(bool valor) {
+    separar();
+    ponerTexto(valor ? "true" : "false");
+  }
+
+  void nulo() {
+    separar();
+    ponerTexto("null");
+  }
+
+  Marca marca() const { return {largo, nivel, conElementos, trasClave}; }
+
+  void volverA(const Marca& m) {
+    largo = m.largo;
+    nivel = m.nivel;
+    conElementos = m.conElementos;
+    trasClave = m.trasClave;
+    lleno = false;
+  }
+
+  size_t size() const { return largo; }
+  bool desbordado() const { return lleno; }
+
+  // Termina el texto con '\0' (siempre cabe: se reserva un byte)
+  const char* c_str() {
+    if (buffer && capacidad > 0) buffer[largo] = '\0';
+    return buffer;
+  }
+};
+
+#endif
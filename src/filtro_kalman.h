@@ -0,0 +1,77 @@
+#ifndef FILTRO_KALMAN_H
+#define FILTRO_KALMAN_H
+
+#include <stdint.h>
+
+// ======================
+// FILTRO DE KALMAN NIVEL-TASA
+// ======================
+// Alternativa a la ventana de TAM_VENTANA_FILTRO muestras: estima el nivel
+// de una variable y su tasa de cambio (unidades por muestra, las mismas
+// que la pendiente de la ventana) con un modelo de velocidad constante y
+// aceleracion aleatoria. Estado fijo de 5 floats y O(1) por muestra, sin
+// historial: en el Uno sustituye a tres ventanas de 20 muestras.
+//
+//   prediccion: nivel += tasa;  P = F P F' + Q
+//   correccion: K = P H' / (P00 + R);  estado += K (medida - nivel)
+//
+// desviacionMedida es el ruido del sensor; desviacionAceleracion, cuanto
+// puede cambiar la tasa de una muestra a la siguiente. Su cociente fija
+// la ganancia estacionaria: mas aceleracion sigue antes un frente y deja
+// pasar mas ruido. Arranca con la primera medida y converge en pocas
+// muestras en lugar de esperar a llenar una ventana.
+// Sin STL ni Arduino: la misma clase en el AVR y en el simulador.
+class FiltroKalman {
+private:
+  float nivelEstimado = 0;
+  float tasaEstimada = 0;
+  float p00 = 0, p01 = 0, p11 = 0;   // covarianza (simetrica)
+  float r;                           // varianza de la medida
+  float q;                           // varianza de la aceleracion
+  bool iniciado = false;
+
+public:
+  FiltroKalman(float desviacionMedida, float desviacionAceleracion)
+      : r(desviacionMedida * desviacionMedida), q(desviacionAceleracion * desviacionAceleracion) {}
+
+  void agregar(float medida) {
+    if (!iniciado) {
+      // Nivel = primera medida, con la varianza de una medida. La tasa
+      // arranca en 0 con varianza r: una desviacion de la medida por
+      // muestra, muy por encima de las tasas reales, pero acotada para que
+      // el ruido entre las dos primeras medidas no se lea como tendencia
+      nivelEstimado = medida;
+      tasaEstimada = 0;
+      p00 = r;
+      p01 = 0;
+      p11 = r;
+      iniciado = true;
+      return;
+    }
+
+    // Prediccion a una muestra; Q de aceleracion constante por tramos
+    nivelEstimado += tasaEstimada;
+    p00 += 2 * p01 + p11 + q * 0.25f;
+    p01 += p11 + q * 0.5f;
+    p11 += q;
+
+    // Correccion con la medida
+    float s = p00 + r;
+    float k0 = p00 / s;
+    float k1 = p01 / s;
+    float innovacion = medida - nivelEstimado;
+    nivelEstimado += k0 * innovacion;
+    tasaEstimada += k1 * innovacion;
+    p11 -= k1 * p01;
+    p01 -= k0 * p01;
+    p00 -= k0 * p00;
+  }
+
+  bool iniciadoConDatos() const { return iniciado; }
+  float nivel() const { return nivelEstimado; }
+  float tasa() const { return tasaEstimada; }     // unidades por muestra
+
+  void reset() { iniciado = false; }
+};
+
+#endif
@@ -0,0 +1,203 @@
+#ifndef FILTRO_ROBUSTO_H
+#define FILTRO_ROBUSTO_H
+
+#include <stdint.h>
+#include "config.h"
+
+// ======================
+// MEDIANA DESLIZANTE (DOS MONTICULOS)
+// ======================
+// Mediana de las ultimas N muestras con O(log N) por muestra, sin ordenar
+// la ventana en cada llamada. La mitad baja esta en un monticulo de maximo
+// y la alta en uno de minimo; los monticulos guardan ranuras del buffer
+// circular y cada ranura recuerda su posicion. Con la ventana llena la
+// muestra nueva ocupa la ranura de la mas antigua: se recoloca dentro de
+// su monticulo y, si cruzo la frontera, se intercambian las dos cimas.
+// Memoria fija (N valores y 2N bytes de indices), sin heap ni STL: se usa
+// igual en el AVR (T = int16_t en punto fijo) y en el simulador. Acum es
+// el tipo para promediar las dos cimas con N par.
+template <typename T, typename Acum, uint8_t N>
+class MedianaDeslizante {
+private:
+  static_assert(N > 0 && N < 128, "N debe estar entre 1 y 127");
+  static const uint8_t MAX_BAJOS = (N + 1) / 2;
+  static const uint8_t MAX_ALTOS = N / 2 > 0 ? N / 2 : 1;
+  static const uint8_t EN_ALTOS = 0x80;   // bit de posicion: ranura en altos
+
+  T valores[N];
+  uint8_t bajos[MAX_BAJOS];     // monticulo de maximo
+  uint8_t altos[MAX_ALTOS];     // monticulo de minimo
+  uint8_t posicion[N];          // indice en su monticulo | EN_ALTOS
+  uint8_t nBajos = 0;
+  uint8_t nAltos = 0;
+  uint8_t siguiente = 0;        // ranura de la proxima muestra
+
+  // El lado va como parametro de plantilla: sin ramas por monticulo en
+  // los bucles de recolocacion
+  template <bool ALTOS> uint8_t* monticulo() { return ALTOS ? altos : bajos; }
+  template <bool ALTOS> uint8_t& cantidad() { return ALTOS ? nAltos : nBajos; }
+
+  // En bajos manda el mayor; en altos, el menor
+  template <bool ALTOS> bool antes(uint8_t a, uint8_t b) const {
+    return ALTOS ? valores[a] < valores[b] : valores[a] > valores[b];
+  }
+
+  template <bool ALTOS> void colocar(uint8_t i, uint8_t ranura) {
+    monticulo<ALTOS>()[i] = ranura;
+    posicion[ranura] = ALTOS ? (uint8_t)(i | EN_ALTOS) : i;
+  }
+
+  template <bool ALTOS> uint8_t subir(uint8_t i) {
+    uint8_t* h = monticulo<ALTOS>();
+    uint8_t ranura = h[i];
+    while (i > 0) {
+      uint8_t padre = (i - 1) / 2;
+      if (!antes<ALTOS>(ranura, h[padre])) break;
+      colocar<ALTOS>(i, h[padre]);
+      i = padre;
+    }
+    colocar<ALTOS>(i, ranura);
+    return i;
+  }
+
+  template <bool ALTOS> void bajar(uint8_t i) {
+    uint8_t* h = monticulo<ALTOS>();
+    uint8_t n = cantidad<ALTOS>();
+    uint8_t ranura = h[i];
+    while (true) {
+      uint8_t hijo = 2 * i + 1;
+      if (hijo >= n) break;
+      if (hijo + 1 < n && antes<ALTOS>(h[hijo + 1], h[hijo])) hijo++;
+      if (!antes<ALTOS>(h[hijo], ranura)) break;
+      colocar<ALTOS>(i, h[hijo]);
+      i = hijo;
+    }
+    colocar<ALTOS>(i, ranura);
+  }
+
+  template <bool ALTOS> void recolocar(uint8_t i) {
+    if (subir<ALTOS>(i) == i) bajar<ALTOS>(i);
+  }
+
+  template <bool ALTOS> void insertar(uint8_t ranura) {
+    uint8_t i = cantidad<ALTOS>()++;
+    colocar<ALTOS>(i, ranura);
+    subir<ALTOS>(i);
+  }
+
+  template <bool ALTOS> uint8_t extraerCima() {
+    uint8_t* h = monticulo<ALTOS>();
+    uint8_t cima = h[0];
+    uint8_t n = --cantidad<ALTOS>();
+    if (n > 0) {
+      colocar<ALTOS>(0, h[n]);
+      bajar<ALTOS>(0);
+    }
+    return cima;
+  }
+
+  // max(bajos) <= min(altos); al reemplazar una sola muestra basta con
+  // intercambiar las cimas una vez
+  void corregirFrontera() {
+    if (nBajos == 0 || nAltos == 0 || !(valores[bajos[0]] > valores[altos[0]])) return;
+    uint8_t cimaBaja = bajos[0];
+    uint8_t cimaAlta = altos[0];
+    colocar<false>(0, cimaAlta);
+    colocar<true>(0, cimaBaja);
+    bajar<false>(0);
+    bajar<true>(0);
+  }
+
+public:
+  void agregar(T valor) {
+    uint8_t ranura = siguiente;
+    if (++siguiente == N) siguiente = 0;
+    valores[ranura] = valor;
+
+    if (nBajos + nAltos == N) {
+      // Reemplaza a la mas antigua, que ocupaba esta ranura
+      uint8_t p = posicion[ranura];
+      if (p & EN_ALTOS) recolocar<true>((uint8_t)(p & ~EN_ALTOS));
+      else recolocar<false>(p);
+      corregirFrontera();
+      return;
+    }
+
+    // Llenando: bajos tiene la mitad redondeada hacia arriba. Si la muestra
+    // va al lado que no crece, antes se pasa su cima al otro (nunca se
+    // supera la capacidad de un monticulo)
+    if (nBajos == nAltos) {
+      if (nAltos > 0 && valor > valores[altos[0]]) {
+        insertar<false>(extraerCima<true>());
+        insertar<true>(ranura);
+      } else {
+        insertar<false>(ranura);
+      }
+    } else if (valor < valores[bajos[0]]) {
+      insertar<true>(extraerCima<false>());
+      insertar<false>(ranura);
+    } else {
+      insertar<true>(ranura);
+    }
+  }
+
+  uint8_t size() const { return nBajos + nAltos; }
+
+  T mediana() const {
+    if (nBajos == 0) return 0;
+    if (nBajos > nAltos) return valores[bajos[0]];
+    return (T)(((Acum)valores[bajos[0]] + (Acum)valores[altos[0]]) / 2);
+  }
+
+  void reset() {
+    nBajos = 0;
+    nAltos = 0;
+    siguiente = 0;
+  }
+};
+
+// ======================
+// FILTRO DE HAMPEL
+// ======================
+// Rechaza muestras atipicas antes de que entren en la media y en la
+// regresion del filtro: una lectura cuya distancia a la mediana supera
+// HAMPEL_UMBRAL_SIGMAS desviaciones robustas (1.4826 x MAD) se sustituye
+// por la mediana. La MAD exacta no se puede mantener de forma incremental
+// (cambia con la mediana); se usa la mediana deslizante de los residuos
+// |x - mediana| de cada muestra al llegar, que cuesta O(log N) y se adapta
+// a un cambio real de nivel en media ventana. minimo evita rechazar el
+// ruido de cuantizacion cuando la ventana es casi constante (MAD = 0).
+template <typename T, typename Acum, uint8_t N>
+class FiltroHampel {
+private:
+  // k x 1.4826, en milesimas para operar tambien con enteros
+  static constexpr int32_t FACTOR_MILESIMAS = (int32_t)(HAMPEL_UMBRAL_SIGMAS * 1482.6f + 0.5f);
+
+  MedianaDeslizante<T, Acum, N> datos;
+  MedianaDeslizante<T, Acum, N> residuos;
+  T minimo;
+
+public:
+  explicit FiltroHampel(T umbralMinimo = 0) : minimo(umbralMinimo) {}
+
+  // Si la muestra es atipica la sustituye por la mediana de la ventana y
+  // devuelve true. Hasta tener media ventana no rechaza nada
+  bool limpiar(T& valor) {
+    bool hayReferencia = datos.size() >= (N + 1) / 2;
+    T mediana = datos.mediana();
+    T residuo = valor > mediana ? (T)(valor - mediana) : (T)(mediana - valor);
+    Acum umbral = (Acum)residuos.mediana() * FACTOR_MILESIMAS / 1000;
+    if (umbral < (Acum)minimo) umbral = minimo;
+
+    datos.agregar(valor);
+    if (!hayReferencia) return false;
+    residuos.agregar(residuo);
+    if ((Acum)residuo <= umbral) return false;
+    valor = mediana;
+    return true;
+  }
+
+  T mediana() const { return datos.mediana(); }
+};
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef FORMATO_BINARIO_H
+#define FORMATO_BINARIO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// ======================
+// FORMATO BINARIO COMPACTO
+// ======================
+// Alternativa al JSON para el envio al backend. Una trama agrupa las
+// lecturas de una estacion; varias tramas pueden ir seguidas en el mismo
+// cuerpo. Todos los enteros van en little-endian.
+//
+//   Trama:   'R' 'S' | version u8 | largo_id u8 | id (largo_id bytes)
+//            | n u8 | n registros
+//   Registro (13 bytes):
+//            timestamp ms  u48
+//            temperatura   i16  (x100, °C)
+//            humedad       u16  (x100, %)
+//            presion       u16  ((hPa - 500) x100)
+//            alerta        u8
+//
+// Una lectura con el id "ARDUINO_TROPICAL_01" ocupa 37 bytes, frente a
+// 150-220 del JSON. Mismo codigo en el AVR y en nativo: sin STL ni Arduino.
+const uint8_t FORMATO_BINARIO_VERSION = 1;
+const size_t TAM_REGISTRO_BINARIO = 13;
+const size_t TAM_CABECERA_TRAMA = 5;    // magia + version + largo_id + n
+const float PRESION_BASE_BINARIO = 500.0f;
+
+struct LecturaBinaria {
+  uint64_t timestampMs;
+  float temperatura;
+  float humedad;
+  float presion;
+  uint8_t alerta;
+};
+
+inline size_t tamTramaBinaria(uint8_t largoId, uint8_t lecturas) {
+  return TAM_CABECERA_TRAMA + largoId + (size_t)lecturas * TAM_REGISTRO_BINARIO;
+}
+
+inline int32_t escalarBinario(float valor, float base) {
+  float v = (valor - base) * 100.0f;
+  return (int32_t)(v >= 0 ? v + 0.5f : v - 0.5f);
+}
+
+inline void escribirU16(uint8_t* p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+inline uint16_t leerU16(const uint8_t* p) {
+  return (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+}
+
+inline uint16_t saturarU16(int32_t v) {
+  return v < 0 ? 0 : (v > 0xFFFF ? 0xFFFF : (uint16_t)v);
+}
+
+inline int16_t saturarI16(int32_t v) {
+  return v < -32768 ? -32768 : (v > 32767 ? 32767 : (int16_t)v);
+}
+
+inline void codificarRegistroBinario(uint8_t* p, const LecturaBinaria& l) {
+  uint64_t ts = l.timestampMs;
+  for (uint8_t i = 0; i < 6; i++) {
+    p[i] = (uint8_t)(ts >> (8 * i));
+  }
+  escribirU16(p + 6, (uint16_t)saturarI16(escalarBinario(l.temperatura, 0)));
+  escribirU16(p + 8, saturarU16(escalarBinario(l.humedad, 0)));
+  escribirU16(p + 10, saturarU16(escalarBinario(l.presion, PRESION_BASE_BINARIO)));
+  p[12] = l.alerta;
+}
+
+inline void decodificarRegistroBinario(const uint8_t* p, LecturaBinaria& l) {
+  uint64_t ts = 0;
+  for (uint8_t i = 0; i < 6; i++) {
+    ts |= (uint64_t)p[i] << (8 * i);
+  }
+  l.timestampMs = ts;
+  l.temperatura = (int16_t)leerU16(p + 6) / 100.0f;
+  l.humedad = leerU16(p + 8) / 100.0f;
+  l.presion = leerU16(p + 10) / 100.0f + PRESION_BASE_BINARIO;
+  l.alerta = p[12];
+}
+
+// Escribe una trama en buf. Devuelve los bytes escritos, o 0 si no cabe
+inline size_t codificarTramaBinaria(uint8_t* buf, size_t capacidad, const char* sensorId,
+                                    const LecturaBinaria* lecturas, uint8_t n) {
+  size_t largoId = strlen(sensorId);
+  if (largoId > 255) largoId = 255;
+  size_t total = tamTramaBinaria((uint8_t)largoId, n);
+  if (total > capacidad) return 0;
+
+  uint8_t* p = buf;
+  *p++ = 'R';
+  *p++ = 'S';
+  *p++ = FORMATO_BINARIO_VERSION;
+  *p++ = (uint8_t)largoId;
+  memcpy(p, sensorId, largoId);
+  p += largoId;
+  *p++ = n;
+  for (uint8_t i = 0; i < n; i++) {
+    codificarRegistroBinario(p, lecturas[i]);
+    p += TAM_REGISTRO_BINARIO;
+  }
+  return total;
+}
+
+// Lee una trama desde buf. Copia el id (terminado en '\0') y hasta
+// maxLecturas registros; n recibe el total de la trama. Devuelve los
+// bytes consumidos, o 0 si la trama esta incompleta o no es valida
+inline size_t decodificarTramaBinaria(const uint8_t* buf, size_t largo, char* sensorId, size_t capacidadId,
+                                      LecturaBinaria* destino, uint8_t maxLecturas, uint8_t& n) {
+  if (largo < TAM_CABECERA_TRAMA) return 0;
+  if (buf[0] != 'R' || buf[1] != 'S' || buf[2] != FORMATO_BINARIO_VERSION) return 0;
+
+  uint8_t largoId = buf[3];
+  if (largo < (size_t)4 + largoId + 1) return 0;
+  n = buf[4 + largoId];
+  size_t total = tamTramaBinaria(largoId, n);
+  if (largo < total) return 0;
+
+  if (capacidadId > 0) {
+    size_t copiar = largoId < capacidadId - 1 ? largoId : capacidadId - 1;
+    memcpy(sensorId, buf + 4, copiar);
+    sensorId[copiar] = '\0';
+  }
+
+  const uint8_t* p = buf + 5 + largoId;
+  for (uint8_t i = 0; i < n && i < maxLecturas; i++) {
+    decodificarRegistroBinario(p + (size_t)i * TAM_REGISTRO_BINARIO, destino[i]);
+  }
+  return total;
+}
+
+#endif
@@ -1,74 +1,428 @@
 #ifndef HTTP_CLIENT_H
 #define HTTP_CLIENT_H
 
-#include <ArduinoJson.h>
 #include <Ethernet.h>
 #include <HttpClient.h>
 #include "config.h"
+#include "data_filter.h"
+#include "escritor_json.h"
+#include "formato_binario.h"
+#include "metricas.h"
+#include "registro.h"
 
 // DECLARACIONES extern (sin definir aquí)
 extern byte mac[];
 extern IPAddress ip;
 extern EthernetClient ethClient;
 extern HttpClient httpClient;
+extern MetricasEstacion metricas;
+extern DataFilter dataFilter;
+
+// Lectura pendiente de envio dentro de un lote
+struct LecturaLote {
+  unsigned long timestamp;
+  float temperatura;
+  float humedad;
+  float presion;
+  int alerta;
+};
+
+#if ENVIAR_AGREGADOS && !AGREGADOS_MULTIRESOLUCION
+  #error "ENVIAR_AGREGADOS requiere AGREGADOS_MULTIRESOLUCION"
+#endif
+
+// Peor caso en bytes de cada parte del JSON, con todas las cifras que
+// admite su tipo: uint16 5, uint32 10 y un real de EscritorJson 12 (signo,
+// 10 cifras y el punto, o "null")
+const unsigned int CIFRAS_UINT16 = 5;
+const unsigned int CIFRAS_UINT32 = 10;
+const unsigned int BYTES_REAL_JSON = 12;
+
+// Una lectura de escribirLectura() sin extras
+const unsigned int BYTES_LECTURA_JSON =
+    sizeof("{\"sensor_id\":\"ARDUINO_TROPICAL_01\",\"timestamp\":,\"temperatura\":,"
+           "\"humedad\":,\"presion\":,\"alerta\":,\"modo\":\"simulacion\"}") - 1 +
+    CIFRAS_UINT32 + 3 * BYTES_REAL_JSON + CIFRAS_UINT16 + 1;
+
+// ,"metricas":{...} de escribirMetricas()
+const unsigned int BYTES_METRICAS_JSON =
+    sizeof(",\"metricas\":{\"n\":[],\"media_us\":[],\"max_us\":[],\"descartadas\":,"
+           "\"fallidos\":,\"sobrecargas\":,\"suprimidas\":,\"atipicas\":}") - 1 +
+    NUM_ETAPAS * (CIFRAS_UINT16 + 2 * CIFRAS_UINT32) + 3 * (NUM_ETAPAS - 1) + 5 * CIFRAS_UINT16;
+
+// ,"agregados_1h":{...} de escribirAgregados(): tres arrays de 5 reales
+const unsigned int BYTES_AGREGADOS_JSON =
+    sizeof(",\"agregados_1h\":{\"temperatura\":[],\"humedad\":[],\"presion\":[]}") - 1 +
+    3 * (5 * BYTES_REAL_JSON + 4);
+
+// Espacio del lote reservado para lo que viaja en la ultima lectura: el
+// objeto "metricas" y "agregados_1h", con su tamano maximo para que nunca
+// desborden el cuerpo
+#if FORMATO_ENVIO == FORMATO_JSON
+  const unsigned int BYTES_RESERVA_EXTRAS =
+      (ENVIAR_METRICAS ? BYTES_METRICAS_JSON : 0) + (ENVIAR_AGREGADOS ? BYTES_AGREGADOS_JSON : 0);
+  static_assert(LOTE_MAX_BYTES >= BYTES_RESERVA_EXTRAS + BYTES_LECTURA_JSON + 2,
+                "LOTE_MAX_BYTES no deja sitio para una lectura y las metricas/agregados");
+  const unsigned int BYTES_LOTE_LECTURAS = LOTE_MAX_BYTES - BYTES_RESERVA_EXTRAS;
+#else
+  const unsigned int BYTES_LOTE_LECTURAS = LOTE_MAX_BYTES;
+#endif
+
+// Cuerpo JSON de cada envio, reservado una vez en lugar de un JsonDocument
+// y un String en el heap por envio. Se dimensiona por lo que puede llegar a
+// llevar (LOTE_MAX_LECTURAS lecturas en el peor caso con corchetes, comas y
+// extras), no por LOTE_MAX_BYTES: con un objeto por POST son 170 bytes de
+// RAM en lugar de 513. Con el formato binario solo lo usa sendData() para
+// una lectura suelta
+#if FORMATO_ENVIO == FORMATO_JSON
+  const unsigned int BYTES_CUERPO_MAXIMO =
+      LOTE_MAX_LECTURAS * (BYTES_LECTURA_JSON + 1) + 1 + BYTES_RESERVA_EXTRAS;
+  const unsigned int TAM_BUFFER_ENVIO =
+      (BYTES_CUERPO_MAXIMO < LOTE_MAX_BYTES ? BYTES_CUERPO_MAXIMO : LOTE_MAX_BYTES) + 1;
+#else
+  const unsigned int TAM_BUFFER_ENVIO = BYTES_LECTURA_JSON + 1;
+#endif
+
+// Se invoca una vez por lectura cuando su lote termina de enviarse
+typedef void (*ResultadoLecturaCallback)(const LecturaLote& lectura, bool exito);
 
 class HttpClientBackend {
+private:
+  char bufferEnvio[TAM_BUFFER_ENVIO];
+  LecturaLote lote[LOTE_MAX_LECTURAS];
+  uint8_t lecturasEnLote = 0;
+  unsigned int bytesEnLote = 0;
+  unsigned long inicioLote = 0;
+  ResultadoLecturaCallback alTerminarLectura = nullptr;
+
 public:
   void begin() {
     #if !MODO_SIMULACION
       Ethernet.begin(mac, ip);
       delay(1000);
-      Serial.println("Ethernet inicializado");
+      #if HTTP_KEEP_ALIVE
+        httpClient.connectionKeepAlive();
+      #endif
+      LOG_INFO("Ethernet inicializado");
     #endif
   }
 
   bool sendData(float temperatura, float humedad, float presion, int alerta) {
-    // Crear JSON
-    JsonDocument doc;
-    doc["sensor_id"] = "ARDUINO_TROPICAL_01";
-    doc["timestamp"] = millis();
-    doc["temperatura"] = temperatura;
-    doc["humedad"] = humedad;
-    doc["presion"] = presion;
-    doc["alerta"] = alerta;
-    doc["modo"] = MODO_SIMULACION ? "simulacion" : "real";
-
-    String jsonString;
-    serializeJson(doc, jsonString);
-
-    Serial.println("ENVIANDO AL BACKEND:");
-    Serial.println(jsonString);
-
-    #ifdef MODO_SIMULACION
+    LecturaLote lectura = {millis(), temperatura, humedad, presion, alerta};
+    EscritorJson json(bufferEnvio, sizeof(bufferEnvio));
+    {
+      MedicionEtapa<MetricasEstacion> m(metricas, ETAPA_SERIALIZACION);
+      escribirLectura(json, lectura, false);
+    }
+
+    LOG_DEPURACION("ENVIANDO AL BACKEND: %s", json.c_str());
+
+    #if MODO_SIMULACION
       // EN SIMULACION: Solo mostrar
-      Serial.println("(Modo simulacion - envio simulado)");
+      LOG_DEPURACION("(Modo simulacion - envio simulado)");
       return true;
     #else
       // EN MODO REAL: Enviar HTTP real
-      return sendHttpRequest(jsonString);
+      MedicionEtapa<MetricasEstacion> m(metricas, ETAPA_HTTP);
+      return sendHttpRequest("application/json", (const uint8_t*)bufferEnvio, json.size());
+    #endif
+  }
+
+  void onResultadoLectura(ResultadoLecturaCallback callback) {
+    alTerminarLectura = callback;
+  }
+
+  // Agrega una lectura al lote y lo envia si se llena (en numero o en
+  // bytes). Con LOTE_MAX_LECTURAS = 1 se envia en el acto.
+  void encolar(float temperatura, float humedad, float presion, int alerta) {
+    LecturaLote lectura = {millis(), temperatura, humedad, presion, alerta};
+    unsigned int bytes = medirLectura(lectura) + 1;  // + separador
+
+    if (lecturasEnLote > 0 && bytesEnLote + bytes + 2 > BYTES_LOTE_LECTURAS) {
+      enviarLote();
+    }
+
+    if (lecturasEnLote == 0) inicioLote = lectura.timestamp;
+    lote[lecturasEnLote++] = lectura;
+    bytesEnLote += bytes;
+
+    if (lecturasEnLote >= LOTE_MAX_LECTURAS || bytesEnLote + 2 >= BYTES_LOTE_LECTURAS) {
+      enviarLote();
+    }
+  }
+
+  // Llamar en cada loop(): envia el lote si la lectura mas antigua
+  // supera LOTE_MAX_LATENCIA
+  void revisarLote() {
+    if (lecturasEnLote > 0 && millis() - inicioLote >= LOTE_MAX_LATENCIA) {
+      enviarLote();
+    }
+  }
+
+  bool enviarLote() {
+    if (lecturasEnLote == 0) return true;
+
+    uint8_t enviadas = enviarLecturas(lote, lecturasEnLote);
+
+    if (alTerminarLectura) {
+      for (uint8_t i = 0; i < lecturasEnLote; i++) {
+        alTerminarLectura(lote[i], i < enviadas);
+      }
+    }
+
+    bool exito = enviadas == lecturasEnLote;
+    lecturasEnLote = 0;
+    bytesEnLote = 0;
+    return exito;
+  }
+
+  // Sube n lecturas como un array JSON (o una trama binaria) y devuelve
+  // cuantas, desde la primera, llegaron al backend (0 si fallo). Las que
+  // no caben en LOTE_MAX_BYTES quedan fuera del envio: solo pasa con un
+  // bloque de la cola persistente, que se queda el resto para el
+  // siguiente intento. No pasa por el lote ni invoca el callback
+  uint8_t enviarLecturas(const LecturaLote* lecturas, uint8_t n) {
+    #if FORMATO_ENVIO == FORMATO_BINARIO
+      return enviarLecturasBinario(lecturas, n);
+    #else
+      // Sin lotes se sube un objeto suelto, como antes de los lotes
+      const bool comoArray = LOTE_MAX_LECTURAS > 1;
+      if (!comoArray && n > 1) n = 1;
+      EscritorJson json(bufferEnvio, sizeof(bufferEnvio));
+      uint32_t inicio = relojMetricasUs();
+      if (comoArray) json.abrirArray();
+      EscritorJson::Marca inicioUltima = json.marca();
+      uint8_t enLote = 0;
+      for (; enLote < n; enLote++) {
+        EscritorJson::Marca m = json.marca();
+        escribirLectura(json, lecturas[enLote], false);
+        if (json.desbordado() || json.size() + 1 > BYTES_LOTE_LECTURAS) {
+          json.volverA(m);
+          break;
+        }
+        inicioUltima = m;
+      }
+      // La ultima lectura se reescribe con las metricas y los agregados,
+      // que tienen su espacio reservado fuera de BYTES_LOTE_LECTURAS
+      #if ENVIAR_METRICAS || ENVIAR_AGREGADOS
+        if (enLote > 0) {
+          json.volverA(inicioUltima);
+          escribirLectura(json, lecturas[enLote - 1], true);
+        }
+      #endif
+      if (comoArray) json.cerrarArray();
+      uint32_t usSerializacion = relojMetricasUs() - inicio;
+      if (enLote == 0 || json.desbordado()) {
+        LOG_ERROR("Lote JSON demasiado grande");
+        return 0;
+      }
+
+      if (comoArray) LOG_INFO("ENVIANDO LOTE AL BACKEND: %u lecturas", (unsigned int)enLote);
+      else LOG_INFO("ENVIANDO AL BACKEND");
+      LOG_DEPURACION("%s", json.c_str());
+
+      inicio = relojMetricasUs();
+      #if MODO_SIMULACION
+        LOG_DEPURACION("(Modo simulacion - envio simulado)");
+        bool exito = true;
+      #else
+        bool exito = sendHttpRequest("application/json", (const uint8_t*)bufferEnvio, json.size());
+      #endif
+      uint32_t usHttp = relojMetricasUs() - inicio;
+
+      // Lo informado ya esta en el backend: el siguiente lote parte de
+      // cero. La serializacion y el HTTP de este envio se anotan despues,
+      // asi que viajan en el siguiente
+      #if ENVIAR_METRICAS
+        if (exito) metricas.reiniciar();
+      #endif
+      metricas.registrar(ETAPA_SERIALIZACION, usSerializacion);
+      #if MODO_SIMULACION
+        (void)usHttp;
+      #else
+        metricas.registrar(ETAPA_HTTP, usHttp);
+      #endif
+      return exito ? enLote : 0;
     #endif
   }
 
 private:
-  bool sendHttpRequest(String jsonData) {
-    Serial.println("Enviando HTTP real...");
-    
+  // Claves y textos fijos en flash con F(): en el Uno no ocupan RAM
+  static void escribirLectura(EscritorJson& json, const LecturaLote& lectura, bool conExtras) {
+    json.abrirObjeto();
+    json.clave(F("sensor_id"));
+    json.texto(F("ARDUINO_TROPICAL_01"));
+    json.clave(F("timestamp"));
+    json.sinSigno(lectura.timestamp);
+    json.clave(F("temperatura"));
+    json.real(lectura.temperatura);
+    json.clave(F("humedad"));
+    json.real(lectura.humedad);
+    json.clave(F("presion"));
+    json.real(lectura.presion);
+    json.clave(F("alerta"));
+    json.entero(lectura.alerta);
+    json.clave(F("modo"));
+    json.texto(MODO_SIMULACION ? F("simulacion") : F("real"));
+    #if !ENVIAR_METRICAS && !ENVIAR_AGREGADOS
+      (void)conExtras;
+    #endif
+    #if ENVIAR_METRICAS
+      if (conExtras) {
+        json.clave(F("metricas"));
+        escribirMetricas(json);
+      }
+    #endif
+    #if ENVIAR_AGREGADOS
+      if (conExtras && dataFilter.resumen(VARIABLE_TEMPERATURA, RESOLUCION_1H).muestras > 0) {
+        json.clave(F("agregados_1h"));
+        escribirAgregados(json);
+      }
+    #endif
+    json.cerrarObjeto();
+  }
+
+  #if ENVIAR_AGREGADOS
+    // Ultima hora de cada variable: [min, max, media, desviacion, pendiente
+    // por minuto]
+    static void escribirAgregados(EscritorJson& json) {
+      json.abrirObjeto();
+      json.clave(F("temperatura"));
+      escribirResumen(json, dataFilter.resumen(VARIABLE_TEMPERATURA, RESOLUCION_1H));
+      json.clave(F("humedad"));
+      escribirResumen(json, dataFilter.resumen(VARIABLE_HUMEDAD, RESOLUCION_1H));
+      json.clave(F("presion"));
+      escribirResumen(json, dataFilter.resumen(VARIABLE_PRESION, RESOLUCION_1H));
+      json.cerrarObjeto();
+    }
+
+    static void escribirResumen(EscritorJson& json, const ResumenVentana& r) {
+      json.abrirArray();
+      json.real(r.minimo);
+      json.real(r.maximo);
+      json.real(r.media);
+      json.real(r.desviacion, 3);
+      json.real(r.pendiente, 4);
+      json.cerrarArray();
+    }
+  #endif
+
+  // Resumen compacto de metricas.h; n, media_us y max_us tienen una
+  // posicion por etapa: lectura, filtrado, prediccion, serializacion, http
+  static void escribirMetricas(EscritorJson& json) {
+    json.abrirObjeto();
+    json.clave(F("n"));
+    json.abrirArray();
+    for (uint8_t i = 0; i < NUM_ETAPAS; i++) json.sinSigno(metricas.etapas[i].n);
+    json.cerrarArray();
+    json.clave(F("media_us"));
+    json.abrirArray();
+    for (uint8_t i = 0; i < NUM_ETAPAS; i++) json.sinSigno(metricas.mediaUs((EtapaMetrica)i));
+    json.cerrarArray();
+    json.clave(F("max_us"));
+    json.abrirArray();
+    for (uint8_t i = 0; i < NUM_ETAPAS; i++) json.sinSigno(metricas.etapas[i].maxUs);
+    json.cerrarArray();
+    json.clave(F("descartadas"));
+    json.sinSigno(metricas.descartadas);
+    json.clave(F("fallidos"));
+    json.sinSigno(metricas.enviosFallidos);
+    json.clave(F("sobrecargas"));
+    json.sinSigno(metricas.sobrecargas);
+    json.clave(F("suprimidas"));
+    json.sinSigno(metricas.suprimidas);
+    json.clave(F("atipicas"));
+    json.sinSigno(metricas.atipicas);
+    json.cerrarObjeto();
+  }
+
+  static unsigned int medirLectura(const LecturaLote& lectura) {
+    #if FORMATO_ENVIO == FORMATO_BINARIO
+      (void)lectura;
+      return TAM_REGISTRO_BINARIO;
+    #else
+      EscritorJson json(nullptr, 0);
+      escribirLectura(json, lectura, false);
+      return json.size();
+    #endif
+  }
+
+  uint8_t enviarLecturasBinario(const LecturaLote* lecturas, uint8_t n) {
+    static const char SENSOR_ID[] = "ARDUINO_TROPICAL_01";
+    uint8_t trama[TAM_CABECERA_TRAMA + sizeof(SENSOR_ID) - 1 + LOTE_MAX_LECTURAS * TAM_REGISTRO_BINARIO];
+    LecturaBinaria binarias[LOTE_MAX_LECTURAS];
+
+    if (n > LOTE_MAX_LECTURAS) n = LOTE_MAX_LECTURAS;
+    for (uint8_t i = 0; i < n; i++) {
+      binarias[i].timestampMs = lecturas[i].timestamp;
+      binarias[i].temperatura = lecturas[i].temperatura;
+      binarias[i].humedad = lecturas[i].humedad;
+      binarias[i].presion = lecturas[i].presion;
+      binarias[i].alerta = lecturas[i].alerta;
+    }
+    size_t largo = codificarTramaBinaria(trama, sizeof(trama), SENSOR_ID, binarias, n);
+
+    LOG_INFO("ENVIANDO TRAMA BINARIA: %u lecturas, %u bytes", (unsigned int)n, (unsigned int)largo);
+
+    #if MODO_SIMULACION
+      LOG_DEPURACION("(Modo simulacion - envio simulado)");
+      return largo > 0 ? n : 0;
+    #else
+      MedicionEtapa<MetricasEstacion> m(metricas, ETAPA_HTTP);
+      return largo > 0 && sendHttpRequest("application/x-rainsense", trama, largo) ? n : 0;
+    #endif
+  }
+
+  // POST del cuerpo tal cual, JSON o binario, sin copiarlo a un String
+  bool sendHttpRequest(const char* tipo, const uint8_t* datos, size_t largo) {
+    LOG_DEPURACION("Enviando HTTP real (%s)...", tipo);
+
     httpClient.beginRequest();
     httpClient.post(BACKEND_ENDPOINT);
-    httpClient.sendHeader("Content-Type", "application/json");
-    httpClient.sendHeader("Content-Length", jsonData.length());
+    httpClient.sendHeader("Content-Type", tipo);
+    httpClient.sendHeader("Content-Length", (int)largo);
     httpClient.beginBody();
-    httpClient.print(jsonData);
+    httpClient.write(datos, largo);
     httpClient.endRequest();
 
-    int statusCode = httpClient.responseStatusCode();
-    String response = httpClient.responseBody();
+    int statusCode = leerRespuesta();
 
-    Serial.print("Respuesta HTTP: ");
-    Serial.println(statusCode);
+    if (statusCode == 200 || statusCode == 201) LOG_DEPURACION("Respuesta HTTP: %d", statusCode);
+    else LOG_AVISO("Respuesta HTTP: %d", statusCode);
 
     return (statusCode == 200 || statusCode == 201);
   }
+
+  // Lee el codigo de estado y descarta cabeceras y cuerpo sin guardarlos
+  // en un String. Con keep-alive el socket solo se puede reutilizar si la
+  // respuesta se consumio entera; si no se sabe donde termina (sin
+  // Content-Length), si hay un error o si se agota
+  // HTTP_TIMEOUT_RESPUESTA, se cierra y el siguiente envio reconecta
+  int leerRespuesta() {
+    int statusCode = httpClient.responseStatusCode();
+    if (statusCode < 0 || httpClient.skipResponseHeaders() != 0) {
+      httpClient.stop();
+      return statusCode;
+    }
+
+    #if HTTP_KEEP_ALIVE
+      if (httpClient.contentLength() < 0) {
+        httpClient.stop();
+        return statusCode;
+      }
+      unsigned long inicio = millis();
+      while (!httpClient.endOfBodyReached()) {
+        if (httpClient.read() >= 0) continue;
+        if (!httpClient.connected() || millis() - inicio >= HTTP_TIMEOUT_RESPUESTA) {
+          httpClient.stop();
+          break;
+        }
+      }
+    #else
+      httpClient.stop();
+    #endif
+    return statusCode;
+  }
 };
 
 #endif
\ No newline at end of file
@@ -1,39 +1,69 @@
 #include <Arduino.h>
+#if defined(__AVR__)
+  #include <avr/sleep.h>
+#endif
 #include "config.h"
+#include "planificador.h"
+#include "registro.h"
 #include "sistema_controller.h"
 
+// ======================
+// TAREAS PERIODICAS
+// ======================
+Planificador<5> planificador;
+
+static void tareaLectura(void*) { leerSensores(); }
+static void tareaFiltrado(void*) { filtrarDatos(); }
+static void tareaEnvio(void*) { enviarAlBackend(); }
+static void tareaLote(void*) { httpBackend.revisarLote(); }
+static void tareaReenvio(void*) { colaPendientes.revisar(httpBackend); }
+
+static void sobrecargaTarea(uint8_t) {
+  MetricasEstacion::incrementar(metricas.sobrecargas);
+}
+
+// Modo idle: la CPU se detiene pero los timers, la UART y el SPI siguen.
+// La interrupcion del Timer0 (la de millis()) despierta cada ~1 ms, asi
+// que se vuelve a dormir hasta alcanzar el vencimiento. Fuera del AVR
+// (el shim de firmware_nativo/) basta con delay()
+static void dormirHasta(unsigned long instante) {
+  #if defined(__AVR__)
+    while ((long)(instante - millis()) > 0) {
+      set_sleep_mode(SLEEP_MODE_IDLE);
+      sleep_mode();
+    }
+  #else
+    long restante = (long)(instante - millis());
+    if (restante > 0) delay(restante);
+  #endif
+}
+
 void setup() {
   Serial.begin(9600);
-  
-  Serial.println("====================================");
+
+  LOG_INFO("====================================");
   #if MODO_SIMULACION
-    Serial.println("MODO SIMULACION ACTIVADO");
+    LOG_INFO("MODO SIMULACION ACTIVADO");
   #else
-    Serial.println("MODO HARDWARE REAL ACTIVADO");
+    LOG_INFO("MODO HARDWARE REAL ACTIVADO");
     sensorController.begin();
     httpBackend.begin();
   #endif
-  Serial.println("====================================");
+  LOG_INFO("====================================");
+
+  colaPendientes.begin();
+  httpBackend.onResultadoLectura(resultadoEnvio);
+
+  // Mismo orden que el antiguo loop: leer, filtrar, enviar y revisar
+  planificador.agregar(tareaLectura, INTERVALO_LECTURA);
+  planificador.agregar(tareaFiltrado, INTERVALO_FILTRADO);
+  planificador.agregar(tareaEnvio, INTERVALO_ENVIO);
+  planificador.agregar(tareaLote, INTERVALO_REVISION, HOLGURA_REVISION);
+  planificador.agregar(tareaReenvio, INTERVALO_REVISION, HOLGURA_REVISION);
+  planificador.alSobrecarga(sobrecargaTarea);
 }
 
 void loop() {
-  unsigned long tiempoActual = millis();
-  
-  // 1. LECTURA DE SENSORES
-  if (tiempoActual - ultimaLectura >= INTERVALO_LECTURA) {
-    ultimaLectura = tiempoActual;
-    leerSensores();
-  }
-  
-  // 2. FILTRADO DE DATOS
-  if (tiempoActual - ultimoFiltrado >= INTERVALO_FILTRADO) {
-    ultimoFiltrado = tiempoActual;
-    filtrarDatos();
-  }
-  
-  // 3. ENVIO AL BACKEND
-  if (tiempoActual - ultimoEnvio >= INTERVALO_ENVIO) {
-    ultimoEnvio = tiempoActual;
-    enviarAlBackend();
-  }
-}
\ No newline at end of file
+  planificador.ejecutarPendientes(millis());
+  dormirHasta(planificador.proximoVencimiento());
+}
@@ -0,0 +1,97 @@
+#ifndef METRICAS_H
+#define METRICAS_H
+
+#include <stdint.h>
+#include "config.h"
+
+// ======================
+// METRICAS POR ETAPA
+// ======================
+// Latencia de cada etapa del pipeline y contadores de lo que se pierde
+// por el camino. En el Arduino se acumulan n, suma y maximo por etapa (50
+// bytes de RAM) y viajan con el lote como objeto "metricas"; al enviarse
+// con exito se reinician, asi que cada lote informa del intervalo desde
+// el anterior. El simulador guarda histogramas completos
+// (simulador_nativo/metricas_nativo.h).
+enum EtapaMetrica {
+  ETAPA_LECTURA,
+  ETAPA_FILTRADO,
+  ETAPA_PREDICCION,
+  ETAPA_SERIALIZACION,
+  ETAPA_HTTP,
+  NUM_ETAPAS
+};
+
+// Microsegundos de un reloj monotono; micros() en el Arduino, el reloj
+// real del host en el simulador (aunque se use el reloj virtual)
+#if defined(ARDUINO)
+  #include <Arduino.h>
+  inline uint32_t relojMetricasUs() { return micros(); }
+#else
+  inline uint32_t relojMetricasUs();
+#endif
+
+struct LatenciaEtapa {
+  uint16_t n;
+  uint32_t sumaUs;
+  uint32_t maxUs;
+};
+
+class MetricasEstacion {
+public:
+  LatenciaEtapa etapas[NUM_ETAPAS];
+  uint16_t descartadas = 0;       // lecturas invalidas
+  uint16_t enviosFallidos = 0;    // lecturas cuyo envio fallo
+  uint16_t sobrecargas = 0;       // activaciones perdidas (planificador.h)
+  uint16_t suprimidas = 0;        // lecturas sin cambios que no se subieron
+  uint16_t atipicas = 0;          // lecturas corregidas por el filtro de Hampel
+
+  MetricasEstacion() { reiniciar(); }
+
+  void registrar(EtapaMetrica etapa, uint32_t us) {
+    LatenciaEtapa& e = etapas[etapa];
+    if (e.n == 0xFFFF) return;    // saturado hasta el proximo envio
+    e.n++;
+    e.sumaUs += us;
+    if (us > e.maxUs) e.maxUs = us;
+  }
+
+  // Contadores saturados: no dan la vuelta si el backend tarda en volver
+  static void incrementar(uint16_t& contador) {
+    if (contador < 0xFFFF) contador++;
+  }
+
+  uint32_t mediaUs(EtapaMetrica etapa) const {
+    const LatenciaEtapa& e = etapas[etapa];
+    return e.n > 0 ? e.sumaUs / e.n : 0;
+  }
+
+  void reiniciar() {
+    for (uint8_t i = 0; i < NUM_ETAPAS; i++) {
+      etapas[i].n = 0;
+      etapas[i].sumaUs = 0;
+      etapas[i].maxUs = 0;
+    }
+    descartadas = 0;
+    enviosFallidos = 0;
+    sobrecargas = 0;
+    suprimidas = 0;
+    atipicas = 0;
+  }
+};
+
+// Mide el bloque en el que se declara:
+//   { MedicionEtapa<MetricasEstacion> m(metricas, ETAPA_FILTRADO); ... }
+template <class Metricas>
+class MedicionEtapa {
+private:
+  Metricas& metricas;
+  EtapaMetrica etapa;
+  uint32_t inicio;
+
+public:
+  MedicionEtapa(Metricas& m, EtapaMetrica e) : metricas(m), etapa(e), inicio(relojMetricasUs()) {}
+  ~MedicionEtapa() { metricas.registrar(etapa, relojMetricasUs() - inicio); }
+};
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef PLANIFICADOR_H
+#define PLANIFICADOR_H
+
+#include <stdint.h>
+
+// ======================
+// PLANIFICADOR DE TAREAS PERIODICAS
+// ======================
+// Sustituye el sondeo de millis() contra cada intervalo: cada tarea tiene
+// su vencimiento y el bucle ejecuta las vencidas y duerme hasta
+// proximoVencimiento().
+// - Los vencimientos avanzan a ritmo fijo (vencimiento += periodo): el
+//   retraso de una activacion no se arrastra a las siguientes
+// - Holgura: cuando ya toca despertar, una tarea que vence dentro de su
+//   holgura se adelanta y se ejecuta junto a las vencidas, asi que las
+//   tareas poco urgentes no provocan despertares propios
+// - Una tarea que llega un periodo entero tarde pierde esa activacion: se
+//   cuenta como sobrecarga y se reprograma a partir de ahora
+// Con las pocas tareas de una estacion, buscar el minimo recorriendo el
+// array cuesta menos en el AVR que mantener un heap o una rueda de
+// tiempos. Las tareas que tocan en el mismo instante se ejecutan en el
+// orden en que se agregaron. Los tiempos son millis() y toleran el
+// desborde del contador.
+typedef void (*FuncionTarea)(void* contexto);
+typedef void (*AvisoSobrecarga)(uint8_t tarea);
+
+template <uint8_t MAX_TAREAS>
+class Planificador {
+public:
+  struct Tarea {
+    FuncionTarea funcion;
+    unsigned long periodo;
+    unsigned long holgura;
+    unsigned long vencimiento;
+    unsigned long retrasoMax;   // peor retraso observado (ms)
+    uint16_t sobrecargas;       // activaciones perdidas
+  };
+
+private:
+  Tarea tareas[MAX_TAREAS];
+  uint8_t numTareas = 0;
+  AvisoSobrecarga alSobrecargar = nullptr;
+
+  static bool alcanzado(unsigned long ahora, unsigned long instante) {
+    return (long)(ahora - instante) >= 0;
+  }
+
+public:
+  // Devuelve el indice de la tarea, o -1 si no caben mas. La primera
+  // activacion es en inicio + periodo
+  int8_t agregar(FuncionTarea funcion, unsigned long periodo, unsigned long holgura = 0,
+                 unsigned long inicio = 0) {
+    if (numTareas >= MAX_TAREAS) return -1;
+    Tarea& t = tareas[numTareas];
+    t.funcion = funcion;
+    t.periodo = periodo;
+    t.holgura = holgura;
+    t.vencimiento = inicio + periodo;
+    t.retrasoMax = 0;
+    t.sobrecargas = 0;
+    return numTareas++;
+  }
+
+  void alSobrecarga(AvisoSobrecarga aviso) { alSobrecargar = aviso; }
+
+  // Ejecuta las tareas vencidas (y las que caen dentro de su holgura, si
+  // alguna lo esta). contexto se pasa tal cual a cada tarea. Devuelve
+  // cuantas se ejecutaron
+  uint8_t ejecutarPendientes(unsigned long ahora, void* contexto = nullptr) {
+    if (numTareas == 0 || !alcanzado(ahora, proximoVencimiento())) return 0;
+
+    uint8_t ejecutadas = 0;
+    for (uint8_t i = 0; i < numTareas; i++) {
+      Tarea& t = tareas[i];
+      if (!alcanzado(ahora + t.holgura, t.vencimiento)) continue;
+
+      if (alcanzado(ahora, t.vencimiento)) {
+        unsigned long retraso = ahora - t.vencimiento;
+        if (retraso > t.retrasoMax) t.retrasoMax = retraso;
+        if (retraso >= t.periodo) {
+          if (t.sobrecargas < 0xFFFF) t.sobrecargas++;
+          if (alSobrecargar) alSobrecargar(i);
+          t.vencimiento = ahora;
+        }
+      }
+      t.vencimiento += t.periodo;
+      t.funcion(contexto);
+      ejecutadas++;
+    }
+    return ejecutadas;
+  }
+
+  // Vencimiento mas cercano; sin tareas, nunca (el maximo posible)
+  unsigned long proximoVencimiento() const {
+    if (numTareas == 0) return (unsigned long)-1;
+    unsigned long proximo = tareas[0].vencimiento;
+    for (uint8_t i = 1; i < numTareas; i++) {
+      if ((long)(tareas[i].vencimiento - proximo) < 0) proximo = tareas[i].vencimiento;
+    }
+    return proximo;
+  }
+
+  // Milisegundos hasta proximoVencimiento(); 0 si ya paso
+  unsigned long restante(unsigned long ahora) const {
+    unsigned long proximo = proximoVencimiento();
+    return alcanzado(ahora, proximo) ? 0 : proximo - ahora;
+  }
+
+  uint8_t size() const { return numTareas; }
+  const Tarea& tarea(uint8_t i) const { return tareas[i]; }
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef POLITICA_REPORTE_H
+#define POLITICA_REPORTE_H
+
+#include <stdint.h>
+#include "config.h"
+
+// ======================
+// POLITICA DE REPORTE POR BANDA MUERTA
+// ======================
+// Decide si la lectura de cada INTERVALO_ENVIO se sube o se suprime. Se
+// reporta cuando:
+// - es la primera desde el arranque
+// - alguna variable se aleja del ultimo valor REPORTADO mas que su banda
+//   (la deriva lenta se acumula hasta salir de la banda)
+// - cambia el nivel de alerta
+// - pasa el latido sin reportar nada, para distinguir "sin cambios" de
+//   "estacion caida"
+// El backend reconstruye la serie manteniendo el ultimo valor recibido:
+// hasta la siguiente lectura, el valor real estuvo a menos de una banda
+// de el. Un hueco mayor que el latido es perdida de datos, no estabilidad.
+// Sin STL ni Arduino: la misma clase en el AVR (18 bytes de RAM) y en el
+// simulador.
+struct BandasReporte {
+  float temperatura = BANDA_TEMPERATURA;   // grados C
+  float humedad = BANDA_HUMEDAD;           // %
+  float presion = BANDA_PRESION;           // hPa
+  unsigned long latidoMs = INTERVALO_LATIDO;
+};
+
+enum MotivoReporte : uint8_t {
+  REPORTE_SUPRIMIDO = 0,
+  REPORTE_INICIAL,
+  REPORTE_ALERTA,
+  REPORTE_BANDA,
+  REPORTE_LATIDO
+};
+
+class PoliticaReporte {
+private:
+  BandasReporte bandas;
+  float temperatura = 0;
+  float humedad = 0;
+  float presion = 0;
+  unsigned long ultimoReporte = 0;
+  int8_t alerta = -1;              // -1: aun no se reporto nada
+
+  static bool fueraDeBanda(float valor, float referencia, float banda) {
+    float d = valor - referencia;
+    return (d < 0 ? -d : d) >= banda;
+  }
+
+public:
+  PoliticaReporte() {}
+  explicit PoliticaReporte(const BandasReporte& b) : bandas(b) {}
+
+  // Si la lectura se reporta, pasa a ser la referencia de las bandas.
+  // ahora en millis(); tolera el desborde del contador
+  MotivoReporte evaluar(float t, float h, float p, int nivelAlerta, unsigned long ahora) {
+    MotivoReporte motivo;
+    if (alerta < 0) {
+      motivo = REPORTE_INICIAL;
+    } else if (nivelAlerta != alerta) {
+      motivo = REPORTE_ALERTA;
+    } else if (fueraDeBanda(t, temperatura, bandas.temperatura) ||
+               fueraDeBanda(h, humedad, bandas.humedad) ||
+               fueraDeBanda(p, presion, bandas.presion)) {
+      motivo = REPORTE_BANDA;
+    } else if (ahora - ultimoReporte >= bandas.latidoMs) {
+      motivo = REPORTE_LATIDO;
+    } else {
+      return REPORTE_SUPRIMIDO;
+    }
+
+    temperatura = t;
+    humedad = h;
+    presion = p;
+    alerta = (int8_t)nivelAlerta;
+    ultimoReporte = ahora;
+    return motivo;
+  }
+
+  // La siguiente lectura se reporta siempre
+  void reiniciar() { alerta = -1; }
+
+  const BandasReporte& configuracion() const { return bandas; }
+};
+
+#endif
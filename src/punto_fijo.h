@@ -0,0 +1,116 @@
+#ifndef PUNTO_FIJO_H
+#define PUNTO_FIJO_H
+
+#include <stdint.h>
+
+// ======================
+// ARITMETICA EN PUNTO FIJO
+// ======================
+// El Uno no tiene FPU: cada operacion float es una rutina de software de
+// decenas de ciclos. Con USAR_PUNTO_FIJO el filtro, las tendencias y la
+// puntuacion de riesgo trabajan con enteros escalados:
+//   temperatura  int16  centesimas de °C
+//   humedad      int16  centesimas de %
+//   presion      int16  centesimas de hPa sobre PRESION_BASE_FIJO
+//   tendencias   int32  milesimas de unidad por muestra
+// Solo se convierte desde float al recibir la lectura del sensor y hacia
+// float al mostrar o enviar. Sin dependencias de Arduino ni de la STL.
+constexpr float ESCALA_FIJO = 100.0f;
+constexpr float PRESION_BASE_FIJO = 950.0f;   // 800..1100 hPa cabe en int16
+
+// constexpr para que los umbrales se conviertan en tiempo de compilacion
+constexpr int16_t saturarFijo(float v) {
+  return v > 32767.0f ? 32767 : v < -32768.0f ? -32768 : (int16_t)(v >= 0 ? v + 0.5f : v - 0.5f);
+}
+
+constexpr int16_t aFijo(float valor, float base = 0) {
+  return saturarFijo((valor - base) * ESCALA_FIJO);
+}
+
+inline float desdeFijo(int32_t valor, float base = 0) {
+  return valor / ESCALA_FIJO + base;
+}
+
+inline float tendenciaDesdeFijo(int32_t milesimas) {
+  return milesimas / 1000.0f;
+}
+
+constexpr int32_t tendenciaAFijo(float tendencia) {
+  return aFijo(tendencia * 10);   // milesimas = centesimas de (x10)
+}
+
+// Division entera redondeando al mas cercano (den > 0)
+inline int32_t dividirRedondeando(int32_t num, int32_t den) {
+  return (num >= 0 ? num + den / 2 : num - den / 2) / den;
+}
+
+struct DatosFijos {
+  int16_t temperatura;
+  int16_t humedad;
+  int16_t presion;    // relativa a PRESION_BASE_FIJO
+};
+
+// ======================
+// VENTANA DESLIZANTE EN PUNTO FIJO
+// ======================
+// Misma idea que VentanaEstadistica (sumas de Y y de X*Y mantenidas en cada
+// add()) pero con enteros: las sumas son exactas, asi que no hace falta
+// resincronizar. N esta acotado para que la pendiente no desborde int32.
+template <int N>
+class VentanaPuntoFijo {
+  static_assert(N >= 2 && N <= 29, "VentanaPuntoFijo: N fuera de rango para int32");
+
+private:
+  int16_t muestras[N];
+  int8_t inicio = 0;
+  int8_t cantidad = 0;
+  int32_t sumaY = 0;
+  int32_t sumaXY = 0;
+
+public:
+  void add(int16_t valor) {
+    if (cantidad == N) {
+      sumaY -= muestras[inicio];
+      sumaXY -= sumaY;
+      muestras[inicio] = valor;
+      inicio = inicio + 1 == N ? 0 : inicio + 1;
+      sumaXY += (int32_t)(N - 1) * valor;
+      sumaY += valor;
+      return;
+    }
+
+    int8_t pos = inicio + cantidad;
+    muestras[pos >= N ? pos - N : pos] = valor;
+    sumaXY += (int32_t)cantidad * valor;
+    sumaY += valor;
+    cantidad++;
+  }
+
+  int size() const { return cantidad; }
+
+  int16_t media() const {
+    if (cantidad == 0) return 0;
+    return (int16_t)dividirRedondeando(sumaY, cantidad);
+  }
+
+  // Pendiente de minimos cuadrados en milesimas de unidad por muestra
+  // (las muestras estan en centesimas, de ahi el factor 10)
+  int32_t pendienteMilesimas() const {
+    if (cantidad < 2) return 0;
+    int32_t n = cantidad;
+    int32_t sumaX = n * (n - 1) / 2;
+    int32_t sumaX2 = (n - 1) * n * (2 * n - 1) / 6;
+    int32_t num = n * sumaXY - sumaX * sumaY;
+    int32_t den = n * sumaX2 - sumaX * sumaX;
+    return dividirRedondeando(num * 10, den);
+  }
+
+  void reset() {
+    inicio = 0;
+    cantidad = 0;
+    sumaY = 0;
+    sumaXY = 0;
+  }
+};
+
+#endif
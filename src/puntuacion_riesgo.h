@@ -0,0 +1,210 @@
+#ifndef PUNTUACION_RIESGO_H
+#define PUNTUACION_RIESGO_H
+
+#include "config.h"
+#include "punto_fijo.h"
+
+// ======================
+// PUNTUACION DE RIESGO MULTIVARIABLE
+// ======================
+// Reglas del PredictionEngine separadas de la salida por Serial. Las
+// reglas se describen una sola vez en REGLAS_RIESGO, con los umbrales de
+// config.h; el compilador genera a partir de la tabla la puntuacion en
+// float (simulador, lote vectorizado) y en punto fijo (Uno), asi que
+// cambiar un umbral no puede desincronizar los dos caminos.
+enum VariableRiesgo {
+  R_TEMPERATURA,
+  R_HUMEDAD,
+  R_PRESION,
+  R_TENDENCIA_HUMEDAD,
+  R_TENDENCIA_PRESION
+};
+
+enum ComparacionRiesgo { MAYOR_QUE, MENOR_QUE };
+
+struct ReglaRiesgo {
+  VariableRiesgo variable;
+  ComparacionRiesgo comparacion;
+  float umbral;
+  int puntos;
+};
+
+// Escalones de cada factor, del mas severo al menos severo: suma los
+// puntos del primero que se cumple, como una cadena if / else if
+constexpr ReglaRiesgo REGLAS_RIESGO[] = {
+  // Factor 1: Humedad alta
+  {R_HUMEDAD, MAYOR_QUE, HUMEDAD_ALERTA_ROJA, 3},
+  {R_HUMEDAD, MAYOR_QUE, HUMEDAD_ALERTA_AMARILLA, 2},
+  {R_HUMEDAD, MAYOR_QUE, HUMEDAD_MODERADA, 1},
+  // Factor 2: Presion baja
+  {R_PRESION, MENOR_QUE, PRESION_BAJA_ALERTA, 3},
+  {R_PRESION, MENOR_QUE, PRESION_BAJA_ADVERTENCIA, 2},
+  {R_PRESION, MENOR_QUE, PRESION_MODERADA, 1},
+  // Factor 3: Tendencia de humedad creciente
+  {R_TENDENCIA_HUMEDAD, MAYOR_QUE, TENDENCIA_HUMEDAD_ALERTA, 2},
+  {R_TENDENCIA_HUMEDAD, MAYOR_QUE, TENDENCIA_HUMEDAD_ADVERTENCIA, 1},
+  // Factor 4: Tendencia de presion decreciente (MUY IMPORTANTE)
+  {R_TENDENCIA_PRESION, MENOR_QUE, TENDENCIA_PRESION_ALERTA, 3},
+  {R_TENDENCIA_PRESION, MENOR_QUE, TENDENCIA_PRESION_ADVERTENCIA, 2},
+  // Factor 5: Temperatura estable o descendiendo
+  {R_TEMPERATURA, MENOR_QUE, TEMPERATURA_FRESCA, 1},
+};
+
+constexpr int NUM_REGLAS_RIESGO = sizeof(REGLAS_RIESGO) / sizeof(REGLAS_RIESGO[0]);
+
+// ======================
+// VALIDACION DE LA TABLA
+// ======================
+// Con los escalones de un factor contiguos y ordenados, la cadena if/else
+// equivale a sumar sin saltos (x > A) * (pA - pB) + (x > B) * (pB - pC) + ...
+constexpr bool mismoFactor(int i, int j) {
+  return REGLAS_RIESGO[i].variable == REGLAS_RIESGO[j].variable;
+}
+
+constexpr bool masSevera(int i, int j) {
+  return REGLAS_RIESGO[i].comparacion == MAYOR_QUE ? REGLAS_RIESGO[i].umbral > REGLAS_RIESGO[j].umbral
+                                                   : REGLAS_RIESGO[i].umbral < REGLAS_RIESGO[j].umbral;
+}
+
+constexpr bool apareceDesde(VariableRiesgo variable, int desde) {
+  return desde < NUM_REGLAS_RIESGO &&
+         (REGLAS_RIESGO[desde].variable == variable || apareceDesde(variable, desde + 1));
+}
+
+constexpr bool reglasValidas(int i = 0) {
+  return i + 1 >= NUM_REGLAS_RIESGO ||
+         ((mismoFactor(i, i + 1)
+               ? REGLAS_RIESGO[i].comparacion == REGLAS_RIESGO[i + 1].comparacion && masSevera(i, i + 1)
+               : !apareceDesde(REGLAS_RIESGO[i].variable, i + 1)) &&
+          reglasValidas(i + 1));
+}
+
+static_assert(reglasValidas(), "REGLAS_RIESGO: escalones de un factor desordenados o separados");
+
+// Puntos que suma el escalon i sobre los del siguiente del mismo factor
+constexpr int incrementoRegla(int i) {
+  return REGLAS_RIESGO[i].puntos -
+         (i + 1 < NUM_REGLAS_RIESGO && mismoFactor(i, i + 1) ? REGLAS_RIESGO[i + 1].puntos : 0);
+}
+
+// ======================
+// ENTRADAS Y ESCALAS
+// ======================
+struct EntradaRiesgo {
+  float temperatura;
+  float humedad;
+  float presion;
+  float tendenciaHumedad;
+  float tendenciaPresion;
+};
+
+// Mismas magnitudes en punto fijo (ver punto_fijo.h)
+struct EntradaRiesgoFija {
+  int16_t temperatura;
+  int16_t humedad;
+  int16_t presion;
+  int32_t tendenciaHumedad;
+  int32_t tendenciaPresion;
+};
+
+template <int V> struct CampoRiesgo;
+template <> struct CampoRiesgo<R_TEMPERATURA> {
+  template <class E> static auto de(const E& e) -> decltype(e.temperatura) { return e.temperatura; }
+};
+template <> struct CampoRiesgo<R_HUMEDAD> {
+  template <class E> static auto de(const E& e) -> decltype(e.humedad) { return e.humedad; }
+};
+template <> struct CampoRiesgo<R_PRESION> {
+  template <class E> static auto de(const E& e) -> decltype(e.presion) { return e.presion; }
+};
+template <> struct CampoRiesgo<R_TENDENCIA_HUMEDAD> {
+  template <class E> static auto de(const E& e) -> decltype(e.tendenciaHumedad) { return e.tendenciaHumedad; }
+};
+template <> struct CampoRiesgo<R_TENDENCIA_PRESION> {
+  template <class E> static auto de(const E& e) -> decltype(e.tendenciaPresion) { return e.tendenciaPresion; }
+};
+
+// Conversion de un umbral de config.h a la unidad de la entrada
+struct EscalaFlotante {
+  static constexpr float umbral(VariableRiesgo, float valor) { return valor; }
+};
+
+struct EscalaFija {
+  static constexpr int32_t umbral(VariableRiesgo variable, float valor) {
+    return variable == R_PRESION ? aFijo(valor, PRESION_BASE_FIJO)
+         : variable == R_TENDENCIA_HUMEDAD || variable == R_TENDENCIA_PRESION ? tendenciaAFijo(valor)
+         : aFijo(valor);
+  }
+};
+
+// Condicion "extrema" de nivelAlerta(): alerta roja con cualquier puntaje
+constexpr ReglaRiesgo CONDICION_EXTREMA[] = {
+  {R_HUMEDAD, MAYOR_QUE, HUMEDAD_EXTREMA, 0},
+  {R_PRESION, MENOR_QUE, PRESION_EXTREMA, 0},
+};
+
+// Regla I de TABLA sobre la entrada. El umbral se convierte al tipo del
+// campo en tiempo de compilacion: en el Uno las magnitudes int16 se
+// comparan con constantes int16 y no queda ninguna operacion float
+template <class Escala, const ReglaRiesgo* TABLA, int I>
+struct CondicionRiesgo {
+  template <class E> static bool cumple(const E& e) {
+    typedef decltype(CampoRiesgo<TABLA[I].variable>::de(e)) Tipo;
+    constexpr Tipo umbral = (Tipo)Escala::umbral(TABLA[I].variable, TABLA[I].umbral);
+    return TABLA[I].comparacion == MAYOR_QUE ? CampoRiesgo<TABLA[I].variable>::de(e) > umbral
+                                             : CampoRiesgo<TABLA[I].variable>::de(e) < umbral;
+  }
+};
+
+// ======================
+// PUNTUACION GENERADA
+// ======================
+// Recorre la tabla en tiempo de compilacion: cada regla queda como una
+// comparacion con una constante y una suma, sin saltos
+template <class Escala, int I = 0, bool FIN = (I >= NUM_REGLAS_RIESGO)>
+struct PuntuacionGenerada {
+  template <class E> static int sumar(const E& e) {
+    return (int)CondicionRiesgo<Escala, REGLAS_RIESGO, I>::cumple(e) * incrementoRegla(I) +
+           PuntuacionGenerada<Escala, I + 1>::sumar(e);
+  }
+};
+
+template <class Escala, int I>
+struct PuntuacionGenerada<Escala, I, true> {
+  template <class E> static int sumar(const E&) { return 0; }
+};
+
+template <class Escala, class E>
+inline int nivelGenerado(int puntos, const E& e) {
+  int rojo = (int)(puntos >= PUNTOS_ALERTA_ROJA) |
+             ((int)CondicionRiesgo<Escala, CONDICION_EXTREMA, 0>::cumple(e) &
+              (int)CondicionRiesgo<Escala, CONDICION_EXTREMA, 1>::cumple(e));
+  int amarillo = (int)(puntos >= PUNTOS_ALERTA_AMARILLA);
+  return (rojo << 1) | (amarillo & (rojo ^ 1));
+}
+
+// ======================
+// API
+// ======================
+inline int puntosRiesgo(float temperatura, float humedad, float presion,
+                        float tendenciaHumedad, float tendenciaPresion) {
+  EntradaRiesgo e = {temperatura, humedad, presion, tendenciaHumedad, tendenciaPresion};
+  return PuntuacionGenerada<EscalaFlotante>::sumar(e);
+}
+
+inline int nivelAlerta(int puntos, float humedad, float presion) {
+  EntradaRiesgo e = {0, humedad, presion, 0, 0};
+  return nivelGenerado<EscalaFlotante>(puntos, e);
+}
+
+// Tendencias en milesimas de unidad por muestra
+inline int puntosRiesgoFijo(const DatosFijos& d, int32_t tendenciaHumedad, int32_t tendenciaPresion) {
+  EntradaRiesgoFija e = {d.temperatura, d.humedad, d.presion, tendenciaHumedad, tendenciaPresion};
+  return PuntuacionGenerada<EscalaFija>::sumar(e);
+}
+
+inline int nivelAlertaFijo(int puntos, const DatosFijos& d) {
+  return nivelGenerado<EscalaFija>(puntos, d);
+}
+
+#endif
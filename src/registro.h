@@ -0,0 +1,117 @@
+#ifndef REGISTRO_H
+#define REGISTRO_H
+
+#include <stdarg.h>
+#include <stdint.h>
+#include "config.h"
+
+// ======================
+// REGISTRO POR NIVELES
+// ======================
+// Fachada de log comun al Arduino y al simulador:
+//   LOG_ERROR("No se pudo encontrar el BMP280");
+//   LOG_DEPURACION("FILTRADO - T:%.1fC H:%.1f%% P:%.1fhPa", t, h, p);
+// Los niveles por encima de NIVEL_REGISTRO (config.h) se eliminan en el
+// preprocesador: ni el formato ni los argumentos llegan al binario. El
+// formato es el de printf con un subconjunto fijo: %d %u %ld %lu %s %c
+// %% y %.Nf (N de 0 a 9); los int32_t se pasan como (long).
+//
+// En el Arduino el formato vive en flash (F()) y se recorre con
+// pgm_read_byte imprimiendo cada pieza por Serial, sin buffer en RAM. En
+// el simulador cada linea se formatea en el hilo que la emite y se deja
+// en un buffer circular que vacia un hilo de fondo (registro_nativo.h).
+
+#if defined(ARDUINO)
+  #include <Arduino.h>
+  #define TEXTO_REGISTRO(formato) F(formato)
+  typedef const __FlashStringHelper* FormatoRegistro;
+#else
+  #define TEXTO_REGISTRO(formato) formato
+  typedef const char* FormatoRegistro;
+#endif
+
+#if defined(ARDUINO)
+
+inline void imprimirPrefijoRegistro(uint8_t nivel) {
+  if (nivel == REGISTRO_ERROR) Serial.print(F("ERROR: "));
+  else if (nivel == REGISTRO_AVISO) Serial.print(F("AVISO: "));
+}
+
+// Variadica, asi que GCC no la expande en cada llamada: una sola copia
+inline void registrarFormato(uint8_t nivel, FormatoRegistro formato, ...) {
+  va_list args;
+  va_start(args, formato);
+  imprimirPrefijoRegistro(nivel);
+
+  const char* p = reinterpret_cast<const char*>(formato);
+  char c;
+  while ((c = pgm_read_byte(p++)) != 0) {
+    if (c != '%') {
+      Serial.write(c);
+      continue;
+    }
+
+    c = pgm_read_byte(p++);
+    uint8_t decimales = 2;
+    if (c == '.') {
+      decimales = pgm_read_byte(p++) - '0';
+      c = pgm_read_byte(p++);
+    }
+    bool largo = c == 'l';
+    if (largo) c = pgm_read_byte(p++);
+
+    switch (c) {
+      case 'd':
+        if (largo) Serial.print(va_arg(args, long));
+        else Serial.print(va_arg(args, int));
+        break;
+      case 'u':
+        if (largo) Serial.print(va_arg(args, unsigned long));
+        else Serial.print(va_arg(args, unsigned int));
+        break;
+      case 'f': Serial.print(va_arg(args, double), decimales); break;
+      case 's': Serial.print(va_arg(args, const char*)); break;
+      case 'c': Serial.write((char)va_arg(args, int)); break;
+      case '%': Serial.write('%'); break;
+      case 0: p--; break;   // '%' al final del formato
+      default: break;
+    }
+  }
+
+  Serial.println();
+  va_end(args);
+}
+
+#else
+
+// Definida en simulador_nativo/registro_nativo.h
+inline void registrarFormato(uint8_t nivel, FormatoRegistro formato, ...)
+    __attribute__((format(printf, 2, 3)));
+
+#endif
+
+#if NIVEL_REGISTRO >= REGISTRO_ERROR
+  #define LOG_ERROR(formato, ...) registrarFormato(REGISTRO_ERROR, TEXTO_REGISTRO(formato), ##__VA_ARGS__)
+#else
+  #define LOG_ERROR(formato, ...) do {} while (0)
+#endif
+
+#if NIVEL_REGISTRO >= REGISTRO_AVISO
+  #define LOG_AVISO(formato, ...) registrarFormato(REGISTRO_AVISO, TEXTO_REGISTRO(formato), ##__VA_ARGS__)
+#else
+  #define LOG_AVISO(formato, ...) do {} while (0)
+#endif
+
+#if NIVEL_REGISTRO >= REGISTRO_INFO
+  #define LOG_INFO(formato, ...) registrarFormato(REGISTRO_INFO, TEXTO_REGISTRO(formato), ##__VA_ARGS__)
+#else
+  #define LOG_INFO(formato, ...) do {} while (0)
+#endif
+
+#if NIVEL_REGISTRO >= REGISTRO_DEPURACION
+  #define LOG_DEPURACION(formato, ...) registrarFormato(REGISTRO_DEPURACION, TEXTO_REGISTRO(formato), ##__VA_ARGS__)
+#else
+  #define LOG_DEPURACION(formato, ...) do {} while (0)
+#endif
+
+#endif
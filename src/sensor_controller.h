@@ -3,11 +3,13 @@
 
 #include <DHT.h>
 #include "config.h"
+#include "registro.h"
 
 #if !MODO_SIMULACION
   #include <Adafruit_BMP280.h>
-  DHT dht(DHTPIN, DHTTYPE);
-  Adafruit_BMP280 bmp; // I2C
+  // Definidos en sistema_controller.cpp
+  extern DHT dht;
+  extern Adafruit_BMP280 bmp; // I2C
 #endif
 
 struct SensorData {
@@ -29,10 +31,10 @@ public:
       // Inicializar BMP280
       if (bmp.begin(BMP280_I2C_ADDRESS)) {
         bmp280Disponible = true;
-        Serial.println("BMP280 inicializado correctamente");
+        LOG_INFO("BMP280 inicializado correctamente");
       } else {
         bmp280Disponible = false;
-        Serial.println("ERROR: No se pudo encontrar el BMP280");
+        LOG_ERROR("No se pudo encontrar el BMP280");
       }
     #endif
   }
@@ -41,7 +43,7 @@ public:
     SensorData data;
     data.timestamp = millis();
     
-    #ifdef MODO_SIMULACION
+    #if MODO_SIMULACION
       // SIMULACION MEJORADA CON CORRELACION
       float baseHumedad = 40 + random(6000) / 100.0;  // 40.0 - 100.0%
       
@@ -59,7 +61,7 @@ public:
       
       data.humedad = max(30.0f, min(100.0f, baseHumedad));
       
-      Serial.print("SIMULACION - ");
+      LOG_DEPURACION("SIMULACION - T:%.1fC H:%.1f%% P:%.1fhPa", data.temperatura, data.humedad, data.presion);
     #else
       // MODO REAL - LECTURA DE SENSORES FISICOS
       
@@ -68,7 +70,7 @@ public:
       data.humedad = dht.readHumidity();
       
       if (isnan(data.temperatura) || isnan(data.humedad)) {
-        Serial.println("Error leyendo DHT22 fisico");
+        LOG_ERROR("Error leyendo DHT22 fisico");
         data.temperatura = -1;
         data.humedad = -1;
         data.presion = -1;
@@ -87,20 +89,12 @@ public:
       } else {
         // Fallback si BMP280 no está disponible
         data.presion = 1013.0; // Presión estándar
-        Serial.println("AVISO: Usando presion por defecto - BMP280 no disponible");
+        LOG_AVISO("Usando presion por defecto - BMP280 no disponible");
       }
       
-      Serial.print("REAL - ");
+      LOG_DEPURACION("REAL - T:%.1fC H:%.1f%% P:%.1fhPa", data.temperatura, data.humedad, data.presion);
     #endif
 
-    Serial.print("T:");
-    Serial.print(data.temperatura, 1);
-    Serial.print("C H:");
-    Serial.print(data.humedad, 1);
-    Serial.print("% P:");
-    Serial.print(data.presion, 1);
-    Serial.println("hPa");
-
     return data;
   }
 
@@ -12,9 +12,6 @@ const int BACKEND_PORT = 80;
 // VARIABLES GLOBALES
 // ======================
 FilteredData datosFiltrados;
-unsigned long ultimaLectura = 0;
-unsigned long ultimoFiltrado = 0;
-unsigned long ultimoEnvio = 0;
 
 // ======================
 // VARIABLES ETHERNET
@@ -27,70 +24,112 @@ HttpClient httpClient = HttpClient(ethClient, BACKEND_URL, BACKEND_PORT);
 // ======================
 // INSTANCIAS GLOBALES
 // ======================
+#if !MODO_SIMULACION
+  DHT dht(DHTPIN, DHTTYPE);
+  Adafruit_BMP280 bmp;
+#endif
 SensorController sensorController;
 DataFilter dataFilter;
 PredictionEngine predictionEngine;
 HttpClientBackend httpBackend;
+ColaEeprom colaPendientes;
+PoliticaReporte politicaReporte;
+MetricasEstacion metricas;
 
 // ======================
 // IMPLEMENTACIÓN DE FUNCIONES
 // ======================
+void resultadoEnvio(const LecturaLote& lectura, bool exito) {
+  if (exito) {
+    LOG_DEPURACION("Datos enviados correctamente - ts %lu", lectura.timestamp);
+    colaPendientes.backendDisponible();
+  } else {
+    // Se guarda en EEPROM para reenviarla cuando vuelva la conexion
+    MetricasEstacion::incrementar(metricas.enviosFallidos);
+    LOG_AVISO("Error enviando datos, guardada en EEPROM - ts %lu", lectura.timestamp);
+    colaPendientes.agregar(lectura);
+  }
+}
+
 void leerSensores() {
-  SensorData datos = sensorController.readSensors();
+  SensorData datos;
+  {
+    MedicionEtapa<MetricasEstacion> m(metricas, ETAPA_LECTURA);
+    datos = sensorController.readSensors();
+  }
   
   // Validar datos antes de agregarlos al filtro
   if (datos.temperatura > -40 && datos.temperatura < 85 && 
       datos.humedad >= 0 && datos.humedad <= 100 &&
       datos.presion > 800 && datos.presion < 1100) {
-    dataFilter.addData(datos.temperatura, datos.humedad, datos.presion);
+    if (dataFilter.addData(datos.temperatura, datos.humedad, datos.presion)) {
+      MetricasEstacion::incrementar(metricas.atipicas);
+      LOG_DEPURACION("Lectura atipica sustituida por la mediana");
+    }
   } else {
-    Serial.println("Datos de sensores invalidos - descartados");
+    MetricasEstacion::incrementar(metricas.descartadas);
+    LOG_AVISO("Datos de sensores invalidos - descartados");
   }
 }
 
+// Tendencias y prediccion sobre la ventana actual, en float o en punto
+// fijo segun USAR_PUNTO_FIJO
+int evaluarAlerta() {
+  MedicionEtapa<MetricasEstacion> m(metricas, ETAPA_PREDICCION);
+  #if USAR_PUNTO_FIJO
+    int32_t tendenciaHumedad = dataFilter.tendenciaHumedadFija();
+    int32_t tendenciaPresion = dataFilter.tendenciaPresionFija();
+    return predictionEngine.predictFijo(dataFilter.filterFijo(), tendenciaHumedad, tendenciaPresion);
+  #else
+    float tendenciaHumedad = dataFilter.calculateHumidityTrend();
+    float tendenciaPresion = dataFilter.calculatePressureTrend();
+    return predictionEngine.predict(datosFiltrados.temperatura, datosFiltrados.humedad, 
+                                    datosFiltrados.presion, tendenciaHumedad, tendenciaPresion);
+  #endif
+}
+
 void filtrarDatos() {
-  datosFiltrados = dataFilter.filter();
+  {
+    MedicionEtapa<MetricasEstacion> m(metricas, ETAPA_FILTRADO);
+    datosFiltrados = dataFilter.filter();
+  }
   
   if (datosFiltrados.humedad > 0) {
-    float tendenciaHumedad = dataFilter.calculateHumidityTrend();
-    float tendenciaPresion = dataFilter.calculatePressureTrend();
-    
-    Serial.print("Tendencia Humedad: ");
-    Serial.println(tendenciaHumedad, 4);
-    Serial.print("Tendencia Presion: ");
-    Serial.println(tendenciaPresion, 4);
-    
-    predictionEngine.predict(datosFiltrados.temperatura, datosFiltrados.humedad, 
-                           datosFiltrados.presion, tendenciaHumedad, tendenciaPresion);
+    evaluarAlerta();
   }
 }
 
 void enviarAlBackend() {
   if (datosFiltrados.humedad > 0) {
-    float tendenciaHumedad = dataFilter.calculateHumidityTrend();
-    float tendenciaPresion = dataFilter.calculatePressureTrend();
-    int alerta = predictionEngine.predict(datosFiltrados.temperatura, datosFiltrados.humedad, 
-                                        datosFiltrados.presion, tendenciaHumedad, tendenciaPresion);
+    int alerta = evaluarAlerta();
+    
+    #if REPORTE_POR_BANDA
+      // Sin cambios fuera de banda no se sube nada: el backend mantiene
+      // el ultimo valor hasta el siguiente reporte o latido
+      MotivoReporte motivo = politicaReporte.evaluar(datosFiltrados.temperatura, datosFiltrados.humedad,
+                                                     datosFiltrados.presion, alerta, millis());
+      if (motivo == REPORTE_SUPRIMIDO) {
+        MetricasEstacion::incrementar(metricas.suprimidas);
+        LOG_DEPURACION("Sin cambios fuera de banda - lectura suprimida");
+        return;
+      }
+      LOG_DEPURACION("Reporte por motivo %d", (int)motivo);
+    #endif
     
-    bool exito = httpBackend.sendData(
+    // Se agrupa en el lote; el resultado de cada lectura llega por
+    // resultadoEnvio() cuando el lote se sube
+    httpBackend.encolar(
       datosFiltrados.temperatura,
       datosFiltrados.humedad, 
       datosFiltrados.presion,
       alerta
     );
     
-    if (exito) {
-      Serial.println("Datos enviados correctamente");
-    } else {
-      Serial.println("Error enviando datos");
-    }
-    
     // Información del estado de los sensores
     #if !MODO_SIMULACION
-      Serial.print("BMP280 Disponible: ");
-      Serial.println(sensorController.isBMP280Available() ? "SI" : "NO");
+      LOG_DEPURACION("BMP280 Disponible: %s", sensorController.isBMP280Available() ? "SI" : "NO");
     #endif
     
-    Serial.println("------------------------------------");
+    LOG_DEPURACION("------------------------------------");
   }
 }
\ No newline at end of file
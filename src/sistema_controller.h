@@ -5,6 +5,8 @@
 #include "data_filter.h"
 #include "prediction_engine.h"
 #include "http_client.h"
+#include "cola_eeprom.h"
+#include "politica_reporte.h"
 
 // ======================
 // DECLARACIONES DE VARIABLES GLOBALES
@@ -13,10 +15,10 @@ extern SensorController sensorController;
 extern DataFilter dataFilter;
 extern PredictionEngine predictionEngine;
 extern HttpClientBackend httpBackend;
+extern ColaEeprom colaPendientes;
+extern PoliticaReporte politicaReporte;
+extern MetricasEstacion metricas;
 extern FilteredData datosFiltrados;
-extern unsigned long ultimaLectura;
-extern unsigned long ultimoFiltrado;
-extern unsigned long ultimoEnvio;
 
 // ======================
 // DECLARACIONES ETHERNET
@@ -32,5 +34,7 @@ extern HttpClient httpClient;
 void leerSensores();
 void filtrarDatos();
 void enviarAlBackend();
+int evaluarAlerta();
+void resultadoEnvio(const LecturaLote& lectura, bool exito);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,135 @@
+#ifndef VENTANA_ESTADISTICA_H
+#define VENTANA_ESTADISTICA_H
+
+// ======================
+// VENTANA DESLIZANTE CON ESTADISTICAS INCREMENTALES
+// ======================
+// Buffer circular de N muestras que mantiene al dia, en cada add():
+//   - media y varianza (Welford, con retirada de la muestra expulsada)
+//   - suma de Y y suma de X*Y para la regresion lineal
+// X es la posicion cronologica dentro de la ventana (0 = mas antigua), asi
+// que la pendiente coincide con la del recorrido completo pero cuesta O(1).
+//
+// No depende de Arduino ni de la STL: se usa igual en el AVR y en el
+// simulador nativo. Acum es el tipo de los acumuladores: float en el Uno y
+// en todas las rutas del simulador, para que den los mismos niveles;
+// double solo en la referencia de --precision-punto-fijo y en los
+// benchmarks de ventanas largas.
+template <typename T, typename Acum, int N>
+class VentanaEstadistica {
+private:
+  T muestras[N];
+  int inicio = 0;     // posicion de la muestra mas antigua
+  int cantidad = 0;
+
+  Acum media_ = 0;
+  Acum m2 = 0;        // suma de cuadrados de desviaciones (Welford)
+  Acum sumaY = 0;
+  Acum sumaXY = 0;
+
+public:
+  void add(T valor) {
+    Acum y = valor;
+
+    if (cantidad == N) {
+      // Expulsar la mas antigua (x = 0) y desplazar el resto una posicion
+      Acum viejo = muestras[inicio];
+      quitarWelford(viejo);
+      sumaY -= viejo;
+      sumaXY -= sumaY;
+
+      muestras[inicio] = valor;
+      inicio = (inicio + 1) % N;
+      agregarWelford(y);
+      sumaXY += (Acum)(N - 1) * y;
+      sumaY += y;
+
+      // Al completar una vuelta se recalcula desde el buffer para que el
+      // error de redondeo no se acumule (O(N) cada N muestras -> O(1))
+      if (inicio == 0) resincronizar();
+      return;
+    }
+
+    muestras[(inicio + cantidad) % N] = valor;
+    agregarWelford(y);
+    sumaXY += (Acum)(cantidad - 1) * y;
+    sumaY += y;
+  }
+
+  int size() const { return cantidad; }
+  bool lleno() const { return cantidad == N; }
+  static int capacidad() { return N; }
+
+  // i-esima muestra en orden cronologico (0 = mas antigua)
+  T muestra(int i) const { return muestras[(inicio + i) % N]; }
+  T ultima() const { return muestra(cantidad - 1); }
+
+  Acum suma() const { return sumaY; }
+  Acum media() const { return media_; }
+
+  Acum varianza() const {
+    if (cantidad < 2) return 0;
+    Acum v = m2 / (Acum)(cantidad - 1);
+    return v > 0 ? v : 0;
+  }
+
+  // Pendiente por muestra de la recta de minimos cuadrados
+  Acum pendiente() const {
+    if (cantidad < 2) return 0;
+    Acum n = cantidad;
+    Acum sumaX = n * (n - 1) / 2;
+    Acum sumaX2 = (n - 1) * n * (2 * n - 1) / 6;
+    return (n * sumaXY - sumaX * sumaY) / (n * sumaX2 - sumaX * sumaX);
+  }
+
+  void reset() {
+    inicio = 0;
+    cantidad = 0;
+    media_ = 0;
+    m2 = 0;
+    sumaY = 0;
+    sumaXY = 0;
+  }
+
+private:
+  void agregarWelford(Acum y) {
+    cantidad++;
+    Acum delta = y - media_;
+    media_ += delta / (Acum)cantidad;
+    m2 += delta * (y - media_);
+  }
+
+  void quitarWelford(Acum y) {
+    if (cantidad <= 1) {
+      cantidad = 0;
+      media_ = 0;
+      m2 = 0;
+      return;
+    }
+    Acum mediaAnterior = media_;
+    media_ -= (y - media_) / (Acum)(cantidad - 1);
+    m2 -= (y - mediaAnterior) * (y - media_);
+    cantidad--;
+  }
+
+  void resincronizar() {
+    Acum s = 0, sxy = 0;
+    for (int i = 0; i < cantidad; i++) {
+      Acum y = muestra(i);
+      s += y;
+      sxy += (Acum)i * y;
+    }
+    Acum m = s / (Acum)cantidad;
+    Acum d2 = 0;
+    for (int i = 0; i < cantidad; i++) {
+      Acum d = (Acum)muestra(i) - m;
+      d2 += d * d;
+    }
+    sumaY = s;
+    sumaXY = sxy;
+    media_ = m;
+    m2 = d2;
+  }
+};
+
+#endif
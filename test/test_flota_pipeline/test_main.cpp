@@ -0,0 +1,57 @@
+#include <unity.h>
+#include "../../simulador_nativo/flota_pipeline.h"
+
+// ======================
+// POOL FRENTE A PIPELINE
+// ======================
+// pio test -e native
+// Con la misma semilla y reloj virtual, --pipeline debe dar exactamente
+// los mismos contadores que el pool: filtra y decide el envio en los
+// mismos pasos, con las mismas lecturas en la ventana
+static ConfigFlota configPrueba(unsigned semilla) {
+    ConfigFlota config;
+    config.estaciones = 200;
+    config.semilla = semilla;
+    config.enviar = false;
+    config.relojVirtual = true;
+    config.duracionMs = 3600000;
+    config.intervaloResumenMs = config.duracionMs;
+    config.reportePorBanda = true;
+    config.filtro = FILTRO_HAMPEL;
+    config.hilosAnalitica = 2;
+    return config;
+}
+
+static void compararModos(unsigned semilla) {
+    ConfigFlota config = configPrueba(semilla);
+    SimuladorFlota flota(config);
+    flota.ejecutar();
+    config.pipeline = true;
+    SimuladorPipeline pipeline(config);
+    pipeline.ejecutar();
+
+    const EstadisticasFlota& a = flota.estadisticas();
+    const EstadisticasFlota& b = pipeline.estadisticas();
+    TEST_ASSERT_TRUE(a.lecturas > 0);
+    TEST_ASSERT_EQUAL_UINT64(a.lecturas, b.lecturas);
+    TEST_ASSERT_EQUAL_UINT64(a.descartadas, b.descartadas);
+    TEST_ASSERT_EQUAL_UINT64(a.reportadas, b.reportadas);
+    TEST_ASSERT_EQUAL_UINT64(a.suprimidas, b.suprimidas);
+    TEST_ASSERT_EQUAL_UINT64(a.atipicas, b.atipicas);
+    for (int i = 0; i < 3; i++) TEST_ASSERT_EQUAL_UINT64(a.alertas[i], b.alertas[i]);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_mismos_contadores_semilla_7() { compararModos(7); }
+void test_mismos_contadores_semilla_11() { compararModos(11); }
+
+int main() {
+    activarRelojVirtual();
+    Serial.silenciar(true);
+    UNITY_BEGIN();
+    RUN_TEST(test_mismos_contadores_semilla_7);
+    RUN_TEST(test_mismos_contadores_semilla_11);
+    return UNITY_END();
+}
@@ -0,0 +1,38 @@
+#include <unity.h>
+#include "../../simulador_nativo/precision_punto_fijo.h"
+
+// ======================
+// PUNTO FIJO FRENTE A FLOAT
+// ======================
+// pio test -e native
+// Las cotas y su justificacion estan en precision_punto_fijo.h; la misma
+// medicion se ve con simulador_native --precision-punto-fijo
+static ErroresPuntoFijo errores;
+
+void setUp() {}
+void tearDown() {}
+
+void test_medias_a_media_centesima() {
+    TEST_ASSERT_TRUE(errores.media[0] <= TOLERANCIA_MEDIA);
+    TEST_ASSERT_TRUE(errores.media[1] <= TOLERANCIA_MEDIA);
+    TEST_ASSERT_TRUE(errores.media[2] <= TOLERANCIA_MEDIA);
+}
+
+void test_tendencias_a_media_milesima() {
+    TEST_ASSERT_TRUE(errores.tendencia[0] <= TOLERANCIA_TENDENCIA);
+    TEST_ASSERT_TRUE(errores.tendencia[1] <= TOLERANCIA_TENDENCIA);
+}
+
+void test_niveles_de_alerta() {
+    TEST_ASSERT_TRUE(errores.evaluaciones > 0);
+    TEST_ASSERT_TRUE((double)errores.nivelesDistintos / errores.evaluaciones <= TOLERANCIA_NIVELES);
+}
+
+int main() {
+    errores = medirPuntoFijo(200000);
+    UNITY_BEGIN();
+    RUN_TEST(test_medias_a_media_centesima);
+    RUN_TEST(test_tendencias_a_media_milesima);
+    RUN_TEST(test_niveles_de_alerta);
+    return UNITY_END();
+}